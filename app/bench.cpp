@@ -0,0 +1,826 @@
+#include "allan.hpp"
+#include "datastream.hpp"
+#include "driver.hpp"
+#include "earth.hpp"
+#include "fileio.hpp"
+#include "gins.hpp"
+#include "imubuffer.hpp"
+#include "init.hpp"
+#include "insmech.hpp"
+#include "insmechbatch.hpp"
+#include "profiler.hpp"
+#include "realtime.hpp"
+#include "resultsink.hpp"
+#include "rotation.hpp"
+#include "simulator.hpp"
+#include "smoother.hpp"
+#include "staticdetector.hpp"
+#include "sweep.hpp"
+#include "testdata.hpp"
+#include "trajectory.hpp"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <thread>
+using namespace std;
+
+// 基准测试使用的数据文件，命令行未指定时自动生成模拟数据
+static string g_imufile;
+static vector<IMU> g_imudata;   // 预先读入的IMU数据，用于与文件读取无关的测试
+static ImuBuffer g_imubuffer;   // 与 g_imudata 相同的数据，按列存储
+static vector<GNSS> g_gnssdata; // 与 g_imudata 时段相同的模拟GNSS数据
+static string g_gnssfile;       // g_gnssdata 写成的pos文件，用于完整解算流程的基准测试
+
+/// 原有的 getline + StrSplit + stod 解析路径
+static void BM_ReadIMU_Getline(benchmark::State &state) {
+    size_t records = 0;
+    for (auto _ : state) {
+        vector<IMU> imu_data;
+        FileIO::getIMUdata(g_imufile, imu_data);
+        records = imu_data.size();
+        benchmark::DoNotOptimize(imu_data.data());
+    }
+    state.SetBytesProcessed(state.iterations() * filesystem::file_size(g_imufile));
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_ReadIMU_Getline)->Unit(benchmark::kMillisecond);
+
+/// 内存映射 + from_chars 就地解析路径
+static void BM_ReadIMU_Mmap(benchmark::State &state) {
+    size_t records = 0;
+    for (auto _ : state) {
+        vector<IMU> imu_data;
+        FileIO::getIMUdataMmap(g_imufile, imu_data);
+        records = imu_data.size();
+        benchmark::DoNotOptimize(imu_data.data());
+    }
+    state.SetBytesProcessed(state.iterations() * filesystem::file_size(g_imufile));
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_ReadIMU_Mmap)->Unit(benchmark::kMillisecond);
+
+/// 多线程分块解析路径，参数为线程数
+static void BM_ReadIMU_Parallel(benchmark::State &state) {
+    size_t records = 0;
+    for (auto _ : state) {
+        vector<IMU> imu_data;
+        FileIO::getIMUdataParallel(g_imufile, imu_data, true, state.range(0));
+        records = imu_data.size();
+        benchmark::DoNotOptimize(imu_data.data());
+    }
+    state.SetBytesProcessed(state.iterations() * filesystem::file_size(g_imufile));
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_ReadIMU_Parallel)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, max(1u, thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/// 按需逐条读取的数据流路径，常驻内存只有固定容量的环形缓冲区
+static void BM_ReadIMU_Stream(benchmark::State &state) {
+    size_t records = 0;
+    for (auto _ : state) {
+        IMUStream stream;
+        stream.open(g_imufile);
+        IMU imu;
+        records = 0;
+        while (stream.next(imu)) {
+            benchmark::DoNotOptimize(imu);
+            records++;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * filesystem::file_size(g_imufile));
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_ReadIMU_Stream)->Unit(benchmark::kMillisecond);
+
+/// 二分查找定位到最后10分钟后读取，与 BM_Seek_Linear 比较
+static void BM_Seek_Stream(benchmark::State &state) {
+    double start   = g_imudata.back().time - 600.0;
+    size_t records = 0;
+    for (auto _ : state) {
+        IMUStream stream;
+        stream.open(g_imufile);
+        stream.seek(start);
+        IMU imu;
+        records = 0;
+        while (stream.next(imu)) {
+            benchmark::DoNotOptimize(imu);
+            records++;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_Seek_Stream)->Unit(benchmark::kMillisecond);
+
+/// 原有的定位方式：从头逐条解析到开始时刻
+static void BM_Seek_Linear(benchmark::State &state) {
+    double start   = g_imudata.back().time - 600.0;
+    size_t records = 0;
+    for (auto _ : state) {
+        IMUStream stream;
+        stream.open(g_imufile);
+        IMU imu;
+        records = 0;
+        while (stream.next(imu)) {
+            if (imu.time >= start) {
+                benchmark::DoNotOptimize(imu);
+                records++;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * records);
+}
+BENCHMARK(BM_Seek_Linear)->Unit(benchmark::kMillisecond);
+
+/// 原有的Allan方差分析方式：每个 bins 都重新扫描一遍全部数据
+static void BM_Allan_PerBins(benchmark::State &state) {
+    vector<double> res_allan_std;
+    int size = g_imudata.size();
+    for (auto _ : state) {
+        for (int bins = 2; bins < 10000; bins += 10) {
+            allanAnalysis(g_imudata, 0, size, bins, res_allan_std);
+            benchmark::DoNotOptimize(res_allan_std.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_Allan_PerBins)->Unit(benchmark::kMillisecond);
+
+/// 累积和Allan方差引擎，包含构建累积和的时间，计算与 BM_Allan_PerBins 相同的一组 bins
+static void BM_Allan_Cumsum(benchmark::State &state) {
+    for (auto _ : state) {
+        AllanVariance allan(g_imudata, 0, g_imudata.size());
+        for (int bins = 2; bins < 10000; bins += 10) {
+            auto res = allan.deviationByBins(bins);
+            benchmark::DoNotOptimize(res);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_Allan_Cumsum)->Unit(benchmark::kMillisecond);
+
+/// 对数等间隔相关时间下的重叠Allan方差
+static void BM_Allan_OverlapLog(benchmark::State &state) {
+    size_t clusters = 0;
+    for (auto _ : state) {
+        AllanVariance allan(g_imudata, 0, g_imudata.size());
+        auto ms  = AllanVariance::logSpacedClusters(allan.size() / 2, 10);
+        clusters = ms.size();
+        for (size_t m : ms) {
+            auto res = allan.deviation(m, true);
+            benchmark::DoNotOptimize(res);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * clusters);
+}
+BENCHMARK(BM_Allan_OverlapLog)->Unit(benchmark::kMillisecond);
+
+/// 对数等间隔相关时间下的完全重叠Allan方差，各相关时间分配给线程池，参数为线程数
+static void BM_Allan_OverlapParallel(benchmark::State &state) {
+    AllanVariance allan(g_imudata, 0, g_imudata.size());
+    auto ms = AllanVariance::logSpacedClusters(allan.size() / 2, 20);
+    ThreadPool pool(state.range(0));
+    for (auto _ : state) {
+        auto res = allan.deviations(ms, true, &pool);
+        benchmark::DoNotOptimize(res.data());
+    }
+    state.SetItemsProcessed(state.iterations() * ms.size());
+}
+BENCHMARK(BM_Allan_OverlapParallel)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, max(1u, thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/// 按历元存储（vector<IMU>）时六个轴求均值
+static void BM_Mean_AoS(benchmark::State &state) {
+    for (auto _ : state) {
+        Vector3d dtheta(0, 0, 0), dvel(0, 0, 0);
+        for (const auto &imu : g_imudata) {
+            dtheta += imu.dtheta;
+            dvel += imu.dvel;
+        }
+        dtheta /= g_imudata.size();
+        dvel /= g_imudata.size();
+        benchmark::DoNotOptimize(dtheta);
+        benchmark::DoNotOptimize(dvel);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+}
+BENCHMARK(BM_Mean_AoS);
+
+/// 按列存储（ImuBuffer）时六个轴求均值
+static void BM_Mean_SoA(benchmark::State &state) {
+    ImuView view = g_imubuffer.view();
+    for (auto _ : state) {
+        ImuStats mean = view.mean();
+        benchmark::DoNotOptimize(mean);
+    }
+    state.SetItemsProcessed(state.iterations() * view.size());
+}
+BENCHMARK(BM_Mean_SoA);
+
+/// 按历元存储时六个轴的样本方差（两遍扫描）
+static void BM_Variance_AoS(benchmark::State &state) {
+    size_t n = g_imudata.size();
+    for (auto _ : state) {
+        Vector3d mean_theta(0, 0, 0), mean_vel(0, 0, 0);
+        for (const auto &imu : g_imudata) {
+            mean_theta += imu.dtheta;
+            mean_vel += imu.dvel;
+        }
+        mean_theta /= n;
+        mean_vel /= n;
+        Vector3d var_theta(0, 0, 0), var_vel(0, 0, 0);
+        for (const auto &imu : g_imudata) {
+            var_theta += (imu.dtheta - mean_theta).array().square().matrix();
+            var_vel += (imu.dvel - mean_vel).array().square().matrix();
+        }
+        var_theta /= n - 1;
+        var_vel /= n - 1;
+        benchmark::DoNotOptimize(var_theta);
+        benchmark::DoNotOptimize(var_vel);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Variance_AoS);
+
+/// 按列存储时六个轴的样本方差
+static void BM_Variance_SoA(benchmark::State &state) {
+    ImuView view = g_imubuffer.view();
+    for (auto _ : state) {
+        ImuStats var = view.variance();
+        benchmark::DoNotOptimize(var);
+    }
+    state.SetItemsProcessed(state.iterations() * view.size());
+}
+BENCHMARK(BM_Variance_SoA);
+
+/// 按历元存储时的分块均值Allan方差，参数为分块数
+static void BM_BlockMeans_AoS(benchmark::State &state) {
+    vector<double> res_allan_std;
+    for (auto _ : state) {
+        allanAnalysis(g_imudata, 0, g_imudata.size(), state.range(0), res_allan_std);
+        benchmark::DoNotOptimize(res_allan_std.data());
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+}
+BENCHMARK(BM_BlockMeans_AoS)->ArgName("bins")->Arg(10)->Arg(1000);
+
+/// 按列存储时的分块均值Allan方差，参数为分块数
+static void BM_BlockMeans_SoA(benchmark::State &state) {
+    vector<double> res_allan_std;
+    ImuView view = g_imubuffer.view();
+    for (auto _ : state) {
+        allanAnalysis(view, state.range(0), res_allan_std);
+        benchmark::DoNotOptimize(res_allan_std.data());
+    }
+    state.SetItemsProcessed(state.iterations() * view.size());
+}
+BENCHMARK(BM_BlockMeans_SoA)->ArgName("bins")->Arg(10)->Arg(1000);
+
+static void BM_Rotation_matrix2euler(benchmark::State &state) {
+    vector<Matrix3d> dcms;
+    for (const auto &euler : randomEulers()) {
+        dcms.push_back(Rotation::euler2matrix(euler));
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        Vector3d euler = Rotation::matrix2euler(dcms[i++ % MICRO_INPUTS]);
+        benchmark::DoNotOptimize(euler);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rotation_matrix2euler);
+
+static void BM_Rotation_rotvec2matrix(benchmark::State &state) {
+    // 机械编排中的等效旋转矢量是一个历元内的小角度
+    vector<Vector3d> rotvecs = randomEulers();
+    for (auto &rotvec : rotvecs) {
+        rotvec *= 1E-3;
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        Matrix3d dcm = Rotation::rotvec2matrix(rotvecs[i++ % MICRO_INPUTS]);
+        benchmark::DoNotOptimize(dcm);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rotation_rotvec2matrix);
+
+static void BM_Rotation_euler2quaternion(benchmark::State &state) {
+    vector<Vector3d> eulers = randomEulers();
+    size_t i                = 0;
+    for (auto _ : state) {
+        Quaterniond q = Rotation::euler2quaternion(eulers[i++ % MICRO_INPUTS]);
+        benchmark::DoNotOptimize(q);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Rotation_euler2quaternion);
+
+static void BM_Earth_gravity(benchmark::State &state) {
+    vector<Vector3d> blhs = randomPositions();
+    size_t i              = 0;
+    for (auto _ : state) {
+        double gravity = Earth::gravity(blhs[i++ % MICRO_INPUTS]);
+        benchmark::DoNotOptimize(gravity);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Earth_gravity);
+
+static void BM_Earth_getRmRn(benchmark::State &state) {
+    vector<Vector3d> blhs = randomPositions();
+    size_t i              = 0;
+    for (auto _ : state) {
+        Vector2d rmrn = Earth::getRmRn(blhs[i++ % MICRO_INPUTS][0]);
+        benchmark::DoNotOptimize(rmrn);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Earth_getRmRn);
+
+/// 机械编排每个历元需要的全部地理参数
+static void BM_Earth_getTerms(benchmark::State &state) {
+    vector<Vector3d> blhs = randomPositions(), vels = randomEulers();
+    size_t i              = 0;
+    for (auto _ : state) {
+        EarthTerms terms = Earth::getTerms(blhs[i % MICRO_INPUTS], vels[i % MICRO_INPUTS] * 10.0);
+        benchmark::DoNotOptimize(terms);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Earth_getTerms);
+
+/// 用各自重新计算纬度三角函数的单项函数得到同样的地理参数，与 BM_Earth_getTerms 对比
+static void BM_Earth_Separate(benchmark::State &state) {
+    vector<Vector3d> blhs = randomPositions(), vels = randomEulers();
+    size_t i              = 0;
+    for (auto _ : state) {
+        const Vector3d &blh = blhs[i % MICRO_INPUTS];
+        Vector3d vel        = vels[i % MICRO_INPUTS] * 10.0;
+        EarthTerms terms;
+        terms.rmrn    = Earth::getRmRn(blh[0]);
+        terms.wie_n   = Earth::getWie(blh[0]);
+        terms.wen_n   = Earth::getWen(vel[1], vel[0], blh[0], blh[2]);
+        terms.gravity = Earth::gravity(blh);
+        benchmark::DoNotOptimize(terms);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Earth_Separate);
+
+/// 椭球参数为编译期常量，换用CGCS2000椭球的耗时与WGS84相同
+static void BM_Earth_getTerms_CGCS2000(benchmark::State &state) {
+    vector<Vector3d> blhs = randomPositions(), vels = randomEulers();
+    size_t i              = 0;
+    for (auto _ : state) {
+        EarthTerms terms = EarthModel<CGCS2000>::getTerms(blhs[i % MICRO_INPUTS], vels[i % MICRO_INPUTS] * 10.0);
+        benchmark::DoNotOptimize(terms);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Earth_getTerms_CGCS2000);
+
+static void BM_Earth_blh2ecef(benchmark::State &state) {
+    vector<Vector3d> blhs = randomPositions();
+    size_t i              = 0;
+    for (auto _ : state) {
+        Vector3d ecef = Earth::blh2ecef(blhs[i++ % MICRO_INPUTS]);
+        benchmark::DoNotOptimize(ecef);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Earth_blh2ecef);
+
+/// 原有的三步机械编排，每个历元都计算欧拉角和四元数
+static void BM_INSMech_ThreeStep(benchmark::State &state) {
+    for (auto _ : state) {
+        PVA pva = runMechanization(g_imudata, false);
+        benchmark::DoNotOptimize(pva);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["time_per_epoch"] =
+        benchmark::Counter(g_imudata.size(), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_INSMech_ThreeStep)->Unit(benchmark::kMillisecond);
+
+/// 单个历元的三步机械编排 INSMech::insMech，状态每 MICRO_INPUTS 个历元重置一次
+static void BM_INSMech_Epoch(benchmark::State &state) {
+    PVA pvapre = initialPVA(), pvacur = pvapre;
+    size_t i   = 0;
+    for (auto _ : state) {
+        size_t k = i++ % MICRO_INPUTS + 1;
+        if (k == 1) {
+            pvapre = pvacur = initialPVA();
+        }
+        INSMech::insMech(pvapre, pvacur, g_imudata[k - 1], g_imudata[k]);
+        benchmark::DoNotOptimize(pvacur);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_INSMech_Epoch);
+
+/// 单遍融合的机械编排，只在最后输出时计算欧拉角
+static void BM_INSMech_Fused(benchmark::State &state) {
+    for (auto _ : state) {
+        PVA pva = runMechanization(g_imudata, true);
+        benchmark::DoNotOptimize(pva);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["time_per_epoch"] =
+        benchmark::Counter(g_imudata.size(), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_INSMech_Fused)->Unit(benchmark::kMillisecond);
+
+/// 逐条轨迹调用 insMechFused，参数为轨迹数
+static void BM_INSMech_Lanes(benchmark::State &state) {
+    size_t lanes  = state.range(0);
+    size_t epochs = min(MECH_BATCH_EPOCHS, g_imudata.size());
+    for (auto _ : state) {
+        for (size_t lane = 0; lane < lanes; lane++) {
+            PVA pvapre = perturbedPVA(lane), pvacur = pvapre;
+            for (size_t i = 1; i < epochs; i++) {
+                INSMech::insMechFused(pvapre, pvacur, g_imudata[i - 1], g_imudata[i]);
+            }
+            benchmark::DoNotOptimize(pvacur);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lanes * epochs);
+}
+BENCHMARK(BM_INSMech_Lanes)->ArgName("lanes")->RangeMultiplier(4)->Range(4, 64)->Unit(benchmark::kMillisecond);
+
+/// INSMechBatch 同步递推所有轨迹，参数为轨迹数
+static void BM_INSMech_Batch(benchmark::State &state) {
+    size_t lanes  = state.range(0);
+    size_t epochs = min(MECH_BATCH_EPOCHS, g_imudata.size());
+    for (auto _ : state) {
+        INSMechBatch batch(lanes);
+        for (size_t lane = 0; lane < lanes; lane++) {
+            PVA pva = perturbedPVA(lane);
+            batch.initialize(lane, pva, pva, g_imudata[0]);
+        }
+        for (size_t i = 1; i < epochs; i++) {
+            for (size_t lane = 0; lane < lanes; lane++) {
+                batch.setIMU(lane, g_imudata[i]);
+            }
+            batch.update();
+        }
+        benchmark::DoNotOptimize(batch.state(0));
+    }
+    state.SetItemsProcessed(state.iterations() * lanes * epochs);
+}
+BENCHMARK(BM_INSMech_Batch)->ArgName("lanes")->RangeMultiplier(4)->Range(4, 64)->Unit(benchmark::kMillisecond);
+
+/// 21维松组合EKF的状态预测（机械编排和协方差传播），不做量测更新
+static void BM_GINS_Propagation(benchmark::State &state) {
+    for (auto _ : state) {
+        NavState nav = runEKF(g_imudata, {});
+        benchmark::DoNotOptimize(nav);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["time_per_epoch"] =
+        benchmark::Counter(g_imudata.size(), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_GINS_Propagation)->Unit(benchmark::kMillisecond);
+
+/// 21维松组合EKF，1Hz GNSS位置、速度量测更新，items_per_second 即每秒处理的历元数
+static void BM_GINS_EKF(benchmark::State &state) {
+    for (auto _ : state) {
+        NavState nav = runEKF(g_imudata, g_gnssdata);
+        benchmark::DoNotOptimize(nav);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["time_per_epoch"] =
+        benchmark::Counter(g_imudata.size(), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_GINS_EKF)->Unit(benchmark::kMillisecond);
+
+/// 21维松组合EKF，延迟传播协方差，只在1Hz的GNSS更新前传播
+static void BM_GINS_EKF_Lazy(benchmark::State &state) {
+    for (auto _ : state) {
+        NavState nav = runEKF(g_imudata, g_gnssdata, true);
+        benchmark::DoNotOptimize(nav);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["time_per_epoch"] =
+        benchmark::Counter(g_imudata.size(), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_GINS_EKF_Lazy)->Unit(benchmark::kMillisecond);
+
+/// 与 BM_GINS_EKF 相同，启用分阶段计时，两者之差即计时点的开销
+static void BM_GINS_EKF_Profiled(benchmark::State &state) {
+    Profiler::setEnabled(true);
+    for (auto _ : state) {
+        NavState nav = runEKF(g_imudata, g_gnssdata);
+        benchmark::DoNotOptimize(nav);
+    }
+    Profiler::setEnabled(false);
+    Profiler::reset();
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["time_per_epoch"] =
+        benchmark::Counter(g_imudata.size(), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_GINS_EKF_Profiled)->Unit(benchmark::kMillisecond);
+
+// 协方差传播基准测试使用的矩阵，取自实际滤波过程
+static GIEngine::StateMatrix g_phi, g_cov, g_qd;
+
+/// 稠密矩阵乘法的协方差传播
+static void BM_CovPropagation_Dense(benchmark::State &state) {
+    GIEngine::StateMatrix P = g_cov;
+    for (auto _ : state) {
+        P = g_phi * P * g_phi.transpose() + g_qd;
+        benchmark::DoNotOptimize(P.data());
+        P = g_cov;
+    }
+}
+BENCHMARK(BM_CovPropagation_Dense);
+
+/// 只计算非零块和上三角的协方差传播
+static void BM_CovPropagation_Structured(benchmark::State &state) {
+    GIEngine::StateMatrix P = g_cov;
+    for (auto _ : state) {
+        GIEngine::propagateCovariance(g_phi, g_qd, P);
+        benchmark::DoNotOptimize(P.data());
+        P = g_cov;
+    }
+}
+BENCHMARK(BM_CovPropagation_Structured);
+
+/// 延迟传播时每个历元的状态转移矩阵连乘
+static void BM_CovPropagation_Chain(benchmark::State &state) {
+    GIEngine::StateMatrix Phiacc = g_phi;
+    for (auto _ : state) {
+        GIEngine::chainTransition(g_phi, Phiacc);
+        benchmark::DoNotOptimize(Phiacc.data());
+        Phiacc = g_phi;
+    }
+}
+BENCHMARK(BM_CovPropagation_Chain);
+
+/// RTS平滑（正向滤波和反向平滑），参数为节点内存上限（MB），0表示所有节点保存在内存中
+static void BM_GINS_RTS(benchmark::State &state) {
+    size_t peak = 0;
+    vector<NavState> smoothed;
+    for (auto _ : state) {
+        peak = runRTS(g_imudata, g_gnssdata, static_cast<size_t>(state.range(0)) << 20, smoothed);
+        benchmark::DoNotOptimize(smoothed.data());
+    }
+    state.SetItemsProcessed(state.iterations() * min(RTS_EPOCHS, g_imudata.size()));
+    state.counters["peak_memory"] = benchmark::Counter(peak, benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+BENCHMARK(BM_GINS_RTS)->ArgName("MB")->Arg(0)->Arg(64)->Arg(8)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// 结果输出基准测试的输出目录
+static filesystem::path outputDir() {
+    return filesystem::temp_directory_path() / "gins_bench_output";
+}
+
+/// 原先的 result.txt 输出方式
+static void BM_Output_Stream(benchmark::State &state) {
+    filesystem::path file = outputDir() / "result_stream.txt";
+    for (auto _ : state) {
+        writeResultStream(file, g_imudata, g_imudata.size());
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+}
+BENCHMARK(BM_Output_Stream)->Unit(benchmark::kMillisecond);
+
+/// ResultSink 异步输出 result.txt 等全部5个文本文件，参数为抽稀间隔
+static void BM_Output_Sink(benchmark::State &state) {
+    GINSOptions options = outputOptions(outputDir(), false, static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        writeResultSink(options, g_imudata, g_imudata.size());
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+}
+BENCHMARK(BM_Output_Sink)->ArgName("decimation")->Arg(1)->Arg(10)->Unit(benchmark::kMillisecond);
+
+/// ResultSink 输出二进制轨迹文件 result.traj
+static void BM_Output_Binary(benchmark::State &state) {
+    GINSOptions options = outputOptions(outputDir(), true);
+    for (auto _ : state) {
+        writeResultSink(options, g_imudata, g_imudata.size());
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["file_size"] =
+        benchmark::Counter(filesystem::file_size(outputDir() / "result.traj"), benchmark::Counter::kDefaults,
+                           benchmark::Counter::kIs1024);
+}
+BENCHMARK(BM_Output_Binary)->Unit(benchmark::kMillisecond);
+
+/// 读取二进制轨迹文件并按时间查找，每次迭代查找1000个时刻
+static void BM_Trajectory_Seek(benchmark::State &state) {
+    TrajectoryFile traj;
+    if (!writeResultSink(outputOptions(outputDir(), true), g_imudata, g_imudata.size()) ||
+        !traj.open((outputDir() / "result.traj").string())) {
+        state.SkipWithError("写入二进制轨迹文件失败");
+        return;
+    }
+    double first = traj.time(0), span = traj.time(traj.size() - 1) - first;
+    size_t found = 0;
+    for (auto _ : state) {
+        for (int k = 0; k < 1000; k++) {
+            found += traj.lowerBound(first + span * ((k * 7919) % 1000) / 1000.0);
+        }
+    }
+    benchmark::DoNotOptimize(found);
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_Trajectory_Seek);
+
+/**
+ * @brief 完整的松组合解算流程：逐条读取IMU、GNSS文件，GIEngine 滤波，ResultSink 输出文本结果，与 main.cpp 相同
+ *
+ * @param options 配置，使用其中的IMU、GNSS文件和输出设置
+ * @return NavState 最后一个历元的状态，数据读取或输出失败时位置为0
+ */
+static NavState runGINS(GINSOptions options) {
+    NavState failed;
+    failed.pav.pos.setZero();
+    IMUStream imu_stream;
+    GNSSStream gnss_stream;
+    IMU imupre;
+    GNSS gnss;
+    if (!imu_stream.open(options.imufile, true, options.imuformat) || !gnss_stream.open(options.gnssfile) ||
+        !gnss_stream.next(gnss) || !imu_stream.seek(gnss.time, 1) || !imu_stream.next(imupre)) {
+        return failed;
+    }
+    options.initstate.pav.pos = gnss.blh;
+    options.initstate.pav.vel = gnss.vel;
+
+    ResultSink sink(options);
+    GIEngine engine(options);
+    double stdtime = -1.0;
+    FilterDriver::run(
+        engine, imupre, [&](IMU &imu) { return imu_stream.next(imu); },
+        [&](GNSS &gnss) { return gnss_stream.next(gnss); },
+        [&](const IMU &imucur) {
+            NavState state = engine.getNavState();
+            if (ResultSink::isStdEpoch(imucur.time, options.stdinterval, stdtime)) {
+                GIEngine::StateVector std = engine.getCovariance().diagonal().cwiseMax(0).cwiseSqrt();
+                sink.push(ResultSink::navResult(imucur.week, imucur.time, state.pav, &std, engine.gnssUpdated()));
+            } else {
+                sink.push(ResultSink::navResult(imucur.week, imucur.time, state.pav, nullptr, engine.gnssUpdated()));
+            }
+        });
+    return sink.close() ? engine.getNavState() : failed;
+}
+
+/// 完整的 GINS 解算（文件解析、滤波、文本结果输出），items_per_second 即每秒处理的历元数
+static void BM_GINS_Run(benchmark::State &state) {
+    GINSOptions options = outputOptions(outputDir(), false);
+    options.imufile     = g_imufile;
+    options.gnssfile    = g_gnssfile;
+    options.lazycov     = state.range(0) != 0;
+    for (auto _ : state) {
+        NavState nav = runGINS(options);
+        if (nav.pav.pos[0] == 0) {
+            state.SkipWithError("GINS 解算失败");
+            break;
+        }
+        benchmark::DoNotOptimize(nav);
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+}
+BENCHMARK(BM_GINS_Run)->ArgName("lazycov")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/// 实时模式逐帧处理（不经过管道），items_per_second 即每秒处理的帧数
+static void BM_Realtime_Process(benchmark::State &state) {
+    vector<DataFrame> frames = realtimeFrames(g_imudata, g_gnssdata);
+    GINSOptions options      = outputOptions(outputDir(), true);
+    for (auto _ : state) {
+        ResultSink sink(options);
+        RealtimeNavigator navigator(options, sink);
+        for (const DataFrame &frame : frames) {
+            navigator.process(frame);
+        }
+        sink.close();
+    }
+    state.SetItemsProcessed(state.iterations() * frames.size());
+}
+BENCHMARK(BM_Realtime_Process)->Unit(benchmark::kMillisecond);
+
+/// 通过管道以实时模式处理全部数据，输出每个IMU历元处理延迟的分位数和最大值（us）
+static void BM_Realtime_Pipe(benchmark::State &state) {
+    GINSOptions options = outputOptions(outputDir(), false);
+    LatencyHistogram latency;
+    size_t allocations;
+    for (auto _ : state) {
+        if (runRealtimePipe(g_imudata, g_gnssdata, options, latency, nullptr, allocations) < 0) {
+            state.SkipWithError("实时模式解算失败");
+            return;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+    state.counters["p50_us"]  = latency.percentile(0.5) / 1000.0;
+    state.counters["p99_us"]  = latency.percentile(0.99) / 1000.0;
+    state.counters["p999_us"] = latency.percentile(0.999) / 1000.0;
+    state.counters["max_us"]  = latency.max() / 1000.0;
+}
+BENCHMARK(BM_Realtime_Pipe)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/// 生成仿真数据，items_per_second 即每秒生成的IMU历元数
+static void BM_Simulate(benchmark::State &state) {
+    SimOptions sim = simOptions(true);
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    for (auto _ : state) {
+        Simulator::generate(sim, imudata, gnssdata);
+        benchmark::DoNotOptimize(imudata.data());
+    }
+    state.SetItemsProcessed(state.iterations() * imudata.size());
+}
+BENCHMARK(BM_Simulate)->Unit(benchmark::kMillisecond);
+
+/// 参数扫描，参数为线程数，items_per_second 即每秒处理的IMU历元数（各组参数合计）
+static void BM_Sweep(benchmark::State &state) {
+    NoiseSweep sweep         = simulationSweep();
+    vector<ImuNoise> configs = sweepConfigs();
+    ThreadPool pool(state.range(0));
+    for (auto _ : state) {
+        vector<SweepResult> results = sweep.run(configs, pool);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * configs.size() * sweep.size());
+}
+BENCHMARK(BM_Sweep)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, max(1u, thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/// 在按列存储的数据上一次判断所有历元是否静止
+static void BM_StaticDetect_Batch(benchmark::State &state) {
+    ImuView view = g_imubuffer.view();
+    StaticOptions options;
+    vector<uint8_t> flags;
+    for (auto _ : state) {
+        StaticDetector::detect(view, options, ImuFormat().freq, flags);
+        benchmark::DoNotOptimize(flags.data());
+    }
+    state.SetItemsProcessed(state.iterations() * view.size());
+}
+BENCHMARK(BM_StaticDetect_Batch)->Unit(benchmark::kMillisecond);
+
+/// 逐历元的静止检测，即零速修正时 GIEngine 中的用法
+static void BM_StaticDetect_Online(benchmark::State &state) {
+    StaticDetector detector(StaticOptions(), ImuFormat().freq);
+    size_t count = 0;
+    for (auto _ : state) {
+        detector.reset();
+        for (const IMU &imu : g_imudata) {
+            count += detector.update(imu);
+        }
+    }
+    benchmark::DoNotOptimize(count);
+    state.SetItemsProcessed(state.iterations() * g_imudata.size());
+}
+BENCHMARK(BM_StaticDetect_Online)->Unit(benchmark::kMillisecond);
+
+// 用法：gins_bench [--benchmark_*选项] [IMU ASC文件]
+// bytes_per_second 即 MB/s 吞吐量，items_per_second 即每秒解析的记录数。
+// 各模块结果的正确性由单元测试 gins_test 检查，这里只做性能测试
+int main(int argc, char *argv[]) {
+    benchmark::Initialize(&argc, argv);
+
+    bool synthetic = argc < 2;
+    TestData data;
+    if (synthetic) {
+        if (!syntheticData("gins_bench", 360000, data)) {
+            return -1;
+        }
+    } else if (!loadTestData(argv[1], (filesystem::temp_directory_path() / "gins_bench_gnss.pos").string(), data)) {
+        return -1;
+    }
+    g_imufile   = data.imufile;
+    g_gnssfile  = data.gnssfile;
+    g_imudata   = std::move(data.imudata);
+    g_gnssdata  = std::move(data.gnssdata);
+    g_imubuffer = ImuBuffer(g_imudata);
+    sampleCovariance(g_imudata, g_gnssdata, g_phi, g_cov, g_qd);
+
+    // 写入JSON结果（--benchmark_out）的 context，便于跨版本比较时确认数据和编译配置相同
+    benchmark::AddCustomContext("gins_version", GINS_VERSION);
+    benchmark::AddCustomContext("gins_dataset", synthetic ? "synthetic" : g_imufile);
+    benchmark::AddCustomContext("gins_epochs", to_string(g_imudata.size()));
+    benchmark::AddCustomContext("gins_profiling", Profiler::compiled() ? "on" : "off");
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    filesystem::remove_all(outputDir());
+    filesystem::remove(g_gnssfile);
+    if (synthetic) {
+        filesystem::remove(g_imufile);
+    }
+    return 0;
+}
@@ -1,102 +1,476 @@
+#include "CLI/CLI.hpp"
+#include "datastream.hpp"
+#include "driver.hpp"
 #include "fileio.hpp"
-#include "insmech.hpp"
-#include "rotation.hpp"
+#include "gins.hpp"
+#include "profiler.hpp"
+#include "realtime.hpp"
+#include "resultsink.hpp"
+#include "smoother.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <unistd.h>
 #include <vector>
 using namespace std;
 
 // #define GINSDebug
 
-// 接收两个路径参数，第一个是IMU观测文件路径，第二个是GNSS定位结果文件路径
-int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        cerr << "参数数量错误，请检查！\n需要接收两个路径参数，第一个是IMU观测文件（ASC）路径，第二个是GNSS定位结果文件"
-                "（pos）路径"
-             << endl;
-        exit(-1);
+/**
+ * @brief 正向滤波处理全部数据，逐历元把滤波结果交给输出线程
+ *
+ * @tparam Filter GIEngine 或 RTSSmoother
+ * @param filter 滤波器
+ * @param engine 滤波器内部的 GIEngine，用于读取当前状态
+ * @param imupre 起始IMU历元
+ * @param sink 结果输出
+ * @param stdinterval 每隔 stdinterval 秒输出一次标准差，为0时不输出
+ * @return size_t 处理的IMU历元数
+ */
+template <typename Filter>
+static size_t runFilter(Filter &filter, const GIEngine &engine, const IMU &imupre, IMUStream &imu_stream,
+                        GNSSStream &gnss_stream, ResultSink &sink, double stdinterval) {
+    double stdtime = -1.0; // 下一次输出标准差的时刻
+    return FilterDriver::run(
+        filter, imupre, [&](IMU &imu) { return imu_stream.next(imu); },
+        [&](GNSS &gnss) { return gnss_stream.next(gnss); },
+        [&](const IMU &imucur) {
+            // 只在输出标准差的历元取协方差，延迟传播时其余历元不传播协方差
+            NavState state = engine.getNavState();
+            if (ResultSink::isStdEpoch(imucur.time, stdinterval, stdtime)) {
+                GIEngine::StateVector std = engine.getCovariance().diagonal().cwiseMax(0).cwiseSqrt();
+                sink.push(ResultSink::navResult(imucur.week, imucur.time, state.pav, &std, engine.gnssUpdated()));
+            } else {
+                sink.push(ResultSink::navResult(imucur.week, imucur.time, state.pav, nullptr, engine.gnssUpdated()));
+            }
+        });
+}
+
+/**
+ * @brief 实时模式：从数据源逐帧读取IMU和GNSS数据，每个IMU历元输出一次结果，结束后输出延迟统计
+ *
+ * 处理延迟为读到一帧数据到结果交给输出线程的时间；数据帧带有发送时刻时，同时统计从发送到输出的端到端延迟。
+ * 数据源为套接字时，每处理完一个IMU历元回送一个确认帧。最大处理延迟与预算比较，但不保证不超出预算
+ *
+ * @param source 数据源，见 FrameIO::openSource
+ * @param echo 是否同时在终端输出逐历元的结果
+ * @param rtopts 实时设置（锁定内存、实时优先级、绑定CPU核心）和延迟预算
+ */
+static int runRealtime(const GINSOptions &options, const string &source, bool echo, const RealtimeOptions &rtopts) {
+    int fd = FrameIO::openSource(source);
+    if (fd < 0) {
+        return -1;
+    }
+    ResultSink sink(options, "", echo);
+    if (!sink.isOpen()) {
+        return -1;
+    }
+    RealtimeNavigator navigator(options, sink);
+    sink.prefault();
+    RealtimeNavigator::configureThread(rtopts);
+    LatencyHistogram latency, endtoend;
+    DataFrame frame;
+    bool ack = FrameIO::isSocket(fd);
+    signal(SIGPIPE, SIG_IGN);
+    uint64_t budget = static_cast<uint64_t>(rtopts.budget * 1E6);
+    size_t over     = 0; // 处理延迟超出预算的历元数
+    while (FrameIO::readFrame(fd, frame)) {
+        uint64_t received = FrameIO::now();
+        if (navigator.process(frame)) {
+            uint64_t done = FrameIO::now();
+            latency.record(done - received);
+            over += done - received > budget;
+            if (frame.stamp != 0 && done > frame.stamp) {
+                endtoend.record(done - frame.stamp);
+            }
+            if (ack && !FrameIO::writeFrame(fd, FrameIO::ackFrame(frame))) {
+                ack = false;
+            }
+        }
+    }
+    if (fd != 0) {
+        close(fd);
+    }
+    if (!sink.close()) {
+        return -1;
     }
+    if (!navigator.initialized()) {
+        cerr << "实时数据中没有GNSS数据，未能初始化！" << endl;
+        return -1;
+    }
+
+    // 输出结果时终端可能在显示逐历元结果，统计信息输出到标准错误
+    latency.report(cerr, "处理延迟");
+    cerr << "最大处理延迟 " << latency.max() / 1E6 << " ms，" << over << " 个历元超出 " << rtopts.budget << " ms 的预算"
+         << endl;
+    if (endtoend.count() > 0) {
+        endtoend.report(cerr, "端到端延迟");
+    }
+    if (navigator.lateGnss() > 0) {
+        cerr << navigator.lateGnss() << " 个GNSS数据晚于所在的IMU历元到达，未用于量测更新" << endl;
+    }
+    return 0;
+}
 
-    string imufile = argv[1];
-    string posfile = argv[2];
+/**
+ * @brief 后处理解算一个数据集：逐条读取IMU、GNSS文件，滤波（和RTS平滑）并输出结果
+ *
+ * 所有状态都在函数内部，不同数据集可以在多个线程中同时解算
+ * @param options 松组合配置参数
+ * @param rts 是否进行RTS平滑
+ * @param rts_memory RTS平滑保存滤波节点的内存上限（MB）
+ * @param echo 是否同时在终端输出逐历元的结果
+ * @param verbose 是否在终端输出开始、结束和RTS平滑的统计信息，批处理时为 false
+ * @param [out] epochs 处理的IMU历元数
+ * @return int 成功时返回0，失败时返回-1
+ */
+static int runPostProcess(GINSOptions options, bool rts, size_t rts_memory, bool echo, bool verbose,
+                          size_t &epochs) {
+    epochs = 0;
 
-    vector<IMU> imu_data;          // 总的IMU观测数据
-    vector<GNSS> gnss_data;        // 总的GNSS定位结果数据
-    int imu_idx = 0, gnss_idx = 0; // 用于时间对齐的数据索引
+    // IMU和GNSS数据按需逐条读取，常驻内存不随数据时长增长
+    IMUStream imu_stream;
+    GNSSStream gnss_stream;
 
-    if (!FileIO::getIMUdata(imufile, imu_data)) {
+    if (!imu_stream.open(options.imufile, true, options.imuformat)) {
         cerr << "IMU数据文件读取失败！" << endl;
-        exit(-1);
+        return -1;
     }
-    if (!FileIO::getGNSSdata(posfile, gnss_data)) {
+    if (!gnss_stream.open(options.gnssfile)) {
         cerr << "GNSS定位结果pos数据文件读取失败！" << endl;
-        exit(-1);
+        return -1;
+    }
+
+    // 只处理 [starttime, endtime) 时段时，两个数据流都二分查找定位，处理时间与时段长度成正比
+    if (options.endtime > 0) {
+        imu_stream.setEnd(options.endtime);
+        gnss_stream.setEnd(options.endtime);
+    }
+    if (options.starttime > 0) {
+        gnss_stream.seek(options.starttime);
     }
 
-    PVA pvapre; // k-1 时刻位置、速度、姿态
+    GNSS gnss; // 当前的GNSS定位结果
+    if (!gnss_stream.next(gnss)) {
+        cerr << "GNSS定位结果pos数据文件中没有数据！" << endl;
+        return -1;
+    }
 
-    // 初始化
-    while (imu_data[imu_idx].time < gnss_data[gnss_idx].time) {
+    // 初始化，从第一个GNSS历元之前的最后一个IMU历元开始解算
+    IMU imupre; // k-1 时刻IMU输出数据
+    if (!imu_stream.seek(gnss.time, 1) || !imu_stream.next(imupre)) {
+        cerr << "IMU数据文件中没有数据！" << endl;
+        return -1;
+    }
 #ifdef GINSDebug
-        cout.flags(ios::fixed);
-        cout.precision(6);
-        cout << "imu time: " << imu_data[imu_idx].time << ",\t" << "gnss time: " << gnss_data[gnss_idx].time << endl;
+    cout.flags(ios::fixed);
+    cout.precision(6);
+    cout << "imu time: " << imupre.time << ",\t" << "gnss time: " << gnss.time << endl;
 #endif
-        imu_idx++;
-    }
-    pvapre.pos = gnss_data[gnss_idx].blh;
-    pvapre.vel = gnss_data[gnss_idx].vel;
-    pvapre.att.euler << -0.387651 * D2R, 0.3049 * D2R, -87.5535 * D2R;
-    pvapre.att.qbn = Rotation::euler2quaternion(pvapre.att.euler);
-    pvapre.att.cbn = Rotation::euler2matrix(pvapre.att.euler);
+    // 初始位置取自第一个GNSS历元，从下一个GNSS历元开始量测更新
+    options.initstate.pav.pos = gnss.blh;
+    options.initstate.pav.vel = gnss.vel;
 #ifdef GINSDebug
-    cout << "GNSS 位置：" << gnss_data[gnss_idx].blh.transpose() * R2D << endl;
-    cout << "初始位置：" << pvapre.pos.transpose() << endl;
-    cout << "初始速度：" << pvapre.vel.transpose() << endl;
-    cout << "初始姿态：" << pvapre.att.euler.transpose() << endl;
+    cout << "GNSS 位置：" << gnss.blh.transpose() * R2D << endl;
+    cout << "初始姿态：" << options.initstate.pav.att.euler.transpose() * R2D << endl;
 #endif
-    PVA pvacur; // k 时刻位置、速度、姿态
-    pvacur = pvapre;
 
-    IMU imupre; // k-1 时刻IMU输出数据
-    IMU imucur; // k 时刻IMU输出数据
-
-    fstream fout("result.txt", ios::out);
-    cout << "\n***开始计算结果：***\n" << endl;
-
-    for (; imu_idx < imu_data.size(); imu_idx++) {
-        if (imu_data[imu_idx].time <= gnss_data[gnss_idx + 1].time &&
-            imu_data[imu_idx + 1].time > gnss_data[gnss_idx + 1].time && false) {
-            // 如果GNSS数据位于 k 时刻和 k+1 时刻之间，将当前位置更新为GNSS
-            pvapre     = pvacur;
-            pvacur.pos = gnss_data[gnss_idx].blh;
-            pvacur.vel = gnss_data[gnss_idx].vel;
-            gnss_idx++;
-        } else {
-            // 如果 k 时刻和 k+1 时刻之间没有GNSS数据，则进行机械编排更新
-            imupre = imu_data[imu_idx - 1];
-            imucur = imu_data[imu_idx];
-            if (imucur.dvel.norm() < 1E-10 || imucur.dtheta.norm() < 1E-10) {
+    // 结果由输出线程异步写入，result.txt、navres.txt、blhres.txt、navxyz.txt、navresstd.txt 或 result.traj
+    ResultSink sink(options, "", echo);
+    if (!sink.isOpen()) {
+        return -1;
+    }
+    if (verbose) {
+        cout << "\n***开始计算结果：***\n" << endl;
+    }
+
+    if (!rts) {
+        GIEngine engine(options);
+        epochs = runFilter(engine, engine, imupre, imu_stream, gnss_stream, sink, options.stdinterval);
+        if (!sink.close()) {
+            return -1;
+        }
+        if (verbose) {
+            cout << "结果输出在 " << options.outputpath << " 文件夹中！" << endl;
+        }
+        return 0;
+    }
+
+    auto start = chrono::steady_clock::now();
+    RTSSmoother smoother(options, rts_memory << 20, options.outputpath);
+    if (!smoother.isOpen()) {
+        return -1;
+    }
+    epochs = runFilter(smoother, smoother.engine(), imupre, imu_stream, gnss_stream, sink, options.stdinterval);
+    if (!sink.close()) {
+        return -1;
+    }
+    auto forward = chrono::steady_clock::now();
+
+    // 平滑结果输出到带 _rts 后缀的文件，平滑结果不区分GNSS历元，只按 outputdecimation 抽稀
+    GINSOptions rts_options = options;
+    rts_options.gnssonly    = false;
+    ResultSink sink_rts(rts_options, "_rts");
+    if (!sink_rts.isOpen()) {
+        return -1;
+    }
+    double stdtime = -1.0;
+    int week       = imupre.week; // 平滑结果不带GPS周，取数据开始时的GPS周
+    bool smoothed  = smoother.smooth([&](double time, const NavState &state, const RTSSmoother::StateVector &std) {
+        bool isstd = ResultSink::isStdEpoch(time, options.stdinterval, stdtime);
+        sink_rts.push(ResultSink::navResult(week, time, state.pav, isstd ? &std : nullptr, false));
+    });
+    if (!smoothed || !sink_rts.close()) {
+        return -1;
+    }
+    auto backward = chrono::steady_clock::now();
+
+    if (!verbose) {
+        return 0;
+    }
+    cout << "RTS平滑：" << smoother.epochCount() << " 个滤波节点，" << smoother.checkpointCount() << " 个分段，"
+         << "节点内存峰值 " << smoother.peakMemory() / 1048576.0 << " MB" << endl;
+    cout << "正向滤波耗时 " << chrono::duration<double>(forward - start).count() << " s，反向平滑耗时 "
+         << chrono::duration<double>(backward - forward).count() << " s" << endl;
+    cout << "结果输出在 " << options.outputpath << " 文件夹中，平滑结果文件名带 _rts 后缀！" << endl;
+    return 0;
+}
+
+// 批处理中的一个作业（数据集）
+typedef struct BatchJob {
+    string configfile;   // 配置文件路径
+    GINSOptions options; // 配置参数，输出目录已按批处理的规则确定
+    string error;        // 解算前发现的错误，非空时不解算
+    int ret        = -1; // runPostProcess 的返回值
+    size_t epochs  = 0;  // 处理的IMU历元数
+    double seconds = 0;  // 解算耗时（s）
+} BatchJob;
+
+/**
+ * @brief 列出批处理的配置文件
+ *
+ * @param source 目录（取其中所有 .yaml、.yml 文件，按文件名排序），或清单文件（每行一个配置文件路径，
+ *               相对路径相对于清单文件所在目录，空行和 # 开头的行忽略）
+ * @param [out] configfiles 配置文件路径
+ * @return true 读取成功
+ * @return false 目录或清单文件读取失败
+ */
+static bool listConfigs(const string &source, vector<string> &configfiles) {
+    error_code ec;
+    if (filesystem::is_directory(source, ec)) {
+        for (const auto &entry : filesystem::directory_iterator(source, ec)) {
+            string ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".yaml" || ext == ".yml")) {
+                configfiles.push_back(entry.path().string());
+            }
+        }
+        sort(configfiles.begin(), configfiles.end());
+        return !ec;
+    }
+    ifstream ifs(source);
+    if (!ifs.is_open()) {
+        cerr << "批处理清单：" << source << " 打开失败！" << endl;
+        return false;
+    }
+    filesystem::path base = filesystem::path(source).parent_path();
+    string line;
+    while (getline(ifs, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        size_t last  = line.find_last_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') {
+            continue;
+        }
+        filesystem::path path = line.substr(first, last - first + 1);
+        configfiles.push_back((path.is_relative() ? base / path : path).string());
+    }
+    return true;
+}
+
+/**
+ * @brief 批处理：在线程池中同时解算多个数据集，结束后输出每个作业的耗时和吞吐量
+ *
+ * 每个作业使用各自的配置参数（包括IMU数据的转换因子）、数据流、滤波器和输出线程，作业之间不共享可变状态。
+ * 线程池的工作线程从共享队列中取作业，IMU文件大的作业先提交，避免最长的作业最后才开始。
+ * 指定 outputroot 时每个作业输出到 outputroot 下以配置文件名命名的目录，否则使用配置文件中的 outputpath，
+ * 此时输出目录相同的作业不解算
+ * @param source 配置文件目录或清单文件，见 listConfigs
+ * @param outputroot 输出根目录，为空时使用各配置文件中的输出目录
+ * @param jobs 同时解算的作业数，为0时使用硬件并发线程数
+ * @return int 全部作业成功时返回0，否则返回-1
+ */
+static int runBatch(const string &source, const string &outputroot, size_t jobs, bool rts, size_t rts_memory) {
+    vector<string> configfiles;
+    if (!listConfigs(source, configfiles)) {
+        return -1;
+    }
+    if (configfiles.empty()) {
+        cerr << "批处理：" << source << " 中没有配置文件！" << endl;
+        return -1;
+    }
+
+    vector<BatchJob> batch(configfiles.size());
+    map<string, size_t> outputs; // 输出目录 -> 第一个使用它的作业
+    for (size_t i = 0; i < batch.size(); i++) {
+        BatchJob &job  = batch[i];
+        job.configfile = configfiles[i];
+        if (!FileIO::loadOptions(job.configfile, job.options)) {
+            job.error = "配置文件读取失败";
+            continue;
+        }
+        if (!outputroot.empty()) {
+            job.options.outputpath = (filesystem::path(outputroot) / filesystem::path(job.configfile).stem()).string();
+        }
+        error_code ec;
+        filesystem::create_directories(job.options.outputpath, ec);
+        string key = filesystem::weakly_canonical(job.options.outputpath, ec).string();
+        auto res   = outputs.emplace(key, i);
+        if (!res.second) {
+            job.error = "输出目录与 " + batch[res.first->second].configfile + " 相同";
+        }
+    }
+
+    // IMU文件大的作业先提交
+    vector<size_t> order(batch.size());
+    vector<uintmax_t> sizes(batch.size(), 0);
+    for (size_t i = 0; i < batch.size(); i++) {
+        error_code ec;
+        order[i] = i;
+        sizes[i] = batch[i].error.empty() ? filesystem::file_size(batch[i].options.imufile, ec) : 0;
+        sizes[i] = ec ? 0 : sizes[i];
+    }
+    stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    auto start = chrono::steady_clock::now();
+    {
+        ThreadPool pool(jobs);
+        vector<future<void>> results;
+        for (size_t i : order) {
+            BatchJob &job = batch[i];
+            if (!job.error.empty()) {
                 continue;
             }
-            INSMech::insMech(pvapre, pvacur, imupre, imucur);
-            cout.flags(ios::fixed);
-            cout.precision(8);
-            cout << imucur.time << " " << pvacur.pos[0] * R2D << " " << pvacur.pos[1] * R2D << " " << pvacur.pos[2]
-                 << " " << pvacur.vel[0] << " " << pvacur.vel[1] << " " << pvacur.vel[2] << " "
-                 << pvacur.att.euler[0] * R2D << " " << pvacur.att.euler[1] * R2D << " " << pvacur.att.euler[2] * R2D
-                 << endl;
-
-            // 输出到result.txt文件
-            fout.flags(ios::fixed);
-            fout.precision(8);
-            fout << imucur.time << " " << pvacur.pos[0] * R2D << " " << pvacur.pos[1] * R2D << " " << pvacur.pos[2]
-                 << " " << pvacur.vel[0] << " " << pvacur.vel[1] << " " << pvacur.vel[2] << " "
-                 << pvacur.att.euler[0] * R2D << " " << pvacur.att.euler[1] * R2D << " " << pvacur.att.euler[2] * R2D
-                 << endl;
+            results.emplace_back(pool.submit([&job, rts, rts_memory]() {
+                auto begin  = chrono::steady_clock::now();
+                job.ret     = runPostProcess(job.options, rts, rts_memory, false, false, job.epochs);
+                job.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            }));
+        }
+        for (auto &res : results) {
+            res.get();
         }
     }
-    cout << "结果输出在data文件夹的result.txt中！" << endl;
-    fout.close();
-    return 0;
-}
\ No newline at end of file
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 按配置文件的顺序输出每个作业的结果
+    size_t failed = 0, epochs = 0;
+    double busy   = 0;
+    cout << fixed << setprecision(3);
+    for (const BatchJob &job : batch) {
+        if (!job.error.empty() || job.ret != 0) {
+            failed++;
+            cout << "[失败] " << job.configfile << "：" << (job.error.empty() ? "解算失败" : job.error) << endl;
+            continue;
+        }
+        epochs += job.epochs;
+        busy += job.seconds;
+        cout << "[完成] " << job.configfile << "：" << job.epochs << " 个历元，耗时 " << job.seconds << " s，"
+             << setprecision(0) << job.epochs / max(job.seconds, 1E-9) << " 历元/s" << setprecision(3)
+             << "，输出在 " << job.options.outputpath << endl;
+    }
+    cout << "批处理：" << batch.size() - failed << " 个作业完成，" << failed << " 个失败，总耗时 " << wall << " s，"
+         << setprecision(0) << epochs / max(wall, 1E-9) << " 历元/s，" << setprecision(2) << "平均并发作业数 "
+         << busy / max(wall, 1E-9) << endl;
+    return failed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief 输出各阶段的耗时统计
+ *
+ * @param summary 是否在标准错误输出汇总表
+ * @param jsonfile JSON文件路径，为空时不写入
+ */
+static void reportProfile(bool summary, const string &jsonfile) {
+    if (summary) {
+        Profiler::report(cerr);
+    }
+    if (!jsonfile.empty()) {
+        Profiler::writeJson(jsonfile);
+    }
+}
+
+// 接收一个yaml配置文件路径参数，配置文件中给出IMU观测文件、GNSS定位结果文件和松组合参数
+int main(int argc, char *argv[]) {
+    CLI::App app{"GNSS-INS松组合程序使用方法如下：\n\t./bin/GINS ./dataset/gins.yaml\n"};
+    string configfile;
+    bool rts          = false;
+    bool echo         = false;
+    size_t rts_memory = 1024;
+    string source, profile_json;
+    bool profile = false;
+    app.add_option("config_path", configfile, "输入配置yaml文件，批处理时为配置文件目录或清单文件")->required();
+    app.add_flag("-s,--rts", rts, "是否进行RTS平滑");
+    app.add_option("-m,--rts-memory", rts_memory, "RTS平滑保存滤波节点的内存上限（MB），0表示不限制")->default_val(1024);
+    app.add_flag("-e,--echo", echo, "是否同时在终端输出逐历元的结果");
+    app.add_option("-r,--realtime", source, "实时模式的数据源：-（标准输入）、管道路径或 unix:套接字路径");
+    RealtimeOptions rtopts;
+    app.add_flag("--rt-lock", rtopts.lockmemory, "实时模式锁定全部内存（mlockall），避免处理过程中缺页");
+    app.add_option("--rt-priority", rtopts.priority, "实时模式处理线程的 SCHED_FIFO 优先级（1~99），0表示不改变")
+        ->default_val(0);
+    app.add_option("--rt-cpu", rtopts.cpu, "实时模式处理线程绑定的CPU核心，-1表示不绑定")->default_val(-1);
+    app.add_option("--rt-budget", rtopts.budget, "实时模式每个IMU历元处理延迟的预算（ms）")->default_val(5.0);
+    bool batch = false;
+    size_t jobs{0};
+    string outputroot;
+    app.add_flag("-b,--batch", batch, "批处理：同时解算目录或清单中的所有配置文件");
+    app.add_option("-j,--jobs", jobs, "批处理同时解算的数据集个数，0表示使用全部CPU核心")->default_val(0);
+    app.add_option("-o,--output", outputroot, "批处理的输出根目录，每个数据集输出到以配置文件名命名的子目录");
+    app.add_flag("-p,--profile", profile, "结束时在标准错误输出各阶段的耗时统计");
+    app.add_option("--profile-json", profile_json, "把各阶段的耗时统计和直方图写入JSON文件");
+    CLI11_PARSE(app, argc, argv);
+
+    if (profile || !profile_json.empty()) {
+        if (!Profiler::compiled()) {
+            cerr << "编译时未启用计时点（GINS_PROFILING=OFF），没有耗时统计！" << endl;
+        }
+        Profiler::setEnabled(true);
+    }
+
+    if (batch) {
+        if (!source.empty()) {
+            cerr << "批处理不支持实时模式！" << endl;
+            exit(-1);
+        }
+        int ret = runBatch(configfile, outputroot, jobs, rts, rts_memory);
+        reportProfile(profile, profile_json);
+        return ret;
+    }
+
+    GINSOptions options;
+    if (!FileIO::loadOptions(configfile, options)) {
+        exit(-1);
+    }
+
+    if (!source.empty()) {
+        if (rts) {
+            cerr << "实时模式不支持RTS平滑！" << endl;
+            exit(-1);
+        }
+        int ret = runRealtime(options, source, echo, rtopts);
+        reportProfile(profile, profile_json);
+        return ret;
+    }
+
+    size_t epochs;
+    int ret = runPostProcess(options, rts, rts_memory, echo, true, epochs);
+    if (ret == 0) {
+        reportProfile(profile, profile_json);
+    }
+    return ret;
+}
@@ -1,44 +1,132 @@
 #include "CLI/CLI.hpp"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "allan.hpp"
+#include "datacache.hpp"
+#include "datastream.hpp"
 #include "earth.hpp"
 #include "fileio.hpp"
+#include "imubuffer.hpp"
 #include "init.hpp"
+#include "profiler.hpp"
+#include "realtime.hpp"
+#include "resultsink.hpp"
 #include "rotation.hpp"
+#include "simulator.hpp"
+#include "staticdetector.hpp"
+#include "sweep.hpp"
+#include "trajectory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
 using namespace std;
 using Eigen::Matrix3d;
 
 /**
- * @brief 计算初始对准结果，注意修改 start_idx, end_idx, phi
+ * @brief 计算初始对准结果，只读取对准时段的数据
  *
  * @param imufile 用于初始对准的IMU观测数据
+ * @param start 对准时段的开始时刻（周内秒）
+ * @param duration 对准时段的时长（s）
+ * @param format 转换因子和采样频率
  */
-void initAtt(const string &imufile, const int &start_idx = 0, const int &end_idx = 30000,
-             const double &phi = 30.528297320436) {
-    vector<IMU> imudata;
+void initAtt(const string &imufile, double start = 0, double duration = 300.0, const ImuFormat &format = ImuFormat()) {
     cout << "IMU数据文件为: " << imufile << endl;
-    FileIO::getIMUdata(imufile, imudata, false);
-    cout << "总历元数: " << imudata.size() << endl;
+    IMUStream stream;
+    if (!stream.open(imufile, false, format)) {
+        cerr << "IMU数据文件读取失败！" << endl;
+        return;
+    }
+    // 二分查找定位到对准时段，只解析时段内的数据
+    if ((start > 0 && !stream.seek(start)) || stream.peek() == nullptr) {
+        cerr << "IMU数据文件中没有对准时段的数据！" << endl;
+        return;
+    }
+    start = stream.peek()->time;
+    stream.setEnd(start + duration);
+    vector<IMU> imudata;
+    IMU imu;
+    while (stream.next(imu)) {
+        imudata.push_back(imu);
+    }
+    cout << "对准时段: " << fixed << setprecision(3) << start << " ~ " << imudata.back().time << "，历元数: "
+         << imudata.size() << defaultfloat << endl;
 
-    // 进行初始对准
-    Vector3d initAtt = getInitAtt(imudata, start_idx, end_idx, phi);
+    // 进行初始对准，对准时段转换为按列存储后批量求均值
+    ImuBuffer static_data(imudata, 0, imudata.size());
+    Vector3d initAtt = getInitAtt(static_data.view());
     cout << "初始对准结果为[roll, pitch, yaw]: " << initAtt.transpose() * R2D << endl;
 }
 
+/**
+ * @brief 自动检测所有静止时段，并在线程池中对每个时段做解析粗对准
+ *
+ * @param imufile IMU ASC格式数据文件
+ * @param options 静止检测参数
+ * @param threads 线程数，0表示使用全部CPU核心
+ * @param format 转换因子和采样频率，窗口时长按采样频率换算为历元数
+ */
+int initAttAuto(const string &imufile, const StaticOptions &options, int threads,
+                const ImuFormat &format = ImuFormat()) {
+    cout << "IMU数据文件为: " << imufile << endl;
+    IMUStream stream;
+    if (!stream.open(imufile, true, format)) {
+        cerr << "IMU数据文件读取失败！" << endl;
+        return -1;
+    }
+    ImuBuffer buffer;
+    IMU imu;
+    while (stream.next(imu)) {
+        buffer.push_back(imu);
+    }
+    ImuView imudata                  = buffer.view();
+    vector<StaticInterval> intervals = StaticDetector::intervals(imudata, options, format.freq);
+    if (intervals.empty()) {
+        cerr << "没有检测到不短于 " << options.mintime << " s 的静止时段！" << endl;
+        return -1;
+    }
+    ThreadPool pool(threads);
+    StaticDetector::align(imudata, intervals, pool);
+
+    cout << absl::StrFormat("%12s %12s %8s %9s %9s %9s\n", "start", "end", "time(s)", "roll", "pitch", "yaw");
+    for (const StaticInterval &interval : intervals) {
+        Vector3d att = interval.att * R2D;
+        cout << absl::StrFormat("%12.3f %12.3f %8.1f %9.4f %9.4f %9.4f\n", interval.start, interval.end,
+                                interval.end - interval.start, att[0], att[1], att[2]);
+    }
+    return 0;
+}
+
 /**
  * @brief 计算Allan方长结果
  *
  * @param imufile
  * @param outfile
+ * @param overlapping 是否使用重叠估计
+ * @param points_per_decade 大于0时按对数等间隔选取簇长度，否则沿用 bins = 2~10000 的分块方式
+ * @param threads 解析和计算线程数，为0时使用硬件并发线程数
  */
-void initAllan(const string &imufile, const string &outfile) {
+void initAllan(const string &imufile, const string &outfile, bool overlapping = false, int points_per_decade = 0,
+               int threads = 0) {
+    GINS_PROFILE_SCOPE("allan");
     vector<IMU> imudata;
     cout << "IMU数据文件为: " << imufile << endl;
-    getRawIMUdata(imufile, imudata);
+    getRawIMUdata(imufile, imudata, threads);
     int size = imudata.size();
     cout << "总历元数: " << size << endl;
-    vector<double> res_allan_std;
 
     if (outfile.substr(outfile.find_last_of(".") + 1, 3) != "txt") {
         cerr << "输出文件名必须为txt格式" << endl;
@@ -48,45 +136,550 @@ void initAllan(const string &imufile, const string &outfile) {
     fstream fout(outfile, ios::out);
     constexpr absl::string_view format = "%-15.9lf ";
 
-    for (int bins = 2; bins < 10000; bins += 10) {
-        allanAnalysis(imudata, 0, size, bins, res_allan_std);
+    auto formatLine = [&format](const AllanVariance::AxisValues &res_allan_std) {
         string line = absl::StrFormat(format, res_allan_std[0]);
         for (int i = 1; i < res_allan_std.size(); i++) {
             absl::StrAppendFormat(&line, format, res_allan_std[i]);
         }
-        cout << "bins = " << bins << "\t" << line << endl;
-        fout << "bins=" << bins << "\t" << line << '\n';
+        return line;
+    };
+
+    // 累积和只需构建一次，之后每个簇长度的计算量只与簇的个数有关，各簇长度在线程池中并行计算
+    AllanVariance allan(imudata, 0, size);
+    ThreadPool pool(threads);
+    if (points_per_decade > 0) {
+        size_t max_m = overlapping ? allan.size() / 2 : allan.size() / 9;
+        auto ms      = AllanVariance::logSpacedClusters(max_m, points_per_decade);
+        auto res     = allan.deviations(ms, overlapping, &pool);
+        for (size_t i = 0; i < ms.size(); i++) {
+            string line = formatLine(res[i]);
+            double tau  = static_cast<double>(ms[i]) / ImuFormat().freq;
+            cout << "tau = " << tau << "\t" << line << endl;
+            fout << absl::StrFormat("tau=%-12.4lf\t", tau) << line << '\n';
+        }
+    } else {
+        vector<int> bins;
+        vector<size_t> ms;
+        for (int b = 2; b < 10000; b += 10) {
+            bins.push_back(b);
+            ms.push_back(allan.size() / b);
+        }
+        auto res = overlapping ? allan.deviations(ms, true, &pool) : allan.deviationsByBins(bins, &pool);
+        for (size_t i = 0; i < bins.size(); i++) {
+            string line = formatLine(res[i]);
+            cout << "bins = " << bins[i] << "\t" << line << endl;
+            fout << "bins=" << bins[i] << "\t" << line << '\n';
+        }
     }
     fout.close();
 }
 
+/**
+ * @brief 将ASC/pos数据文件转换为二进制缓存，之后的读取会自动使用缓存
+ *
+ * @param srcfiles ASC格式的IMU数据文件或pos格式的GNSS数据文件
+ */
+int convertData(const vector<string> &srcfiles) {
+    int failed = 0;
+    for (const auto &srcfile : srcfiles) {
+        if (DataCache::convert(srcfile)) {
+            cout << "已生成缓存文件: " << DataCache::cachePath(srcfile) << endl;
+        } else {
+            cerr << "文件转换失败: " << srcfile << endl;
+            failed++;
+        }
+    }
+    return failed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief 将二进制轨迹文件转换为 result.txt、navres.txt 等文本文件，结果与直接输出文本时相同
+ *
+ * @param trajfile 二进制轨迹文件，文件名 result_rts.traj 对应的文本文件名带 _rts 后缀
+ * @param outputpath 输出目录，为空时与轨迹文件同目录
+ * @param start 只转换周内秒不小于 start 的记录
+ * @param end 只转换周内秒小于 end 的记录
+ */
+int convertTrajectory(const string &trajfile, string outputpath, double start, double end) {
+    TrajectoryFile traj;
+    if (!traj.open(trajfile)) {
+        cerr << "轨迹文件：" << trajfile << " 打开失败或格式错误！" << endl;
+        return -1;
+    }
+    filesystem::path path(trajfile);
+    if (outputpath.empty()) {
+        outputpath = path.has_parent_path() ? path.parent_path().string() : ".";
+    }
+    string stem   = path.stem().string();
+    string suffix = stem.rfind("result", 0) == 0 ? stem.substr(6) : "_" + stem;
+
+    GINSOptions options;
+    options.outputpath   = outputpath;
+    options.decimation   = 1;
+    options.gnssonly     = false;
+    options.binaryoutput = false;
+    options.stdinterval  = traj.hasStd() ? 1.0 : 0.0;
+    ResultSink sink(options, suffix);
+    if (!sink.isOpen()) {
+        return -1;
+    }
+    // 按时间查找起止记录，不需要扫描之前的记录
+    size_t first = traj.lowerBound(start);
+    size_t last  = traj.lowerBound(end);
+    for (size_t i = first; i < last; i++) {
+        sink.push(traj.get(i));
+    }
+    if (!sink.close()) {
+        return -1;
+    }
+    cout << "已转换 " << last - first << " 条记录，输出在 " << outputpath << " 文件夹中" << endl;
+    return 0;
+}
+
+/**
+ * @brief 生成仿真数据：IMU ASC文件、GNSS pos文件和真值结果文件
+ *
+ * 数据文件路径、IMU噪声参数、初始姿态、天线杆臂和转换因子取自配置文件，生成的数据可以直接用同一个配置文件处理，
+ * 真值按 ResultSink 的格式输出到结果目录，文件名带 _truth 后缀
+ * @param configfile 配置文件路径
+ * @param sim 仿真参数，噪声参数等由配置文件覆盖
+ */
+int simulateData(const string &configfile, SimOptions sim) {
+    GINSOptions options;
+    if (!FileIO::loadOptions(configfile, options)) {
+        return -1;
+    }
+    sim.imunoise = options.imunoise;
+    sim.initatt  = options.initstate.pav.att.euler;
+    sim.antlever = options.antlever;
+    sim.format   = options.imuformat;
+
+    error_code ec;
+    for (const auto &file : {options.imufile, options.gnssfile}) {
+        filesystem::path parent = filesystem::path(file).parent_path();
+        if (!parent.empty()) {
+            filesystem::create_directories(parent, ec);
+        }
+    }
+    filesystem::create_directories(options.outputpath, ec);
+
+    // 真值每个IMU历元输出一次，没有标准差
+    options.decimation  = 1;
+    options.gnssonly    = false;
+    options.stdinterval = 0;
+    ResultSink truth(options, "_truth");
+    if (!truth.isOpen()) {
+        return -1;
+    }
+    bool ok = Simulator::writeFiles(sim, options.imufile, options.gnssfile, &truth);
+    if (!truth.close() || !ok) {
+        return -1;
+    }
+    cout << "已生成 " << sim.duration << " s 的仿真数据：" << options.imufile << "、" << options.gnssfile
+         << "，真值输出在 " << options.outputpath << " 文件夹中" << endl;
+    return 0;
+}
+
+// sweep 子命令的参数
+struct SweepArgs {
+    string reffile;      // 参考轨迹文件
+    string metric;       // 排序指标：pos 或 nis，为空时有参考轨迹则用 pos
+    string outfile;      // 全部结果的CSV文件
+    size_t samples = 0;  // 随机抽样组数，0表示网格扫描
+    uint64_t seed  = 1;  // 随机抽样的种子
+    int threads    = 0;  // 线程数，0表示使用全部CPU核心
+    size_t top     = 10; // 输出前几名
+    double skip    = 0;  // 不统计位置误差的开始时长（s）
+    string factors[7];   // 各噪声参数的倍数，逗号分隔，顺序为 arw、vrw、gbstd、abstd、gsstd、asstd、corrtime
+};
+
+/// 解析逗号分隔的正数列表，为空时返回 {1}
+static bool parseFactors(const string &text, const char *name, vector<double> &factors) {
+    factors.clear();
+    for (absl::string_view item : absl::StrSplit(text, ',', absl::SkipWhitespace())) {
+        double value;
+        if (!absl::SimpleAtod(item, &value) || !(value > 0)) {
+            cerr << "--" << name << " 的倍数必须是逗号分隔的正数：" << text << endl;
+            return false;
+        }
+        factors.push_back(value);
+    }
+    if (factors.empty()) {
+        factors.push_back(1.0);
+    }
+    return true;
+}
+
+/**
+ * @brief IMU噪声参数扫描：数据只读入一次，按网格或随机抽样的各组噪声参数并行解算，按位置误差或NIS排序输出
+ *
+ * 噪声参数为配置文件中的值乘以倍数。有参考轨迹（如 tools simulate 输出的 result_truth.txt 或RTK/后处理的
+ * 参考解）时默认按位置误差RMS排序，否则按平均每维NIS与1的对数距离排序
+ * @param configfile 配置文件路径
+ * @param args 扫描参数
+ */
+int sweepNoise(const string &configfile, const SweepArgs &args) {
+    GINSOptions options;
+    if (!FileIO::loadOptions(configfile, options)) {
+        return -1;
+    }
+    const char *names[7] = {"arw", "vrw", "gbstd", "abstd", "gsstd", "asstd", "corrtime"};
+    SweepSpace space;
+    vector<double> *fields[7] = {&space.arw,   &space.vrw,   &space.gbstd,   &space.abstd,
+                                 &space.gsstd, &space.asstd, &space.corrtime};
+    for (int k = 0; k < 7; k++) {
+        if (!parseFactors(args.factors[k], names[k], *fields[k])) {
+            return -1;
+        }
+    }
+    string metric = args.metric.empty() ? (args.reffile.empty() ? "nis" : "pos") : args.metric;
+    if (metric != "pos" && metric != "nis") {
+        cerr << "排序指标只能是 pos 或 nis：" << metric << endl;
+        return -1;
+    }
+    if (metric == "pos" && args.reffile.empty()) {
+        cerr << "按位置误差排序需要用 -r 指定参考轨迹文件！" << endl;
+        return -1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    NoiseSweep sweep(options, args.reffile, args.skip);
+    if (!sweep.isOpen()) {
+        return -1;
+    }
+    vector<ImuNoise> configs = args.samples > 0
+                                   ? NoiseSweep::sample(options.imunoise, space, args.samples, args.seed)
+                                   : NoiseSweep::grid(options.imunoise, space);
+    auto loaded = chrono::steady_clock::now();
+
+    ThreadPool pool(args.threads);
+    vector<SweepResult> results = sweep.run(configs, pool);
+    auto done                   = chrono::steady_clock::now();
+
+    // NaN（没有与参考轨迹重叠的历元或没有量测更新）排在最后
+    auto score = [&](const SweepResult &res) {
+        double value = metric == "pos" ? res.pos_rms : abs(log(res.nis));
+        return isnan(value) ? numeric_limits<double>::infinity() : value;
+    };
+    stable_sort(results.begin(), results.end(),
+                [&](const SweepResult &a, const SweepResult &b) { return score(a) < score(b); });
+
+    // 按配置文件的单位输出第一个轴的参数
+    auto row = [](const SweepResult &res) {
+        const ImuNoise &n = res.imunoise;
+        return absl::StrFormat("%.4f,%.4f,%.4f,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g", res.pos_rms, res.pos_max,
+                               res.nis, n.gyr_arw[0] * R2D * 60.0, n.acc_vrw[0] * 60.0,
+                               n.gyrbias_std[0] * R2D * 3600.0, n.accbias_std[0] / 1E-5, n.gyrscale_std[0] / 1E-6,
+                               n.accscale_std[0] / 1E-6, n.corr_time / 3600.0);
+    };
+    const char *header = "pos_rms,pos_max,nis,arw,vrw,gbstd,abstd,gsstd,asstd,corrtime";
+
+    double loadtime = chrono::duration<double>(loaded - start).count();
+    double runtime  = chrono::duration<double>(done - loaded).count();
+    cout << "读入 " << sweep.size() << " 个IMU历元用时 " << loadtime << " s，" << configs.size() << " 组参数解算用时 "
+         << runtime << " s（" << pool.size() << " 个线程，" << configs.size() * sweep.size() / runtime << " 历元/s）"
+         << endl;
+    cout << "按 " << metric << " 排序的前 " << min(args.top, results.size()) << " 组参数（单位与配置文件相同）：" << endl;
+    cout << "rank," << header << endl;
+    for (size_t i = 0; i < min(args.top, results.size()); i++) {
+        cout << i + 1 << "," << row(results[i]) << endl;
+    }
+
+    if (!args.outfile.empty()) {
+        ofstream ofs(args.outfile);
+        ofs << "rank," << header << "\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            ofs << i + 1 << "," << row(results[i]) << "\n";
+        }
+        ofs.close();
+        if (!ofs) {
+            cerr << "扫描结果文件：" << args.outfile << " 写入失败！" << endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// replay 子命令的参数
+struct ReplayOptions {
+    double rate      = 1.0; // 回放倍速，0表示尽快发送
+    double jitter    = 0.0; // 每帧随机推迟 [0, jitter] ms
+    double drop      = 0.0; // IMU数据帧的丢弃概率
+    double gnss_drop = 0.0; // GNSS数据帧的丢弃概率
+    uint64_t seed    = 1;   // 随机数种子，相同种子的抖动和丢帧序列相同
+    double start     = 0.0; // 回放时段的开始时刻（周内秒），为0时从数据开始
+    double end       = 0.0; // 回放时段的结束时刻（周内秒），为0时到数据结束
+};
+
+/// 休眠到 CLOCK_MONOTONIC 的 ns 时刻
+static void sleepUntil(uint64_t ns) {
+    timespec ts;
+    ts.tv_sec  = static_cast<time_t>(ns / 1000000000ULL);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+/**
+ * @brief 按GPS时间回放IMU和GNSS数据，作为实时模式（GINS -r）的数据源
+ *
+ * IMU和GNSS数据按时间顺序归并，GNSS数据在同一时刻的IMU历元之前发送。指定回放时段时二分查找定位到开始时刻，
+ * 不解析之前的数据。输出为套接字时，另起线程接收确认帧，
+ * 统计每个IMU历元从发出到接收方处理完成的延迟；统计信息输出到标准错误
+ *
+ * @param imufile IMU ASC格式数据文件
+ * @param gnssfile GNSS pos格式数据文件
+ * @param dest 输出目标，见 FrameIO::openSink
+ */
+int replayData(const string &imufile, const string &gnssfile, const string &dest, const ReplayOptions &opts) {
+    IMUStream imu_stream;
+    GNSSStream gnss_stream;
+    if (!imu_stream.open(imufile)) {
+        cerr << "IMU数据文件读取失败！" << endl;
+        return -1;
+    }
+    if (!gnss_stream.open(gnssfile)) {
+        cerr << "GNSS定位结果pos数据文件读取失败！" << endl;
+        return -1;
+    }
+    MergedStream merged(imu_stream, gnss_stream);
+    if (opts.start > 0 && !merged.seek(opts.start)) {
+        cerr << "回放开始时刻之后没有数据！" << endl;
+        return -1;
+    }
+    if (opts.end > 0) {
+        merged.setEnd(opts.end);
+    }
+    signal(SIGPIPE, SIG_IGN);
+    int fd = FrameIO::openSink(dest);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // 接收确认帧
+    bool ack = FrameIO::isSocket(fd);
+    LatencyHistogram latency;
+    atomic<uint64_t> last_ack{0};
+    thread receiver;
+    if (ack) {
+        receiver = thread([fd, &latency, &last_ack]() {
+            DataFrame frame;
+            while (FrameIO::readFrame(fd, frame)) {
+                if (frame.type == FrameIO::FRAME_ACK) {
+                    uint64_t now = FrameIO::now();
+                    latency.record(now - frame.stamp);
+                    last_ack.store(now, memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    mt19937_64 rng(opts.seed);
+    uniform_real_distribution<double> jitter(0.0, opts.jitter * 1E6);
+    bernoulli_distribution drop(opts.drop), gnss_drop(opts.gnss_drop);
+
+    size_t imu_sent = 0, imu_dropped = 0, gnss_sent = 0, gnss_dropped = 0;
+    DataEvent event;
+    bool ok        = true;
+    double t0      = 0;
+    uint64_t start = 0;
+    while (ok && merged.next(event)) {
+        bool is_imu = event.type == DataEvent::IMU_EVENT;
+        double time = is_imu ? event.imu.time : event.gnss.time;
+        if (start == 0) {
+            t0    = time;
+            start = FrameIO::now();
+        }
+        if (!is_imu) {
+            // GNSS数据按其时刻发送，不加抖动
+            if (opts.rate > 0) {
+                sleepUntil(start + static_cast<uint64_t>((time - t0) / opts.rate * 1E9));
+            }
+            if (gnss_drop(rng)) {
+                gnss_dropped++;
+            } else {
+                ok = FrameIO::writeFrame(fd, FrameIO::toFrame(event.gnss, FrameIO::now()));
+                gnss_sent++;
+            }
+            continue;
+        }
+        if (opts.rate > 0) {
+            sleepUntil(start + static_cast<uint64_t>((time - t0) / opts.rate * 1E9 + jitter(rng)));
+        }
+        if (drop(rng)) {
+            imu_dropped++;
+            continue;
+        }
+        ok = FrameIO::writeFrame(fd, FrameIO::toFrame(event.imu, FrameIO::now()));
+        imu_sent++;
+    }
+    uint64_t sent = FrameIO::now();
+
+    DataFrame end;
+    memset(&end, 0, sizeof(end));
+    end.magic = FrameIO::MAGIC;
+    end.type  = FrameIO::FRAME_END;
+    FrameIO::writeFrame(fd, end);
+    if (ack) {
+        // 等接收方处理完剩余数据并关闭连接
+        shutdown(fd, SHUT_WR);
+        receiver.join();
+    }
+    if (fd != STDOUT_FILENO) {
+        close(fd);
+    }
+    if (!ok) {
+        cerr << "接收方已关闭，回放提前结束！" << endl;
+    }
+
+    double elapsed = (sent - start) / 1E9;
+    cerr << "发送IMU数据 " << imu_sent << " 帧（丢弃 " << imu_dropped << "），GNSS数据 " << gnss_sent << " 帧（丢弃 "
+         << gnss_dropped << "），耗时 " << elapsed << " s，发送速率 " << (imu_sent + gnss_sent) / elapsed << " 帧/s"
+         << endl;
+    if (latency.count() > 0) {
+        double acked = (last_ack.load() - start) / 1E9;
+        cerr << "接收方处理 " << latency.count() << " 个IMU历元，耗时 " << acked << " s，吞吐量 "
+             << latency.count() / acked << " 历元/s" << endl;
+        latency.report(cerr, "发出到确认的延迟");
+    }
+    return ok ? 0 : -1;
+}
+
 int main(int argc, char *argv[]) {
-    CLI::App app{"本程序提供静态解析粗对准和Allan方差分析功能，使用方法如下：\n"};
+    CLI::App app{"本程序提供静态解析粗对准、Allan方差分析、数据格式转换、轨迹文件转换、数据回放、数据仿真和噪声参数扫描功能，使用方法如下：\n"};
     // initAtt 子命令
     auto initAtt_cmd = app.add_subcommand("init", "静态解析粗对准功能");
     string imufile;
-    int start_idx{0}, end_idx{30000};
+    double init_start{0}, init_duration{300.0};
     double phi = 30.528297320436;
     initAtt_cmd->add_option("imufile", imufile, "IMU ASC格式数据文件路径")->required();
-    initAtt_cmd->add_option("-s,--start", start_idx, "指定开始历元索引")->default_val(0);
-    initAtt_cmd->add_option("-e,--end", end_idx, "指定结束历元索引")->default_val(30000);
-    initAtt_cmd->add_option("-p,--phi", phi, "指定IMU静止时所在的纬度值（deg）")->default_val(30.528297320436);
+    StaticOptions init_static;
+    int init_threads{0};
+    initAtt_cmd->add_option("-s,--start", init_start, "对准时段的开始时刻（周内秒），0表示自动检测所有静止时段")
+        ->default_val(0.0);
+    initAtt_cmd->add_option("-t,--duration", init_duration, "指定开始时刻时对准时段的时长（s）")->default_val(300.0);
+    // 解析粗对准与纬度无关，-p 不再起作用，只为兼容旧的命令行而保留，不在帮助中列出
+    initAtt_cmd->add_option("-p,--phi", phi, "IMU静止时所在的纬度值（deg），不影响对准结果")->group("");
+    initAtt_cmd->add_option("-w,--window", init_static.window, "静止检测的滑动窗口时长（s）")->default_val(1.0);
+    initAtt_cmd->add_option("-m,--min-time", init_static.mintime, "静止时段的最短时长（s）")->default_val(10.0);
+    initAtt_cmd->add_option("--gyr-std", init_static.gyrstd, "角速度模长标准差的上限（rad/s）")->default_val(0.005);
+    initAtt_cmd->add_option("--acc-std", init_static.accstd, "比力模长标准差的上限（m/s^2）")->default_val(0.2);
+    initAtt_cmd->add_option("-j,--threads", init_threads, "粗对准线程数，0表示使用全部CPU核心")->default_val(0);
+    ImuFormat init_format;
+    initAtt_cmd->add_option("-f,--rate", init_format.freq, "IMU采样率（Hz）")->default_val(init_format.freq);
+    initAtt_cmd->add_option("--acc-scale", init_format.acc_scale, "速度增量的转换因子，同配置文件的 accscale")
+        ->default_val(init_format.acc_scale);
+    initAtt_cmd->add_option("--gyr-scale", init_format.gry_scale, "角度增量的转换因子，同配置文件的 gyrscale")
+        ->default_val(init_format.gry_scale);
 
     auto initAllan_cmd = app.add_subcommand("allan", "Allan方差分析功能");
     string outfile;
     initAllan_cmd->add_option("imufile", imufile, "IMU ASC格式数据文件路径")->required();
     initAllan_cmd->add_option("outfile", outfile, "输出文件名(要求txt格式)")->required();
+    bool overlapping = false;
+    int points_per_decade{0};
+    initAllan_cmd->add_flag("-o,--overlap", overlapping, "使用完全重叠Allan方差估计");
+    initAllan_cmd->add_option("-l,--log", points_per_decade, "按对数等间隔选取相关时间，指定每十倍程的点数")
+        ->default_val(0);
+    int threads{0};
+    initAllan_cmd->add_option("-j,--threads", threads, "解析和计算线程数，0表示使用全部CPU核心")->default_val(0);
+
+    auto convert_cmd = app.add_subcommand("convert", "将ASC/pos数据文件转换为二进制缓存，加快之后的读取");
+    vector<string> srcfiles;
+    convert_cmd->add_option("srcfiles", srcfiles, "IMU ASC格式或GNSS pos格式数据文件路径")->required();
+
+    auto traj_cmd = app.add_subcommand("traj2txt", "将二进制轨迹文件转换为文本结果文件");
+    string trajfile, outputpath;
+    double start{-1E300}, end{1E300};
+    traj_cmd->add_option("trajfile", trajfile, "二进制轨迹文件路径（result.traj）")->required();
+    traj_cmd->add_option("-o,--output", outputpath, "输出目录，默认与轨迹文件相同");
+    traj_cmd->add_option("-s,--start", start, "开始时刻（周内秒）");
+    traj_cmd->add_option("-e,--end", end, "结束时刻（周内秒），不含");
+
+    auto replay_cmd = app.add_subcommand("replay", "按GPS时间回放IMU和GNSS数据，作为实时模式（GINS -r）的数据源");
+    string gnssfile, dest;
+    ReplayOptions replay;
+    replay_cmd->add_option("imufile", imufile, "IMU ASC格式数据文件路径")->required();
+    replay_cmd->add_option("gnssfile", gnssfile, "GNSS pos格式数据文件路径")->required();
+    replay_cmd->add_option("dest", dest, "输出目标：-（标准输出）、管道路径或 unix:套接字路径")->required();
+    replay_cmd->add_option("-r,--rate", replay.rate, "回放倍速，0表示尽快发送")->default_val(1.0);
+    replay_cmd->add_option("-j,--jitter", replay.jitter, "每帧随机推迟的最大时间（ms）")->default_val(0.0);
+    replay_cmd->add_option("-d,--drop", replay.drop, "IMU数据帧的丢弃概率")->default_val(0.0);
+    replay_cmd->add_option("-g,--gnss-drop", replay.gnss_drop, "GNSS数据帧的丢弃概率")->default_val(0.0);
+    replay_cmd->add_option("--seed", replay.seed, "抖动和丢帧的随机数种子")->default_val(1);
+    replay_cmd->add_option("-s,--start", replay.start, "回放时段的开始时刻（周内秒），0表示从数据开始")->default_val(0.0);
+    replay_cmd->add_option("-e,--end", replay.end, "回放时段的结束时刻（周内秒），0表示到数据结束")->default_val(0.0);
+
+    auto simulate_cmd = app.add_subcommand("simulate", "生成确定性的IMU/GNSS仿真数据和真值，可以直接用同一个配置文件处理");
+    string configfile;
+    SimOptions sim;
+    bool nonoise = false;
+    simulate_cmd->add_option("configfile", configfile, "配置文件路径，仿真数据写入其中的 imupath、gnsspath")->required();
+    simulate_cmd->add_option("-t,--duration", sim.duration, "仿真时长（s）")->default_val(600.0);
+    simulate_cmd->add_option("-f,--rate", sim.imurate, "IMU采样率（Hz）")->default_val(100);
+    simulate_cmd->add_option("-g,--gnss-interval", sim.gnssinterval, "GNSS采样间隔（s），0表示不生成")->default_val(1.0);
+    simulate_cmd->add_option("-s,--static", sim.statictime, "开始运动前的静止时长（s）")->default_val(60.0);
+    simulate_cmd->add_option("-v,--speed", sim.speed, "巡航速度（m/s）")->default_val(10.0);
+    simulate_cmd->add_option("--seed", sim.seed, "随机数种子")->default_val(1);
+    simulate_cmd->add_flag("--no-noise", nonoise, "不加入IMU和GNSS误差，只保留ASC文件的量化误差");
+
+    auto sweep_cmd = app.add_subcommand("sweep", "IMU噪声参数扫描：数据只读入一次，多组噪声参数并行解算并排序");
+    SweepArgs sweep;
+    sweep_cmd->add_option("configfile", configfile, "配置文件路径，噪声参数为扫描的基准值")->required();
+    sweep_cmd->add_option("-r,--reference", sweep.reffile, "参考轨迹文件（result.txt 格式），用于计算位置误差");
+    sweep_cmd->add_option("-m,--metric", sweep.metric, "排序指标：pos（位置误差RMS）或 nis（平均每维NIS接近1）");
+    const char *sweep_names[7] = {"arw", "vrw", "gbstd", "abstd", "gsstd", "asstd", "corrtime"};
+    for (int k = 0; k < 7; k++) {
+        sweep_cmd->add_option(string("--") + sweep_names[k], sweep.factors[k],
+                              string(sweep_names[k]) + " 的倍数，逗号分隔，默认为1");
+    }
+    sweep_cmd->add_option("-n,--samples", sweep.samples, "在各倍数的最小值、最大值之间对数均匀随机抽样的组数，0表示网格扫描")
+        ->default_val(0);
+    sweep_cmd->add_option("--seed", sweep.seed, "随机抽样的种子")->default_val(1);
+    sweep_cmd->add_option("-j,--threads", sweep.threads, "解算线程数，0表示使用全部CPU核心")->default_val(0);
+    sweep_cmd->add_option("--top", sweep.top, "输出排名前几的参数")->default_val(10);
+    sweep_cmd->add_option("-s,--skip", sweep.skip, "开始后不统计位置误差的时长（s）")->default_val(0.0);
+    sweep_cmd->add_option("-o,--output", sweep.outfile, "把全部结果按排名写入CSV文件");
+
+    string profile_json;
+    bool profile = false;
+    app.add_flag("--profile", profile, "结束时在标准错误输出各阶段的耗时统计");
+    app.add_option("--profile-json", profile_json, "把各阶段的耗时统计和直方图写入JSON文件");
 
     CLI11_PARSE(app, argc, argv);
+    Profiler::setEnabled(profile || !profile_json.empty());
 
+    int ret = 0;
     if (initAtt_cmd->parsed()) {
-        // cout << "imufile: " << imufile << "\nstart_idx: " << start_idx << "\nend_idx: " << end_idx << "\nphi: " <<
-        // phi<< endl;
-        initAtt(imufile, start_idx, end_idx, phi);
+        if (init_format.freq <= 0 || init_format.acc_scale <= 0 || init_format.gry_scale <= 0) {
+            cerr << "IMU采样率和转换因子必须为正数！" << endl;
+            ret = -1;
+        } else if (init_start > 0) {
+            initAtt(imufile, init_start, init_duration, init_format);
+        } else {
+            ret = initAttAuto(imufile, init_static, init_threads, init_format);
+        }
     } else if (initAllan_cmd->parsed()) {
-        initAllan(imufile, outfile);
+        initAllan(imufile, outfile, overlapping, points_per_decade, threads);
+    } else if (convert_cmd->parsed()) {
+        ret = convertData(srcfiles);
+    } else if (traj_cmd->parsed()) {
+        ret = convertTrajectory(trajfile, outputpath, start, end);
+    } else if (replay_cmd->parsed()) {
+        ret = replayData(imufile, gnssfile, dest, replay);
+    } else if (simulate_cmd->parsed()) {
+        sim.noise = !nonoise;
+        ret       = simulateData(configfile, sim);
+    } else if (sweep_cmd->parsed()) {
+        ret = sweepNoise(configfile, sweep);
     } else {
         cout << app.help() << endl;
     }
-    return 0;
-}
\ No newline at end of file
+    if (profile) {
+        Profiler::report(cerr);
+    }
+    if (!profile_json.empty()) {
+        Profiler::writeJson(profile_json);
+    }
+    return ret;
+}
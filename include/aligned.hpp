@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 按指定字节数对齐的内存分配器，用于批量数值计算时让数组首地址对齐到缓存行/SIMD寄存器宽度
+ *
+ * @tparam T 元素类型
+ * @tparam Alignment 对齐字节数，默认64字节（缓存行、AVX-512寄存器宽度）
+ */
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {
+    }
+
+    T *allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void *ptr    = aligned_alloc(Alignment, bytes);
+        if (ptr == nullptr) {
+            throw bad_alloc();
+        }
+        return static_cast<T *>(ptr);
+    }
+
+    void deallocate(T *ptr, size_t) {
+        free(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+        return false;
+    }
+};
+
+/// 首地址按64字节对齐的 vector
+template <typename T>
+using AlignedVector = vector<T, AlignedAllocator<T>>;
@@ -0,0 +1,129 @@
+#pragma once
+#include "aligned.hpp"
+#include "threadpool.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 基于累积和的Allan方差分析引擎
+ *
+ * 构造时一次性计算六个轴（加速度计xyz、陀螺仪xyz）的累积和，之后任意簇长度下每个簇的均值
+ * 都只需一次减法，整条Allan曲线的计算量与数据长度呈线性关系，不再随簇长度的个数成倍增长。
+ * 累积前先减去各轴的整体均值，以减小长时间累加的舍入误差，Allan方差与常值偏移无关。
+ *
+ * 累积和按样本存储为宽度为 LANES 的块（六个轴补齐到8个），同一样本的所有轴在内存中连续，
+ * 六个轴的累加在内层定长循环中一次完成，便于编译器生成SIMD指令。
+ * 一组簇长度可以通过线程池并行计算。
+ */
+class AllanVariance {
+public:
+    static constexpr int AXES  = 6; // 加速度计xyz + 陀螺仪xyz
+    static constexpr int LANES = 8; // 每个样本的存储宽度，补齐到8个double（64字节）
+
+    /// 六个轴的结果，顺序与 allanAnalysis 的输出一致：加速度计xyz、陀螺仪xyz
+    using AxisValues = array<double, AXES>;
+
+    /**
+     * @brief 构建累积和
+     *
+     * @param imudata 存储所有的IMU测量值
+     * @param start_idx 用于Allan方差分析的历元起始索引
+     * @param end_idx 用于Allan方差分析的历元结束索引（不含）
+     */
+    AllanVariance(const vector<IMU> &imudata, size_t start_idx, size_t end_idx);
+
+    /// 参与分析的样本数
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * @brief 计算从第 first 个样本开始、长度为 m 的簇的均值（已减去整体均值）
+     *
+     * @param first 簇的起始样本（相对于 start_idx）
+     * @param m 簇长度
+     */
+    AxisValues clusterMean(size_t first, size_t m) const;
+
+    /**
+     * @brief 计算簇长度为 m 时的Allan标准差
+     *
+     * @param m 簇长度（样本数），对应的相关时间 τ = m / freq
+     * @param overlapping 是否使用完全重叠估计（簇起点逐样本滑动），置信度更高但计算量为 O(N)，
+     *                    非重叠估计为 O(N/m)
+     * @return AxisValues 各轴的Allan标准差，样本数不足时为 NaN
+     */
+    AxisValues deviation(size_t m, bool overlapping = false) const;
+
+    /**
+     * @brief 批量计算一组簇长度下的Allan标准差，各簇长度分配给线程池并行计算
+     *
+     * @param clusters 簇长度
+     * @param overlapping 是否使用完全重叠估计
+     * @param pool 线程池，为 nullptr 时在当前线程串行计算
+     * @return vector<AxisValues> 与 clusters 一一对应的Allan标准差
+     */
+    vector<AxisValues> deviations(const vector<size_t> &clusters, bool overlapping = false,
+                                  ThreadPool *pool = nullptr) const;
+
+    /**
+     * @brief 按照 allanAnalysis 的方式把数据分成 bins 个簇计算Allan标准差，结果与 allanAnalysis 相同
+     *
+     * allanAnalysis 的第 i 块只累加从 i*m 开始的 i 个样本（不超过 size()-m），再除以簇长度 m，
+     * 这里保持同样的分块方式，tools allan 默认的输出不变；标准的非重叠估计见 deviation
+     *
+     * @param bins 分块数
+     */
+    AxisValues deviationByBins(int bins) const;
+
+    /**
+     * @brief 批量计算一组分块数下的非重叠Allan标准差，各分块数分配给线程池并行计算
+     *
+     * @param bins 分块数
+     * @param pool 线程池，为 nullptr 时在当前线程串行计算
+     */
+    vector<AxisValues> deviationsByBins(const vector<int> &bins, ThreadPool *pool = nullptr) const;
+
+    /**
+     * @brief 在 [1, max_m] 内按对数等间隔选取簇长度，去除取整后重复的值
+     *
+     * @param max_m 最大簇长度，重叠估计通常取 N/2，非重叠估计通常取 N/9（至少9个簇）
+     * @param points_per_decade 每十倍程的点数
+     */
+    static vector<size_t> logSpacedClusters(size_t max_m, int points_per_decade = 10);
+
+private:
+    /**
+     * @brief 累加 terms 个相邻簇均值之差的平方，返回Allan标准差
+     *
+     * @param m 簇长度
+     * @param step 相邻两项之间簇起点的间隔，完全重叠估计为1，非重叠估计为 m
+     * @param terms 累加的项数
+     */
+    AxisValues accumulate(size_t m, size_t step, size_t terms) const;
+
+    /// 对 [0, n) 逐个调用 fn 求值；各项计算量差别很大，按交错方式分组，使每个线程的计算量大致相当
+    template <typename F>
+    vector<AxisValues> parallelMap(size_t n, ThreadPool *pool, F &&fn) const {
+        vector<AxisValues> res(n);
+        size_t groups = pool == nullptr ? 1 : min(n, pool->size() * 8);
+        auto work     = [&](size_t g) {
+            for (size_t i = g; i < n; i += groups) {
+                res[i] = fn(i);
+            }
+        };
+        if (groups <= 1) {
+            work(0);
+        } else {
+            pool->parallelFor(groups, work);
+        }
+        return res;
+    }
+
+    size_t size_;
+    double mean_[LANES] = {};      // 累积前减去的各轴均值
+    AlignedVector<double> cumsum_; // 累积和，样本 i 的各轴位于 [i*LANES, i*LANES+AXES)，共 size_+1 个样本
+};
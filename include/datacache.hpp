@@ -0,0 +1,155 @@
+#pragma once
+#include "mmapfile.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief IMU/GNSS数据的二进制缓存文件
+ *
+ * 文件由固定长度的文件头、按列存储的定长数据和稀疏时间索引组成，各部分均按64字节对齐，
+ * 可以直接内存映射后按列访问。IMU数据在写入前已经完成轴系调整，保存未乘转换因子的原始计数，
+ * 读取时按与 FileIO 相同的运算顺序乘以转换因子，结果与解析源文件逐位相同。
+ * 缓存文件与源文件同目录，文件名为源文件名加 ".gcache"，
+ * 只有当缓存比源文件新、且转换因子和采样频率与读取时使用的一致时才会被使用。
+ */
+class DataCache {
+public:
+    static constexpr uint32_t VERSION      = 2;    // 缓存格式版本，格式变化时递增
+    static constexpr uint32_t INDEX_STRIDE = 4096; // 时间索引的采样间隔（记录数）
+
+    enum Type : uint32_t {
+        IMU_DATA  = 1,
+        GNSS_DATA = 2,
+    };
+
+    /// 文件头，所有偏移量均相对于文件起始位置
+    struct Header {
+        char magic[8];              // 固定为 "GINSCACH"
+        uint32_t version;           // 缓存格式版本
+        uint32_t type;              // 数据类型
+        uint64_t count;             // 记录数
+        double acc_scale;           // 生成缓存时使用的加速度计转换因子
+        double gry_scale;           // 生成缓存时使用的陀螺仪转换因子
+        int32_t freq;               // IMU采样频率
+        uint32_t columns;           // 数据列数
+        uint32_t index_stride;      // 时间索引的采样间隔
+        uint32_t reserved;          // 保留，填0
+        uint64_t index_count;       // 时间索引的条目数
+        uint64_t index_offset;      // 时间索引的偏移
+        uint64_t column_offset[16]; // 各数据列的偏移
+    };
+
+    /// 源文件对应的缓存文件路径
+    static string cachePath(const string &srcfile);
+
+    /**
+     * @brief 将IMU原始计数写入缓存文件
+     *
+     * @param [in] cachefile 缓存文件路径
+     * @param [in] imu_data 已按 FileIO 调整轴系、未乘转换因子的IMU原始计数
+     * @param [in] format 读取缓存时使用的转换因子和采样频率
+     * @return true 写入成功
+     * @return false 写入失败
+     */
+    static bool writeIMU(const string &cachefile, const vector<IMU> &imu_data, const ImuFormat &format = ImuFormat());
+
+    /**
+     * @brief 将GNSS数据写入缓存文件
+     *
+     * @param [in] cachefile 缓存文件路径
+     * @param [in] gnss_data GNSS定位结果
+     * @return true 写入成功
+     * @return false 写入失败
+     */
+    static bool writeGNSS(const string &cachefile, const vector<GNSS> &gnss_data);
+
+    /**
+     * @brief 解析源文件并生成缓存，ASC文件按IMU数据处理，pos文件按GNSS数据处理
+     *
+     * @param [in] srcfile 源文件路径
+     * @param [in] format IMU数据的转换因子和采样频率
+     * @return true 转换成功
+     * @return false 源文件读取失败或缓存写入失败
+     */
+    static bool convert(const string &srcfile, const ImuFormat &format = ImuFormat());
+
+    /**
+     * @brief 打开源文件对应的缓存，要求缓存存在、比源文件新，IMU数据还要求与 format 的转换因子和采样频率一致
+     *
+     * @param [in] srcfile ASC或pos源文件路径
+     * @param [in] type 数据类型
+     * @param [in] format IMU数据的转换因子和采样频率
+     * @return true 缓存可用并已打开
+     * @return false 缓存不可用，调用者应当解析源文件
+     */
+    bool openFresh(const string &srcfile, Type type, const ImuFormat &format = ImuFormat());
+
+    /**
+     * @brief 映射并校验缓存文件
+     *
+     * @param [in] cachefile 缓存文件路径
+     * @param [in] type 期望的数据类型
+     * @return true 打开成功
+     * @return false 文件不存在、格式版本不符或已损坏
+     */
+    bool open(const string &cachefile, Type type);
+
+    /// 记录数
+    size_t size() const {
+        return header_ == nullptr ? 0 : header_->count;
+    }
+
+    /// 生成缓存时的IMU采样频率
+    int freq() const {
+        return header_->freq;
+    }
+
+    /// 第 i 条记录的周内秒
+    double time(size_t i) const {
+        return time_[i];
+    }
+
+    /**
+     * @brief 读取第 i 条IMU记录
+     *
+     * @param [in] i 记录索引
+     * @param [out] imu IMU记录
+     * @param is_imu_increment [defalt: true] 是否按速度增量和角度增量形式输出
+     */
+    void getIMU(size_t i, IMU &imu, bool is_imu_increment = true) const;
+
+    /// 读取第 i 条IMU记录的原始计数，轴系已按 FileIO 调整，未乘转换因子
+    void getCounts(size_t i, IMU &imu) const;
+
+    /// 读取第 i 条GNSS记录
+    void getGNSS(size_t i, GNSS &gnss) const;
+
+    /**
+     * @brief 利用稀疏时间索引二分查找第一条周内秒不小于 time 的记录
+     *
+     * @param [in] time 周内秒
+     * @return size_t 记录索引，所有记录都早于 time 时返回 size()
+     */
+    size_t lowerBound(double time) const;
+
+    /**
+     * @brief 提示内核前 count 条记录已经读完，可以回收对应的物理页，用于顺序读取时保持常驻内存不变
+     *
+     * @param [in] count 已读完的记录数
+     */
+    void releaseBefore(size_t count) const;
+
+private:
+    const double *column(int i) const {
+        return reinterpret_cast<const double *>(file_.data() + header_->column_offset[i]);
+    }
+
+    MmapFile file_;
+    const Header *header_ = nullptr;
+    const int32_t *week_  = nullptr;
+    const double *time_   = nullptr;
+    const double *index_  = nullptr;
+};
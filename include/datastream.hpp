@@ -0,0 +1,247 @@
+#pragma once
+#include "datacache.hpp"
+#include "mmapfile.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <string>
+using namespace std;
+
+/**
+ * @brief 固定容量的环形缓冲区，容量在编译期确定，运行过程中不再分配内存
+ *
+ * @tparam T 元素类型
+ * @tparam N 容量，必须是2的整数次幂
+ */
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer 的容量必须是2的整数次幂");
+
+public:
+    static constexpr size_t capacity() {
+        return N;
+    }
+    size_t size() const {
+        return tail_ - head_;
+    }
+    bool empty() const {
+        return head_ == tail_;
+    }
+    bool full() const {
+        return size() == N;
+    }
+
+    /// 写入队尾，调用前需保证缓冲区未满
+    void push(const T &item) {
+        buf_[tail_++ & (N - 1)] = item;
+    }
+
+    /// 队首元素，调用前需保证缓冲区非空
+    const T &front() const {
+        return buf_[head_ & (N - 1)];
+    }
+
+    /// 弹出队首元素
+    void pop() {
+        head_++;
+    }
+
+    void clear() {
+        head_ = tail_ = 0;
+    }
+
+private:
+    array<T, N> buf_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+};
+
+/**
+ * @brief 按需逐条读取ASC格式IMU数据的数据流
+ *
+ * 文件通过内存映射打开，每次只解析一批记录放入固定容量的环形缓冲区，
+ * 已经消费过的文件页会及时归还给内核，常驻内存与数据时长无关。
+ * 读出的记录与 FileIO::getIMUdata 得到的 vector<IMU> 逐条一致。
+ * 源文件存在可用的二进制缓存时直接顺序读取缓存。
+ */
+class IMUStream {
+public:
+    static constexpr size_t CAPACITY = 512; // 环形缓冲区容量
+
+    /**
+     * @brief 打开IMU数据文件
+     *
+     * @param [in] imufile IMU数据文件路径（ASC格式）
+     * @param is_imu_increment [defalt: true] 是否按速度增量和角度增量形式输出
+     * @param format [defalt: ImuFormat()] 转换因子和采样频率
+     * @return true 打开成功
+     * @return false 打开失败
+     */
+    bool open(const string &imufile, bool is_imu_increment = true, const ImuFormat &format = ImuFormat());
+
+    /**
+     * @brief 读取下一条IMU记录
+     *
+     * @param [out] imu 读取到的IMU记录
+     * @return true 读取成功
+     * @return false 数据已经读完
+     */
+    bool next(IMU &imu);
+
+    /**
+     * @brief 查看下一条IMU记录但不消费
+     *
+     * @return const IMU* 下一条记录，数据读完时返回 nullptr
+     */
+    const IMU *peek();
+
+    /**
+     * @brief 二分查找定位到第一条时刻不早于 time 的记录，再向前退 before 条，之后从该记录开始读取
+     *
+     * 从缓存读取时利用缓存的时间索引，否则在内存映射的文件中二分查找，只访问 O(log n) 个文件页；
+     * 定位后第一条记录的 dt 与顺序读取时相同。可以向前或向后多次定位
+     *
+     * @param time 周内秒
+     * @param before 向前退的记录数，用于取得 time 之前的历元
+     * @return true 定位后还有数据
+     */
+    bool seek(double time, size_t before = 0);
+
+    /// 只读取时刻早于 time 的记录，之后 next 返回 false，用于按时段处理
+    void setEnd(double time) {
+        end_time_ = time;
+    }
+
+private:
+    /// 从文件中继续解析记录，直到缓冲区填满或文件读完
+    void refill();
+
+    MmapFile file_;
+    const char *data_      = nullptr; // 第一条数据记录（确定起始周内秒的记录之后）的位置
+    double first_wsec_     = 0;       // 确定起始周内秒的记录的周内秒
+    double end_time_       = 1E300;   // 结束时刻（不含）
+    const char *cur_       = nullptr; // 下一行待解析数据的位置
+    double wsec_           = 0;       // 上一条记录的周内秒
+    bool is_imu_increment_ = true;
+    ImuFormat format_;
+    size_t released_ = 0; // 已归还给内核的数据量（文件字节数或缓存记录数）
+    RingBuffer<IMU, CAPACITY> buffer_;
+
+    DataCache cache_;          // 源文件的二进制缓存
+    bool from_cache_  = false; // 是否从缓存读取
+    size_t cache_idx_ = 0;     // 下一条待读取的缓存记录
+};
+
+/**
+ * @brief 按需逐条读取pos格式GNSS-RTK定位结果的数据流
+ *
+ * 读出的记录与 FileIO::getGNSSdata 得到的 vector<GNSS> 逐条一致，
+ * 源文件存在可用的二进制缓存时直接顺序读取缓存
+ */
+class GNSSStream {
+public:
+    static constexpr size_t CAPACITY = 64; // 环形缓冲区容量
+
+    /**
+     * @brief 打开GNSS定位结果文件
+     *
+     * @param [in] gnssfile GNSS数据文件路径（pos格式）
+     * @return true 打开成功
+     * @return false 打开失败
+     */
+    bool open(const string &gnssfile);
+
+    /**
+     * @brief 读取下一条GNSS记录
+     *
+     * @param [out] gnss 读取到的GNSS记录
+     * @return true 读取成功
+     * @return false 数据已经读完
+     */
+    bool next(GNSS &gnss);
+
+    /**
+     * @brief 查看下一条GNSS记录但不消费
+     *
+     * @return const GNSS* 下一条记录，数据读完时返回 nullptr
+     */
+    const GNSS *peek();
+
+    /// 定位到第一条时刻不早于 time 的记录，再向前退 before 条，同 IMUStream::seek
+    bool seek(double time, size_t before = 0);
+
+    /// 只读取时刻早于 time 的记录
+    void setEnd(double time) {
+        end_time_ = time;
+    }
+
+private:
+    void refill();
+
+    MmapFile file_;
+    const char *data_  = nullptr;
+    double first_wsec_ = 0;
+    double end_time_   = 1E300;
+    const char *cur_   = nullptr;
+    double wsec_       = 0;
+    RingBuffer<GNSS, CAPACITY> buffer_;
+
+    DataCache cache_;
+    bool from_cache_  = false;
+    size_t cache_idx_ = 0;
+};
+
+/// 按时间顺序合并的一条IMU或GNSS数据
+typedef struct DataEvent {
+    enum Type { IMU_EVENT, GNSS_EVENT } type;
+    IMU imu;   // type 为 IMU_EVENT 时有效
+    GNSS gnss; // type 为 GNSS_EVENT 时有效
+} DataEvent;
+
+/**
+ * @brief 按时间顺序合并IMU和GNSS数据流，时刻不晚于某个IMU历元的GNSS数据排在该IMU历元之前
+ *
+ * 与 GINS 中加入GNSS数据的顺序相同。两个数据流各自只缓冲固定数量的记录，每次只比较两个队首的时刻
+ */
+class MergedStream {
+public:
+    MergedStream(IMUStream &imu_stream, GNSSStream &gnss_stream)
+        : imu_(imu_stream)
+        , gnss_(gnss_stream) {
+    }
+
+    /**
+     * @brief 读取时间上的下一条数据
+     *
+     * @param [out] event 读取到的数据
+     * @return true 读取成功
+     * @return false 两个数据流都已读完
+     */
+    bool next(DataEvent &event) {
+        const IMU *imu   = imu_.peek();
+        const GNSS *gnss = gnss_.peek();
+        if (gnss != nullptr && (imu == nullptr || gnss->time <= imu->time)) {
+            event.type = DataEvent::GNSS_EVENT;
+            return gnss_.next(event.gnss);
+        }
+        event.type = DataEvent::IMU_EVENT;
+        return imu != nullptr && imu_.next(event.imu);
+    }
+
+    /// 两个数据流都定位到第一条时刻不早于 time 的记录
+    bool seek(double time) {
+        bool has_imu  = imu_.seek(time);
+        bool has_gnss = gnss_.seek(time);
+        return has_imu || has_gnss;
+    }
+
+    /// 两个数据流都只读取时刻早于 time 的记录
+    void setEnd(double time) {
+        imu_.setEnd(time);
+        gnss_.setEnd(time);
+    }
+
+private:
+    IMUStream &imu_;
+    GNSSStream &gnss_;
+};
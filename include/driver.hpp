@@ -0,0 +1,62 @@
+#pragma once
+#include "gins.hpp"
+#include "smoother.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 松组合的逐历元处理循环，GINS 后处理、RTS平滑、噪声参数扫描、基准测试和单元测试共用
+ *
+ * 处理流程与 GINS 后处理相同：先加入起始IMU历元和数据源中的第一个GNSS历元，之后每个IMU历元
+ * 先做状态预测（GNSS时刻位于两个IMU历元之间时在其中完成量测更新），再依次加入不晚于该历元的
+ * 下一个GNSS数据。速度增量或角度增量为0的IMU历元视为无效数据，跳过不处理。
+ * 数据源和逐历元回调都由调用者提供，数据可以来自文件流或内存
+ */
+class FilterDriver {
+public:
+    /// IMU数据源：取出下一个IMU历元，没有数据时返回 false
+    using ImuSource = function<bool(IMU &)>;
+    /// GNSS数据源：取出下一个GNSS历元，没有数据时返回 false
+    using GnssSource = function<bool(GNSS &)>;
+    /// 每处理完一个IMU历元调用一次，参数为该历元的IMU数据
+    using EpochCallback = function<void(const IMU &)>;
+
+    /**
+     * @brief 用 GIEngine 处理 imu 中的全部数据
+     *
+     * @param engine 滤波器
+     * @param imupre 起始IMU历元，只用于确定第一个历元的时间间隔和增量
+     * @param imu IMU数据源，从起始历元的下一个历元开始
+     * @param gnss GNSS数据源，从第一个用于量测更新的历元开始
+     * @param epoch 逐历元回调，可以为空
+     * @return size_t 处理的IMU历元数
+     */
+    static size_t run(GIEngine &engine, const IMU &imupre, const ImuSource &imu, const GnssSource &gnss,
+                      const EpochCallback &epoch = nullptr);
+
+    /// 用 RTSSmoother 做正向滤波，参数同上，平滑由调用者在之后完成
+    static size_t run(RTSSmoother &smoother, const IMU &imupre, const ImuSource &imu, const GnssSource &gnss,
+                      const EpochCallback &epoch = nullptr);
+
+    /**
+     * @brief 依次取出内存中 [first, last) 的数据
+     *
+     * @param data IMU或GNSS数据，在数据源使用期间必须有效
+     * @param first 第一个数据的索引
+     * @param last 最后一个数据之后的索引，超出数据长度时取到数据结束
+     */
+    template <typename T>
+    static function<bool(T &)> source(const vector<T> &data, size_t first, size_t last = SIZE_MAX) {
+        last = min(last, data.size());
+        return [&data, first, last](T &item) mutable {
+            if (first >= last) {
+                return false;
+            }
+            item = data[first++];
+            return true;
+        };
+    }
+};
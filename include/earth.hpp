@@ -6,24 +6,92 @@ using Eigen::Quaterniond;
 using Eigen::Vector2d;
 using Eigen::Vector3d;
 
-/* WGS84椭球模型参数
-   NOTE:如果使用其他椭球模型需要修改椭球参数 */
-const double WGS84_WIE = 7.2921151467E-5;       /// 地球自转角速度
-const double WGS84_F   = 0.0033528106647474805; /// 扁率
-const double WGS84_RA  = 6378137.0000000000;    /// 长半轴a
-const double WGS84_RB  = 6356752.3142451793;    /// 短半轴b
-const double WGS84_GM0 = 398600441800000.00;    /// 地球引力常数
-const double WGS84_E1  = 0.0066943799901413156; /// 第一偏心率平方
-const double WGS84_E2  = 0.0067394967422764341; /// 第二偏心率平方
-
-class Earth {
+/**
+ * 椭球模型参数，作为 EarthModel 的模板参数在编译期选定，切换椭球没有运行时开销。
+ * 正常重力按 g = G0*(1 + G1*sin²B + G2*sin⁴B) + h*(GH1*sin²B - GH0) + GH2*h² 计算
+ */
+struct WGS84 {
+    static constexpr double WIE = 7.2921151467E-5;       /// 地球自转角速度
+    static constexpr double F   = 0.0033528106647474805; /// 扁率
+    static constexpr double RA  = 6378137.0000000000;    /// 长半轴a
+    static constexpr double RB  = 6356752.3142451793;    /// 短半轴b
+    static constexpr double GM0 = 398600441800000.00;    /// 地球引力常数
+    static constexpr double E1  = 0.0066943799901413156; /// 第一偏心率平方
+    static constexpr double E2  = 0.0067394967422764341; /// 第二偏心率平方
+
+    // 正常重力公式系数，沿用原有的值（即GRS80的级数展开），与WGS84正常重力的差异小于2E-6 m/s^2
+    static constexpr double G0  = 9.7803267715;
+    static constexpr double G1  = 0.0052790414;
+    static constexpr double G2  = 0.0000232718;
+    static constexpr double GH0 = 0.0000030876910891;
+    static constexpr double GH1 = 0.0000000043977311;
+    static constexpr double GH2 = 0.0000000000007211;
+};
+
+/// CGCS2000椭球，几何参数与GRS80相同，引力常数与WGS84相同
+struct CGCS2000 {
+    static constexpr double WIE = 7.292115E-5;
+    static constexpr double F   = 0.0033528106811823190;
+    static constexpr double RA  = 6378137.0000000000;
+    static constexpr double RB  = 6356752.3141403561;
+    static constexpr double GM0 = 398600441800000.00;
+    static constexpr double E1  = 0.0066943800229007876;
+    static constexpr double E2  = 0.0067394967754789573;
+
+    // 赤道正常重力 9.7803253361，纬度项由CGCS2000的正常重力公式展开；高程项与GRS80的差异小于1E-14，取相同的值
+    static constexpr double G0  = 9.7803253361;
+    static constexpr double G1  = 0.0052790426;
+    static constexpr double G2  = 0.0000232718;
+    static constexpr double GH0 = 0.0000030876906375;
+    static constexpr double GH1 = 0.0000000043977311;
+    static constexpr double GH2 = 0.0000000000007211;
+};
+
+/// GRS80椭球
+struct GRS80 {
+    static constexpr double WIE = 7.292115E-5;
+    static constexpr double F   = 0.0033528106811823190;
+    static constexpr double RA  = 6378137.0000000000;
+    static constexpr double RB  = 6356752.3141403561;
+    static constexpr double GM0 = 398600500000000.00;
+    static constexpr double E1  = 0.0066943800229007876;
+    static constexpr double E2  = 0.0067394967754789573;
+
+    static constexpr double G0  = 9.7803267715;
+    static constexpr double G1  = 0.0052790414;
+    static constexpr double G2  = 0.0000232718;
+    static constexpr double GH0 = 0.0000030876910891;
+    static constexpr double GH1 = 0.0000000043977311;
+    static constexpr double GH2 = 0.0000000000007211;
+};
+
+/// 机械编排中同一历元共用的地理参数
+typedef struct EarthTerms {
+    Vector2d rmrn;  // 子午圈半径、卯酉圈半径
+    Vector3d wie_n; // 地球自转角速度投影到n系
+    Vector3d wen_n; // n系相对于e系转动角速度投影到n系
+    double gravity; // 正常重力
+    double sinlat;  // 纬度的正弦
+    double coslat;  // 纬度的余弦
+} EarthTerms;
+
+/**
+ * @brief 地球模型，椭球参数由模板参数给出
+ *
+ * 各函数都是内联的静态函数，椭球参数为编译期常量；程序中使用的椭球由 Earth 的定义选定
+ */
+template <typename Ellipsoid>
+class EarthModel {
 public:
+    static constexpr double WIE = Ellipsoid::WIE; /// 地球自转角速度
+    static constexpr double RA  = Ellipsoid::RA;  /// 长半轴a
+    static constexpr double E1  = Ellipsoid::E1;  /// 第一偏心率平方
+
     /// 正常重力计算
     static double gravity(const Vector3d &blh) {
         double sin2 = sin(blh[0]);
         sin2 *= sin2;
-        return 9.7803267715 * (1 + 0.0052790414 * sin2 + 0.0000232718 * sin2 * sin2) +
-               blh[2] * (0.0000000043977311 * sin2 - 0.0000030876910891) + 0.0000000000007211 * blh[2] * blh[2];
+        return normalGravity(sin2, blh[2]);
     }
 
     /// 计算子午圈半径和卯酉圈半径
@@ -31,14 +99,14 @@ public:
         double tmp, sqrttmp;
         tmp = sin(lat);
         tmp *= tmp;
-        tmp     = 1 - WGS84_E1 * tmp;
+        tmp     = 1 - E1 * tmp;
         sqrttmp = sqrt(tmp);
-        return {WGS84_RA * (1 - WGS84_E1) / (sqrttmp * tmp), WGS84_RA / sqrttmp};
+        return {RA * (1 - E1) / (sqrttmp * tmp), RA / sqrttmp};
     }
 
     /// 计算地球自转角速度向量
     static Vector3d getWie(double lat) {
-        return {WGS84_WIE * std::cos(lat), 0.0, -WGS84_WIE * std::sin(lat)};
+        return {WIE * std::cos(lat), 0.0, -WIE * std::sin(lat)};
     }
 
     /// 计算位移角速度向量
@@ -46,4 +114,58 @@ public:
         Vector2d RmRn = getRmRn(lat);
         return {Ve / (RmRn(1) + h), -Vn / (RmRn(0) + h), -Ve * std::tan(lat) / (RmRn(1) + h)};
     }
+
+    /// 大地坐标（BLH，rad、rad、m）转换为地心地固坐标（XYZ，m）
+    static Vector3d blh2ecef(const Vector3d &blh) {
+        double coslat = std::cos(blh[0]), sinlat = std::sin(blh[0]);
+        double coslon = std::cos(blh[1]), sinlon = std::sin(blh[1]);
+        double rn     = RA / std::sqrt(1 - E1 * sinlat * sinlat);
+        return {(rn + blh[2]) * coslat * coslon, (rn + blh[2]) * coslat * sinlon,
+                (rn * (1 - E1) + blh[2]) * sinlat};
+    }
+
+    /// n系（北东地）到e系的旋转矩阵
+    static Matrix3d cne(const Vector3d &blh) {
+        double coslat = std::cos(blh[0]), sinlat = std::sin(blh[0]);
+        double coslon = std::cos(blh[1]), sinlon = std::sin(blh[1]);
+        Matrix3d dcm;
+        dcm << -sinlat * coslon, -sinlon, -coslat * coslon, //
+            -sinlat * sinlon, coslon, -coslat * sinlon,     //
+            coslat, 0, -sinlat;
+        return dcm;
+    }
+
+    /**
+     * @brief 一次计算某一历元的全部地理参数，纬度的正弦、余弦只计算一次
+     *
+     * @param blh BLH系下的位置
+     * @param vel NED系下的速度
+     */
+    static EarthTerms getTerms(const Vector3d &blh, const Vector3d &vel) {
+        double sinlat  = std::sin(blh[0]);
+        double coslat  = std::cos(blh[0]);
+        double sin2    = sinlat * sinlat;
+        double tmp     = 1 - E1 * sin2;
+        double sqrttmp = std::sqrt(tmp);
+
+        EarthTerms terms;
+        terms.rmrn    = {RA * (1 - E1) / (sqrttmp * tmp), RA / sqrttmp};
+        double rmh    = terms.rmrn(0) + blh[2];
+        double rnh    = terms.rmrn(1) + blh[2];
+        terms.wie_n   = {WIE * coslat, 0.0, -WIE * sinlat};
+        terms.wen_n   = {vel[1] / rnh, -vel[0] / rmh, -vel[1] * sinlat / coslat / rnh};
+        terms.gravity = normalGravity(sin2, blh[2]);
+        terms.sinlat  = sinlat;
+        terms.coslat  = coslat;
+        return terms;
+    }
+
+    /// 由纬度正弦的平方和高程计算正常重力，供已算出纬度正弦的批量计算使用
+    static double normalGravity(double sin2, double h) {
+        return Ellipsoid::G0 * (1 + Ellipsoid::G1 * sin2 + Ellipsoid::G2 * sin2 * sin2) +
+               h * (Ellipsoid::GH1 * sin2 - Ellipsoid::GH0) + Ellipsoid::GH2 * h * h;
+    }
 };
+
+/// 程序使用的地球模型，改用其他椭球时只需修改这里
+using Earth = EarthModel<WGS84>;
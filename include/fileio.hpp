@@ -4,21 +4,66 @@
 #include <vector>
 using namespace std;
 
+// 转换因子和采样频率由 ImuFormat 参数传入，没有可变的全局状态，不同数据集可以在多个线程中同时读取
 struct FileIO {
-    static double acc_scale; // IMU的ASC数据转换为实际测量数据需要乘以转换因子
-    static double gry_scale; // IMU的ASC数据转换为实际测量数据需要乘以转换因子
-    static int freq;         // IMU的测量频率
-    
     /**
      * @brief 读取ASC格式的IMU测量数据
      * 
      * @param [in] imufile IMU数据文件路径
      * @param [in,out] imu_data 存储读取的IMU测量数据 
      * @param is_imu_increment [defalt: true] 是否按速度增量和角度增量形式存储
+     * @param format [defalt: ImuFormat()] 转换因子和采样频率
      * @return true 读取文件成功
      * @return false 读取文件失败
      */
-    static bool getIMUdata(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment=true);
+    static bool getIMUdata(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment=true,
+                           const ImuFormat &format=ImuFormat());
+
+    /**
+     * @brief 通过内存映射读取ASC格式的IMU测量数据，结果与 getIMUdata 完全一致
+     *
+     * 整个文件映射到内存后逐行就地解析，字段用 std::from_chars 转换，不产生逐行的堆内存分配
+     *
+     * @param [in] imufile IMU数据文件路径
+     * @param [in,out] imu_data 存储读取的IMU测量数据
+     * @param is_imu_increment [defalt: true] 是否按速度增量和角度增量形式存储
+     * @param format [defalt: ImuFormat()] 转换因子和采样频率
+     * @return true 读取文件成功
+     * @return false 读取文件失败
+     */
+    static bool getIMUdataMmap(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment=true,
+                               const ImuFormat &format=ImuFormat());
+
+    /**
+     * @brief 多线程分块读取ASC格式的IMU测量数据，结果与 getIMUdata 逐位一致
+     *
+     * 文件按换行符切分为若干块，由线程池并行解析，再按顺序拼接。拼接时重新计算每块第一条记录的 dt，
+     * 并处理跨越块边界的重复历元
+     *
+     * @param [in] imufile IMU数据文件路径
+     * @param [in,out] imu_data 存储读取的IMU测量数据
+     * @param is_imu_increment [defalt: true] 是否按速度增量和角度增量形式存储
+     * @param threads [defalt: 0] 解析线程数，为0时使用硬件并发线程数
+     * @param format [defalt: ImuFormat()] 转换因子和采样频率
+     * @return true 读取文件成功
+     * @return false 读取文件失败
+     */
+    static bool getIMUdataParallel(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment=true,
+                                   int threads=0, const ImuFormat &format=ImuFormat());
+
+    /**
+     * @brief 就地解析一行ASC格式的IMU记录，不计算 dt
+     *
+     * @param [in] first 行首指针
+     * @param [in] last 行尾指针（不含换行符）
+     * @param [out] imu 解析得到的周、周内秒、轴系调整并乘以转换因子后的增量
+     * @param is_imu_increment [defalt: true] 是否按速度增量和角度增量形式存储
+     * @param format [defalt: ImuFormat()] 转换因子和采样频率
+     * @return true 解析成功
+     * @return false 该行字段不完整
+     */
+    static bool parseIMUline(const char *first, const char *last, IMU &imu, bool is_imu_increment=true,
+                             const ImuFormat &format=ImuFormat());
 
     /**
      * @brief 读取pos格式的GNSS-RTK测量结果
@@ -29,4 +74,30 @@ struct FileIO {
      * @return false 读取文件失败
      */
     static bool getGNSSdata(const string &gnssfile, vector<GNSS> &gnss_data);
+
+    /**
+     * @brief 就地解析一行pos格式的GNSS-RTK定位结果
+     *
+     * @param [in] first 行首指针
+     * @param [in] last 行尾指针（不含换行符）
+     * @param [out] gnss 解析得到的GNSS定位结果
+     * @return true 解析成功
+     * @return false 该行字段不完整
+     */
+    static bool parseGNSSline(const char *first, const char *last, GNSS &gnss);
+
+    /**
+     * @brief 读取yaml格式的松组合配置文件，并把各参数转换为国际单位
+     *
+     * 角度随机游走 deg/sqrt(h)、速度随机游走 m/s/sqrt(h)、陀螺零偏 deg/h、加速度计零偏 mGal、
+     * 比例因子 ppm、相关时间 h；初始零偏、比例因子的标准差未配置时取对应的IMU噪声参数；
+     * 可选的 lazycov（默认 false）、stdinterval（s，默认0）控制协方差的延迟传播和标准差输出；
+     * 可选的 accscale、gyrscale、imurate 为IMU数据的转换因子和采样频率，默认取 ImuFormat 的默认值
+     *
+     * @param [in] configfile yaml配置文件路径
+     * @param [out] options 松组合配置参数
+     * @return true 读取成功
+     * @return false 文件不存在或缺少必需的参数
+     */
+    static bool loadOptions(const string &configfile, GINSOptions &options);
 };
\ No newline at end of file
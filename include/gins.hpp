@@ -0,0 +1,281 @@
+#pragma once
+#include "staticdetector.hpp"
+#include "types.hpp"
+#include <Eigen/Dense>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief GNSS/INS 松组合扩展卡尔曼滤波引擎
+ *
+ * 21维误差状态依次为：位置误差（NED，m）、速度误差、姿态误差、陀螺零偏、加速度计零偏、陀螺比例因子、
+ * 加速度计比例因子，IMU误差建模为一阶高斯-马尔可夫过程。状态预测使用 INSMech::insMechFused，
+ * 协方差与各中间矩阵均为固定大小的 Eigen 矩阵，逐历元处理过程中不产生堆内存分配。
+ *
+ * 配置 lazycov 时不在每个IMU历元传播协方差，而是把各历元的状态转移矩阵连乘、系统噪声累加，
+ * 只在量测更新前或调用 getCovariance 时一次性传播，见 flushCovariance。
+ *
+ * 使用方法：先用 addImuData 加入对准时刻的IMU数据，之后每个历元依次调用 addImuData、newImuProcess；
+ * GNSS数据用 addGnssData 提前加入，GNSS时刻落在两个IMU历元之间时，在该时刻内插IMU数据并进行量测更新。
+ * 配置 zupt 时每个历元用 StaticDetector 判断是否静止，静止的历元在递推后进行零速修正
+ */
+class GIEngine {
+public:
+    static constexpr int RANK      = 21; // 误差状态维数
+    static constexpr int NOISERANK = 18; // 系统噪声维数
+
+    using StateMatrix = Eigen::Matrix<double, RANK, RANK>;
+    using StateVector = Eigen::Matrix<double, RANK, 1>;
+
+    // 各误差状态在状态向量中的起始索引
+    enum StateID { P_ID = 0, V_ID = 3, PHI_ID = 6, BG_ID = 9, BA_ID = 12, SG_ID = 15, SA_ID = 18 };
+    // 各系统噪声在噪声向量中的起始索引
+    enum NoiseID { VRW_ID = 0, ARW_ID = 3, BGSTD_ID = 6, BASTD_ID = 9, SGSTD_ID = 12, SASTD_ID = 15 };
+
+    /**
+     * @brief 滤波节点，每次状态预测和每次量测更新各对应一个节点，供RTS平滑使用
+     *
+     * 量测更新节点的状态转移矩阵为单位阵、先验协方差为更新前的协方差，
+     * 这样状态预测和量测更新可以用同一套平滑公式处理
+     */
+    struct Epoch {
+        double time;        // 节点时刻
+        bool output;        // 是否为所在IMU历元记录的最后一个节点，平滑结果按这些节点输出
+        PVA pva;            // 反馈后的导航状态，只维护姿态矩阵
+        ImuError imuerror;  // 反馈后的IMU误差
+        StateMatrix Phi;    // 上一节点到本节点的状态转移矩阵
+        StateMatrix Pminus; // 本节点的先验协方差
+        StateMatrix Pplus;  // 本节点的后验协方差
+        StateVector dx;     // 量测更新估计的误差状态（反馈前），状态预测节点为0
+    };
+
+    /// 量测新息的统计，噪声参数与实际误差相符时 nis 的期望值等于 dims，用于检验滤波器的一致性
+    struct InnovationStats {
+        size_t updates = 0; // 量测更新次数
+        size_t dims    = 0; // 各次量测维数之和
+        double nis     = 0; // 归一化新息平方 v^T S^-1 v 之和
+    };
+
+    /**
+     * @brief 按配置参数初始化状态和协方差
+     *
+     * @param options 松组合配置参数，initstate 的位置、速度需要事先设置好
+     */
+    explicit GIEngine(const GINSOptions &options);
+
+    /**
+     * @brief 加入新的IMU数据，并用当前估计的IMU误差补偿
+     *
+     * @param imu k 时刻IMU数据（增量形式）
+     */
+    void addImuData(const IMU &imu);
+
+    /**
+     * @brief 加入新的GNSS数据，在GNSS时刻所在的IMU历元进行量测更新
+     *
+     * 配置了 gnssinterval 时，距上次量测更新不足该间隔的GNSS数据直接丢弃
+     *
+     * @param gnss GNSS定位结果
+     */
+    void addGnssData(const GNSS &gnss) {
+        if (gnss.time - lastupdate_ < options_.gnssinterval - 1E-6) {
+            return;
+        }
+        gnssdata_ = gnss;
+    }
+
+    /// 用最新加入的IMU数据递推一个历元，期间有GNSS数据时进行量测更新
+    void newImuProcess();
+
+    /// 当前状态对应的时间
+    double timestamp() const {
+        return timestamp_;
+    }
+
+    /// 最近一次 newImuProcess 是否进行了GNSS量测更新
+    bool gnssUpdated() const {
+        return updated_;
+    }
+
+    /// 最近一次 newImuProcess 是否进行了零速修正
+    bool zuptUpdated() const {
+        return zupted_;
+    }
+
+    /// 开始以来的量测新息统计（GNSS和零速修正）
+    const InnovationStats &innovationStats() const {
+        return innovation_;
+    }
+
+    /// 对象之外在堆上占用的内存（字节），即静止检测的窗口
+    size_t heapMemory() const {
+        return detector_.heapMemory();
+    }
+
+    /// 当前导航状态和IMU误差，同时计算欧拉角和四元数
+    NavState getNavState() const;
+
+    /// 当前误差状态的协方差，延迟传播时先把累积的状态转移矩阵作用到协方差上
+    const StateMatrix &getCovariance() const {
+        flushCovariance();
+        return Cov_;
+    }
+
+    /**
+     * @brief 开始（或停止）记录滤波节点，开始记录时先加入一个表示当前状态的节点
+     *
+     * @param epochs 节点的输出位置，为 nullptr 时停止记录
+     */
+    void recordEpochs(vector<Epoch> *epochs);
+
+    /**
+     * @brief 结构化的协方差传播 P = Φ P Φ^T + Q
+     *
+     * Φ 只有导航误差（位置、速度、姿态）行块中的部分块和IMU误差的对角块非零，见 PHI_NONZERO，
+     * IMU误差的对角块为对角阵（一阶高斯-马尔可夫过程）。只做非零3×3块的乘法，
+     * 只计算上三角后对称复制，计算量约为稠密矩阵乘法的五分之一，结果严格对称
+     *
+     * @param [in] Phi 状态转移矩阵，必须具有上述块稀疏结构
+     * @param [in] Q 对称的系统噪声协方差
+     * @param [in,out] P 误差状态协方差
+     */
+    static void propagateCovariance(const StateMatrix &Phi, const StateMatrix &Q, StateMatrix &P);
+
+    /**
+     * @brief 状态转移矩阵连乘 Phiacc = Phi * Phiacc
+     *
+     * Phi 具有 propagateCovariance 要求的块稀疏结构，连乘结果中IMU误差的行块仍然只有对角块非零，
+     * 只需计算导航误差的行块，计算量约为 propagateCovariance 的一半
+     *
+     * @param [in] Phi 当前历元的状态转移矩阵
+     * @param [in,out] Phiacc 累积的状态转移矩阵，IMU误差的行块必须只有对角块非零
+     */
+    static void chainTransition(const StateMatrix &Phi, StateMatrix &Phiacc);
+
+    /**
+     * @brief 用误差状态修正导航状态和IMU误差，与量测更新后的反馈相同
+     *
+     * @param [in,out] pva 导航状态
+     * @param [in,out] imuerror IMU误差
+     * @param [in] dx 误差状态
+     */
+    static void correctState(PVA &pva, ImuError &imuerror, const StateVector &dx);
+
+private:
+    static constexpr int BLOCKS     = RANK / 3; // 3×3块的行（列）数
+    static constexpr int NAV_BLOCKS = 3;        // 导航误差的块数
+
+    // 导航误差各行块中 Φ 的非零列块，以-1结尾
+    static constexpr int PHI_NONZERO[NAV_BLOCKS][6] = {
+        {P_ID / 3, V_ID / 3, -1},                                   // 位置误差
+        {P_ID / 3, V_ID / 3, PHI_ID / 3, BA_ID / 3, SA_ID / 3, -1}, // 速度误差
+        {P_ID / 3, V_ID / 3, PHI_ID / 3, BG_ID / 3, SG_ID / 3, -1}, // 姿态误差
+    };
+
+    /**
+     * @brief 状态预测：机械编排，并用离散化的 Φ、Q 传播协方差
+     *
+     * @param imupre k-1 时刻IMU数据
+     * @param imucur k 时刻IMU数据
+     */
+    void insPropagation(const IMU &imupre, const IMU &imucur);
+
+    /// GNSS位置（和速度）量测更新
+    void gnssUpdate(const GNSS &gnss);
+
+    /**
+     * @brief GNSS量测更新并反馈，需要时记录量测更新节点
+     *
+     * @param gnss GNSS定位结果
+     * @param time 量测更新对应的IMU时刻
+     */
+    void gnssCorrect(const GNSS &gnss, double time);
+
+    /// 零速修正：速度量测为0
+    void zuptUpdate();
+
+    /**
+     * @brief 零速修正并反馈，需要时记录量测更新节点
+     *
+     * @param time 零速修正对应的IMU时刻
+     */
+    void zuptCorrect(double time);
+
+    /**
+     * @brief 延迟传播时把累积的状态转移矩阵和系统噪声作用到协方差上
+     *
+     * 累积区间内 Phi(t) 近似为从 Phiacc 到 I 线性变化，系统噪声的积分
+     * ∑ Phi(t) Q Phi(t)^T ≈ Qsum + (A Qsum + Qsum A^T) / 2 + A Qsum A^T / 3，其中 A = Phiacc - I
+     */
+    void flushCovariance() const;
+
+    /// 以当前状态和后验协方差记录一个节点
+    void recordEpoch(double time, const StateMatrix &Phi, const StateMatrix &Pminus, const StateVector &dx);
+
+    /**
+     * @brief 卡尔曼滤波量测更新，使用 Joseph 形式更新协方差
+     *
+     * @tparam N 量测维数
+     * @param dz 量测新息
+     * @param H 量测矩阵
+     * @param R 量测噪声协方差
+     */
+    template <int N>
+    void measurementUpdate(const Eigen::Matrix<double, N, 1> &dz, const Eigen::Matrix<double, N, RANK> &H,
+                           const Eigen::Matrix<double, N, N> &R);
+
+    /// 把误差状态反馈到导航状态和IMU误差，并清零误差状态
+    void stateFeedback();
+
+    /// 补偿IMU数据的零偏和比例因子误差
+    void imuCompensate(IMU &imu) const;
+
+    /// 协方差对角线出现负值时输出警告
+    void checkCov() const;
+
+    /**
+     * @brief 判断量测更新时刻相对两个IMU历元的位置
+     *
+     * @return int 0：不在区间内；1：靠近 imutime1；2：靠近 imutime2；3：位于两者之间，需要内插
+     */
+    static int isToUpdate(double imutime1, double imutime2, double updatetime);
+
+    /**
+     * @brief 在 timestamp 时刻把 imu2 拆分为两段
+     *
+     * @param [in] imu1 前一历元IMU数据
+     * @param [in,out] imu2 当前历元IMU数据，输出为 timestamp 之后的部分
+     * @param [in] timestamp 内插时刻
+     * @param [out] midimu imu1 到 timestamp 之间的部分
+     */
+    static void imuInterpolate(const IMU &imu1, IMU &imu2, double timestamp, IMU &midimu);
+
+    static constexpr double TIME_ALIGN_ERR = 0.001; // 时间对齐误差，单位s
+
+    GINSOptions options_;
+    double timestamp_;
+    bool updated_      = false;  // 最近一个历元是否进行了量测更新
+    bool zupted_       = false;  // 最近一个历元是否进行了零速修正
+    double lastupdate_ = -1E300; // 上次GNSS量测更新的GNSS时刻
+
+    IMU imupre_; // k-1 时刻IMU数据（已补偿）
+    IMU imucur_; // k 时刻IMU数据（已补偿）
+    GNSS gnssdata_;
+
+    PVA pvapre_; // 与 INSMech 的约定相同：递推前为 k-2 时刻，递推后为 k-1 时刻
+    PVA pvacur_; // 递推前为 k-1 时刻，递推后为 k 时刻
+    ImuError imuerror_;
+
+    mutable StateMatrix Cov_;                // 误差状态协方差
+    Eigen::Matrix<double, NOISERANK, 1> qc_; // 连续时间系统噪声谱密度（对角线）
+    StateVector dx_;                         // 误差状态
+
+    // 延迟传播的累积量，作用到协方差上不改变滤波器逻辑上的状态，getCovariance 可以是 const
+    mutable StateMatrix Phiacc_;   // 上次传播协方差以来累积的状态转移矩阵
+    mutable StateMatrix Qsum_;     // 累积的系统噪声
+    mutable bool pending_ = false; // 是否有尚未作用到协方差上的累积量
+
+    vector<Epoch> *epochs_ = nullptr; // 滤波节点的记录位置，为 nullptr 时不记录
+    InnovationStats innovation_;
+    StaticDetector detector_; // 零速修正的静止检测
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include "aligned.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+/// 三轴角度增量和速度增量的统计量（和、均值或方差）
+typedef struct ImuStats {
+    Vector3d dtheta; // 陀螺仪三轴
+    Vector3d dvel;   // 加速度计三轴
+} ImuStats;
+
+/**
+ * @brief IMU数据的只读视图，不拥有数据
+ *
+ * 各字段分别指向按列存储的数组，可以像 vector<IMU> 一样按历元索引，
+ * 也可以直接在整列上执行求和、均值、方差、分块均值等批量计算
+ */
+class ImuView {
+public:
+    ImuView() = default;
+
+    /// 历元数
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    /// 取出第 i 个历元，供逐历元处理的代码使用
+    IMU operator[](size_t i) const {
+        IMU imu;
+        imu.week = week_[i];
+        imu.time = time_[i];
+        imu.dt   = dt_[i];
+        imu.dtheta << dtheta_[0][i], dtheta_[1][i], dtheta_[2][i];
+        imu.dvel << dvel_[0][i], dvel_[1][i], dvel_[2][i];
+        return imu;
+    }
+
+    /**
+     * @brief 取出 [first, first + count) 范围的子视图
+     *
+     * @param first 起始历元索引
+     * @param count 历元数，超出范围时截断到末尾
+     */
+    ImuView sub(size_t first, size_t count) const;
+
+    const int *week() const {
+        return week_;
+    }
+    const double *time() const {
+        return time_;
+    }
+    const double *dt() const {
+        return dt_;
+    }
+    /// 角度增量第 axis 轴
+    const double *dtheta(int axis) const {
+        return dtheta_[axis];
+    }
+    /// 速度增量第 axis 轴
+    const double *dvel(int axis) const {
+        return dvel_[axis];
+    }
+
+    /// 各轴求和
+    ImuStats sum() const;
+
+    /// 各轴均值
+    ImuStats mean() const;
+
+    /// 各轴的样本方差（除以 N-1）
+    ImuStats variance() const;
+
+private:
+    friend class ImuBuffer;
+
+    size_t size_          = 0;
+    const int *week_      = nullptr;
+    const double *time_   = nullptr;
+    const double *dt_     = nullptr;
+    const double *dtheta_[3] = {nullptr, nullptr, nullptr};
+    const double *dvel_[3]   = {nullptr, nullptr, nullptr};
+};
+
+/**
+ * @brief 按列（SoA）存储的IMU数据容器
+ *
+ * 周、周内秒、dt 以及角度增量、速度增量的每个轴各占一个64字节对齐的数组，
+ * 批量计算时每个轴都是连续内存，便于编译器向量化
+ */
+class ImuBuffer {
+public:
+    ImuBuffer() = default;
+
+    /**
+     * @brief 从 vector<IMU> 的 [first, last) 范围转换
+     *
+     * @param imudata 按历元存储的IMU数据
+     * @param first 起始历元索引
+     * @param last 结束历元索引（不含），超出范围时截断到末尾
+     */
+    explicit ImuBuffer(const vector<IMU> &imudata, size_t first = 0, size_t last = SIZE_MAX);
+
+    size_t size() const {
+        return time_.size();
+    }
+    bool empty() const {
+        return time_.empty();
+    }
+
+    void reserve(size_t n);
+    void clear();
+
+    /// 在末尾追加一个历元
+    void push_back(const IMU &imu);
+
+    /// 取出第 i 个历元
+    IMU operator[](size_t i) const {
+        return view()[i];
+    }
+
+    /// 整个容器的只读视图，容器扩容后需要重新获取
+    ImuView view() const;
+
+private:
+    AlignedVector<int> week_;
+    AlignedVector<double> time_;
+    AlignedVector<double> dt_;
+    array<AlignedVector<double>, 3> dtheta_;
+    array<AlignedVector<double>, 3> dvel_;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Eigen/Eigen"
+#include "imubuffer.hpp"
 #include "rotation.hpp"
 #include "types.hpp"
 #include <iostream>
@@ -19,15 +20,29 @@ using namespace std;
 void allanAnalysis(vector<IMU> &imudata, const int &start_idx, const int &end_idx, const int &bins,
                    vector<double> &res_allan_std);
 
+/**
+ * @brief 按列存储数据上的Allan方差分析，分块方式与 allanAnalysis 相同，每块的和由 ImuView::sum 批量计算
+ *
+ * @param imudata 用于Allan方差分析的IMU数据视图
+ * @param bins 将数据分成的份数
+ * @param [in, out] res_allan_std 输出一组加速度计、陀螺仪的Allan标准差的值
+ */
+void allanAnalysis(const ImuView &imudata, const int &bins, vector<double> &res_allan_std);
+
 /**
  * @brief 读取IMU原始数据，输出加速度计和陀螺仪的三轴原始数据到txt文件
  *
+ * 没有数据缓存时由 FileIO::getIMUdataParallel 多线程解析，结果与逐行读取相同
+ *
  * @param imufile IMU原始数据的ASC文件
  * @param imudata 用于存储IMU原始数据的向量
+ * @param threads 解析线程数，为0时使用硬件并发线程数
+ * @param format 转换因子和采样频率
  * @return true 成功读取并输出
  * @return false 读取失败
  */
-bool getRawIMUdata(const string &imufile, vector<IMU> &imudata);
+bool getRawIMUdata(const string &imufile, vector<IMU> &imudata, int threads = 0,
+                   const ImuFormat &format = ImuFormat());
 
 /**
  * @brief 采用初始静止的测量值做静态解析粗对准
@@ -40,4 +55,14 @@ bool getRawIMUdata(const string &imufile, vector<IMU> &imudata);
  * @return Vector3d 欧拉角，按[roll,pitch,yaw]顺序，单位度
  */
 Vector3d getInitAtt(vector<IMU> &imudata, const int &start_idx, const int &end_idx, double phi,
-                    const double &&g = 9.7936174);
\ No newline at end of file
+                    const double &&g = 9.7936174);
+
+/**
+ * @brief 采用初始静止的测量值做静态解析粗对准，均值由 ImuView::mean 批量计算
+ *
+ * 解析粗对准只用到重力和地球自转角速度的方向，与纬度和重力大小无关
+ *
+ * @param imudata 用于静态解析粗对准的IMU数据视图
+ * @return Vector3d 欧拉角，按[roll,pitch,yaw]顺序，单位度
+ */
+Vector3d getInitAtt(const ImuView &imudata);
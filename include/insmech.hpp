@@ -12,6 +12,35 @@ public:
      * */
     static void insMech(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &imucur);
 
+    /**
+     * @brief 单遍完成姿态、速度、位置更新的机械编排，与 insMech 的算法相同
+     *
+     * k-2、k-1 时刻的地理参数各只计算一次，三个更新步骤共用；姿态只维护方向余弦矩阵 att.cbn，
+     * att.euler 和 att.qbn 不再逐历元更新，需要输出时调用 updateAttitude
+     * @param [in,out] pvapre 输入 k-2 时刻状态，输出 k-1 时刻状态
+     * @param [in,out] pvacur 输入 k-1 时刻状态，输出 k 时刻状态
+     * @param [in]     imupre, imucur imudata
+     * */
+    static void insMechFused(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &imucur);
+
+    /**
+     * @brief insMechFused 的逆运算：由 k 时刻的目标姿态和速度求 k 时刻的角度增量和速度增量
+     *
+     * 用求得的增量调用 insMechFused 时，k 时刻的姿态和速度在舍入误差内等于目标值，位置由同一模型积分得到
+     * @param [in]     pvapre k-2 时刻状态
+     * @param [in]     pvacur k-1 时刻状态
+     * @param [in]     imupre k-1 时刻的IMU增量
+     * @param [in]     cbn, vel k 时刻的目标姿态矩阵和NED速度
+     * @param [in,out] imucur 输入 dt，输出 dtheta、dvel
+     * */
+    static void insMechInverse(const PVA &pvapre, const PVA &pvacur, const IMU &imupre, const Matrix3d &cbn,
+                               const Vector3d &vel, IMU &imucur);
+
+    /**
+     * @brief 由姿态矩阵 cbn 计算欧拉角和四元数
+     * */
+    static void updateAttitude(Attitude &att);
+
 private:
     /**
      * @breif 位置更新
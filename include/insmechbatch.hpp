@@ -0,0 +1,101 @@
+#pragma once
+#include "aligned.hpp"
+#include "types.hpp"
+#include <cstddef>
+using namespace std;
+
+/**
+ * @brief 多条独立轨迹同步递推的批量机械编排
+ *
+ * K 条轨迹（不同数据集、初始姿态或IMU误差的蒙特卡洛扰动）的状态按列存储，
+ * 同一个量在各轨迹之间连续排列，每个历元对所有轨迹执行同一段无分支的计算，
+ * 编译器可以把轨迹维度映射到SIMD通道（AVX2为4条、AVX-512为8条），单核吞吐量接近K倍。
+ * 算法与 INSMech::insMechFused 相同，以下两处改为便于向量化的形式：
+ * - 等效旋转矢量转方向余弦矩阵的系数 sin(x)/x、(1-cos(x))/x^2 在 x 不大时使用泰勒级数，
+ *   超出级数适用范围的轨迹单独用三角函数修正
+ * - 纬度的三角函数由上一历元纬度的三角函数和角度和公式递推，每隔若干历元直接计算一次
+ *
+ * 使用方法：initialize 设置每条轨迹的初始状态，每个历元先用 setIMU 填入各轨迹的IMU数据，再调用 update
+ */
+class INSMechBatch {
+public:
+    /**
+     * @brief 分配 lanes 条轨迹的状态
+     *
+     * @param lanes 轨迹数
+     */
+    explicit INSMechBatch(size_t lanes);
+
+    // 各列的首地址保存在 cols_ 中，不允许拷贝
+    INSMechBatch(const INSMechBatch &)            = delete;
+    INSMechBatch &operator=(const INSMechBatch &) = delete;
+
+    /// 轨迹数
+    size_t lanes() const {
+        return lanes_;
+    }
+
+    /**
+     * @brief 设置第 lane 条轨迹的初始状态
+     *
+     * @param lane 轨迹索引
+     * @param pvapre k-2 时刻状态
+     * @param pvacur k-1 时刻状态
+     * @param imupre k-1 时刻的IMU数据
+     */
+    void initialize(size_t lane, const PVA &pvapre, const PVA &pvacur, const IMU &imupre);
+
+    /**
+     * @brief 填入第 lane 条轨迹下一次 update 使用的IMU数据
+     *
+     * @param lane 轨迹索引
+     * @param imucur k 时刻的IMU数据
+     */
+    void setIMU(size_t lane, const IMU &imucur);
+
+    /// 所有轨迹同步递推一个历元
+    void update();
+
+    /**
+     * @brief 第 lane 条轨迹的当前状态，同时计算欧拉角和四元数
+     *
+     * @param lane 轨迹索引
+     */
+    PVA state(size_t lane) const;
+
+private:
+    // 按列存储的各个量，每列 stride_ 个 double
+    enum Column : int {
+        LAT, LON, HGT,                                    // k-1 时刻位置
+        VN, VE, VD,                                       // k-1 时刻速度
+        PVN, PVE, PVD,                                    // k-2 时刻速度
+        C00, C01, C02, C10, C11, C12, C20, C21, C22,      // k-1 时刻姿态矩阵
+        SINLAT, COSLAT,                                   // k-1 时刻纬度的三角函数
+        RM, RN, WIEN, WIED, WENN, WENE, WEND, GRAV,       // k-1 时刻地理参数，wie_n 的东向分量恒为0
+        PWIEN, PWIED, PWENN, PWENE, PWEND, PGRAV,         // k-2 时刻地理参数
+        DT, DTH0, DTH1, DTH2, DV0, DV1, DV2,              // k 时刻IMU数据
+        PDTH0, PDTH1, PDTH2, PDV0, PDV1, PDV2,            // k-1 时刻IMU数据
+        PHI0, PHI1, PHI2, CBBA, CBBB,                     // b系等效旋转矢量及转换系数
+        ZETA0, ZETA1, ZETA2, CNNA, CNNB,                  // n系等效旋转矢量及转换系数
+        COLUMNS
+    };
+
+    double *col(int column) {
+        return cols_[column];
+    }
+    const double *col(int column) const {
+        return cols_[column];
+    }
+
+    /// 交换两组列，递推完成后 k-1 时刻的量变为 k-2 时刻的量
+    void swapColumns(int first, int second, int count);
+
+    /// 由 k-1 时刻的位置、速度和纬度三角函数计算地理参数
+    void updateTerms();
+
+    size_t lanes_;
+    size_t stride_;    // 每列的长度，补齐到8的倍数，使每列的首地址都按64字节对齐
+    size_t epoch_ = 0; // 已递推的历元数
+    AlignedVector<double> data_;
+    double *cols_[COLUMNS];
+};
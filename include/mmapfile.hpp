@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <string>
+using namespace std;
+
+/**
+ * @brief 以只读方式将整个文件映射到内存，析构时自动解除映射
+ *
+ * 用于大文件的零拷贝读取，读取过程中不再经过 fstream 的缓冲区拷贝
+ */
+class MmapFile {
+public:
+    MmapFile() = default;
+    explicit MmapFile(const string &path) {
+        open(path);
+    }
+    ~MmapFile() {
+        close();
+    }
+
+    MmapFile(const MmapFile &)            = delete;
+    MmapFile &operator=(const MmapFile &) = delete;
+
+    /**
+     * @brief 打开并映射文件
+     *
+     * @param [in] path 文件路径
+     * @return true 映射成功（空文件也视为成功，此时 size() 为0）
+     * @return false 文件打开或映射失败
+     */
+    bool open(const string &path);
+
+    /// 解除映射并关闭文件
+    void close();
+
+    /// 提示内核按顺序访问映射区域，加大预读
+    void adviseSequential() const;
+
+    /**
+     * @brief 提示内核已读完 [0, offset) 区域，可以回收对应的物理页
+     *
+     * @param [in] offset 已处理完的字节数，内部会按页大小向下对齐
+     */
+    void releaseBefore(size_t offset) const {
+        release(0, offset);
+    }
+
+    /**
+     * @brief 提示内核 [offset, offset + length) 区域暂时不再访问，可以回收对应的物理页
+     *
+     * @param [in] offset 区域起始位置，内部会按页大小向上对齐
+     * @param [in] length 区域长度，区域结束位置会按页大小向下对齐
+     */
+    void release(size_t offset, size_t length) const;
+
+    bool isOpen() const {
+        return is_open_;
+    }
+    const char *data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    const char *begin() const {
+        return data_;
+    }
+    const char *end() const {
+        return data_ + size_;
+    }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_      = 0;
+    bool is_open_     = false;
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+using namespace std;
+
+/**
+ * @brief 内置的分阶段计时和计数
+ *
+ * 用 GINS_PROFILE_SCOPE(name) 统计所在作用域的耗时，GINS_PROFILE_COUNT(name, n) 累加计数，
+ * 同名的计时点合并为一个阶段，阶段耗时包含其中嵌套的阶段。每个阶段记录调用次数、总耗时、最大耗时和
+ * 按2的整数次幂分桶的耗时直方图，各线程用原子操作累加，可以在线程池中使用。
+ *
+ * 编译时未定义 GINS_PROFILING（CMake 选项 GINS_PROFILING=OFF）时宏展开为空，不产生任何开销；
+ * 定义后默认不启用，未启用时每个计时点只多一次原子读和分支，由命令行 --profile 启用
+ */
+class Profiler {
+public:
+    static constexpr int BUCKETS = 64; // 第 b 个桶为 [2^b, 2^(b+1)) ns，0ns计入第0个桶
+
+    enum Kind { TIMER, COUNTER };
+
+    /// 一个计时或计数阶段，注册后地址不变
+    struct Stage {
+        Stage(const char *name, Kind kind)
+            : name(name)
+            , kind(kind) {
+        }
+
+        /// 记录一次耗时（ns）
+        void record(uint64_t ns);
+
+        /// 累加计数
+        void add(uint64_t n) {
+            calls.fetch_add(1, memory_order_relaxed);
+            total.fetch_add(n, memory_order_relaxed);
+        }
+
+        /// 耗时分位数的估计值（ns），取所在桶的上界且不超过最大值
+        uint64_t percentile(double q) const;
+
+        string name;
+        Kind kind;
+        atomic<uint64_t> calls{0}; // 调用（计数）次数
+        atomic<uint64_t> total{0}; // 总耗时（ns）或计数之和
+        atomic<uint64_t> max{0};   // 最大耗时（ns）
+        array<atomic<uint64_t>, BUCKETS> buckets{};
+    };
+
+    /// 编译时是否包含计时点
+    static constexpr bool compiled() {
+#ifdef GINS_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// 运行时是否启用
+    static bool enabled() {
+        return enabled_.load(memory_order_relaxed);
+    }
+
+    static void setEnabled(bool enabled) {
+        enabled_.store(enabled, memory_order_relaxed);
+    }
+
+    /**
+     * @brief 注册或查找阶段，由宏在每个计时点第一次执行时调用一次
+     *
+     * @param name 阶段名称，同名阶段返回同一个对象
+     * @param kind 计时或计数
+     * @return Stage& 阶段，程序结束前一直有效
+     */
+    static Stage &stage(const char *name, Kind kind);
+
+    /// 清零所有阶段的统计
+    static void reset();
+
+    /// 按总耗时从大到小输出各阶段的调用次数、总耗时、平均、p50、p99和最大耗时，以及各计数
+    static void report(ostream &os);
+
+    /**
+     * @brief 以JSON格式写入各阶段的统计和非空的直方图桶
+     *
+     * @param path 输出文件路径
+     * @return true 写入成功
+     * @return false 文件创建或写入失败
+     */
+    static bool writeJson(const string &path);
+
+private:
+    static atomic<bool> enabled_;
+};
+
+/// 作用域计时，构造时记录开始时刻，析构时把耗时计入阶段
+class ProfileScope {
+public:
+    explicit ProfileScope(Profiler::Stage &stage)
+        : stage_(Profiler::enabled() ? &stage : nullptr) {
+        if (stage_ != nullptr) {
+            start_ = chrono::steady_clock::now();
+        }
+    }
+
+    ~ProfileScope() {
+        if (stage_ != nullptr) {
+            stage_->record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start_).count());
+        }
+    }
+
+    ProfileScope(const ProfileScope &)            = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    Profiler::Stage *stage_;
+    chrono::steady_clock::time_point start_;
+};
+
+#define GINS_PROFILE_CONCAT_(a, b) a##b
+#define GINS_PROFILE_CONCAT(a, b)  GINS_PROFILE_CONCAT_(a, b)
+
+#ifdef GINS_PROFILING
+#define GINS_PROFILE_SCOPE(name)                                                                                       \
+    static Profiler::Stage &GINS_PROFILE_CONCAT(gins_stage_, __LINE__) = Profiler::stage(name, Profiler::TIMER);        \
+    ProfileScope GINS_PROFILE_CONCAT(gins_scope_, __LINE__)(GINS_PROFILE_CONCAT(gins_stage_, __LINE__))
+#define GINS_PROFILE_COUNT(name, n)                                                                                    \
+    do {                                                                                                               \
+        static Profiler::Stage &gins_counter = Profiler::stage(name, Profiler::COUNTER);                               \
+        if (Profiler::enabled()) {                                                                                     \
+            gins_counter.add(n);                                                                                       \
+        }                                                                                                              \
+    } while (0)
+#else
+#define GINS_PROFILE_SCOPE(name)    ((void) 0)
+#define GINS_PROFILE_COUNT(name, n) ((void) 0)
+#endif
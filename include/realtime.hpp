@@ -0,0 +1,208 @@
+#pragma once
+#include "gins.hpp"
+#include "resultsink.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+using namespace std;
+
+/**
+ * @brief 实时数据流中的一帧，固定128字节，IMU和GNSS数据使用相同的帧格式
+ *
+ * 帧按主机字节序直接写入管道或UNIX域套接字，读取时不需要解析，也不分配内存。
+ * stamp 为发送方写入时的 CLOCK_MONOTONIC 时间（ns），同一台机器上用于统计端到端延迟，为0时不统计
+ */
+typedef struct DataFrame {
+    uint32_t magic;    // 固定为 FrameIO::MAGIC
+    uint32_t type;     // FrameIO::Type
+    uint64_t stamp;    // 发送时刻（ns）
+    double week;       // GPS周
+    double time;       // GPS周内秒
+    double values[12]; // IMU：dt、角度增量、速度增量；GNSS：BLH、位置标准差、NED速度、速度标准差
+} DataFrame;
+static_assert(sizeof(DataFrame) == 128, "DataFrame 必须为128字节");
+
+/**
+ * @brief 实时数据帧的转换和读取
+ *
+ * 数据源可以是标准输入（"-"）、命名管道或普通文件的路径，或者 "unix:路径" 形式的UNIX域套接字（作为客户端连接）。
+ * 套接字是双向的，接收方每处理完一个IMU历元回送一个确认帧（FRAME_ACK，原样带回 stamp），
+ * 发送方据此统计从发出到处理完成的延迟
+ */
+class FrameIO {
+public:
+    static constexpr uint32_t MAGIC = 0x464E4947; // "GINF"
+
+    enum Type : uint32_t {
+        FRAME_IMU  = 1,
+        FRAME_GNSS = 2,
+        FRAME_END  = 3, // 数据结束
+        FRAME_ACK  = 4, // 处理完成的确认
+    };
+
+    /// 当前 CLOCK_MONOTONIC 时间（ns）
+    static uint64_t now();
+
+    static DataFrame toFrame(const IMU &imu, uint64_t stamp = 0);
+    static DataFrame toFrame(const GNSS &gnss, uint64_t stamp = 0);
+    static void fromFrame(const DataFrame &frame, IMU &imu);
+    static void fromFrame(const DataFrame &frame, GNSS &gnss);
+
+    /**
+     * @brief 打开数据源
+     *
+     * @param source "-"、文件（管道）路径或 "unix:路径"
+     * @return int 文件描述符，失败时返回-1
+     */
+    static int openSource(const string &source);
+
+    /**
+     * @brief 打开输出目标
+     *
+     * @param dest "-"（标准输出）、文件（管道）路径，或 "unix:路径"，此时创建套接字并等待一个接收方连接
+     * @return int 文件描述符，失败时返回-1
+     */
+    static int openSink(const string &dest);
+
+    /// 文件描述符是否为套接字，套接字才能回送确认帧
+    static bool isSocket(int fd);
+
+    /**
+     * @brief 阻塞读取一帧
+     *
+     * @param [in] fd 文件描述符
+     * @param [out] frame 数据帧
+     * @return true 读到一帧IMU、GNSS数据或确认帧
+     * @return false 数据结束、连接断开或帧格式错误
+     */
+    static bool readFrame(int fd, DataFrame &frame);
+
+    /// 阻塞写入一帧，对方关闭时返回 false，调用方需要忽略 SIGPIPE
+    static bool writeFrame(int fd, const DataFrame &frame);
+
+    /// 与 frame 对应的确认帧
+    static DataFrame ackFrame(const DataFrame &frame);
+};
+
+/**
+ * @brief 延迟直方图，桶的相对宽度不超过1/16，记录时不分配内存
+ *
+ * 小于16ns的值各占一个桶，之后每个2的整数次幂区间等分为16个桶，分位数取所在桶的上界
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int BUCKETS     = 64 * SUB_BUCKETS;
+
+    /// 记录一次延迟（ns）
+    void record(uint64_t ns);
+
+    size_t count() const {
+        return count_;
+    }
+
+    uint64_t max() const {
+        return max_;
+    }
+
+    /**
+     * @brief 分位数
+     *
+     * @param q 0~1
+     * @return uint64_t 延迟（ns），没有记录时为0
+     */
+    uint64_t percentile(double q) const;
+
+    /// 输出记录数、p50、p99、p99.9和最大值（us）
+    void report(ostream &os, const string &name) const;
+
+private:
+    static int bucket(uint64_t ns);
+    static uint64_t upperBound(int bucket);
+
+    array<uint64_t, BUCKETS> counts_{};
+    size_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+// 实时模式可选的线程和内存设置，默认都不启用，见 RealtimeNavigator::configureThread
+typedef struct RealtimeOptions {
+    bool lockmemory = false; // mlockall 锁定当前和以后分配的内存，处理过程中不发生缺页和换出
+    int priority    = 0;     // SCHED_FIFO 实时优先级（1~99），0表示不改变调度策略
+    int cpu         = -1;    // 处理线程绑定的CPU核心，-1表示不绑定
+    double budget   = 5.0;   // 每个IMU历元处理延迟的预算（ms），结束时报告超出预算的历元数
+} RealtimeOptions;
+
+/**
+ * @brief 实时组合导航：逐帧接收IMU和GNSS数据，每个IMU历元递推后立即输出结果
+ *
+ * 收到第一个GNSS数据前只保存最新的IMU数据；收到后以GNSS位置、速度和配置的初始姿态初始化 GIEngine，
+ * 与批处理一样从下一个GNSS数据开始量测更新。GNSS数据必须在其时刻所在的IMU历元之前到达，
+ * 晚于当前历元到达的GNSS数据不再使用，计入 lateGnss()。
+ * 初始化之后处理每一帧都不分配堆内存，结果交给 ResultSink 的输出线程写入文件
+ */
+class RealtimeNavigator {
+public:
+    /**
+     * @brief 构造
+     *
+     * @param options 松组合配置参数
+     * @param sink 结果输出
+     */
+    RealtimeNavigator(const GINSOptions &options, ResultSink &sink);
+
+    /**
+     * @brief 对调用线程（处理数据帧的线程）应用实时设置，在处理第一帧之前调用
+     *
+     * 普通Linux内核上处理延迟的尾部主要来自缺页、被其他线程抢占和在CPU核心间迁移，这些设置只能减小而不能消除，
+     * 不提供最坏情况延迟的保证。锁定内存、实时优先级通常需要 root 权限（或 CAP_IPC_LOCK、CAP_SYS_NICE），
+     * 某项设置失败时输出原因并继续应用其他设置。无论是否启用，都会预先访问一段栈空间
+     *
+     * @param options 实时设置
+     * @return true 全部设置成功
+     */
+    static bool configureThread(const RealtimeOptions &options);
+
+    /**
+     * @brief 处理一帧数据
+     *
+     * @param frame IMU或GNSS数据帧
+     * @return true 递推了一个IMU历元并输出了结果
+     * @return false 其他情况（GNSS数据、初始化前的IMU数据、增量为0的IMU数据）
+     */
+    bool process(const DataFrame &frame);
+
+    /// 是否已经初始化
+    bool initialized() const {
+        return engine_.has_value();
+    }
+
+    /// 组合导航引擎，只能在初始化之后调用
+    const GIEngine &engine() const {
+        return *engine_;
+    }
+
+    /// 已输出的历元数
+    size_t epochs() const {
+        return epochs_;
+    }
+
+    /// 到达过晚未能使用的GNSS数据个数
+    size_t lateGnss() const {
+        return late_gnss_;
+    }
+
+private:
+    GINSOptions options_;
+    ResultSink &sink_;
+    optional<GIEngine> engine_;
+
+    IMU imupre_;               // 初始化前最新的IMU数据
+    bool has_imu_     = false; // imupre_ 是否有效
+    double stdtime_   = -1;    // 下一次输出标准差的时刻
+    size_t epochs_    = 0;
+    size_t late_gnss_ = 0;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include "gins.hpp"
+#include "spscqueue.hpp"
+#include "trajectory.hpp"
+#include "types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <thread>
+using namespace std;
+
+/**
+ * @brief 异步结果输出：滤波线程把每个历元的结果放入无锁队列，由输出线程格式化并写入文件
+ *
+ * 输出线程用 to_chars 格式化数值，每个文件先写入约1MB的内存缓冲区，写满后整块写入文件，
+ * 滤波线程只做一次拷贝，不再受格式化和磁盘I/O的拖累。队列满时滤波线程让出CPU（等待较久后休眠）等待输出线程。
+ * 输出的文件（文件名加上 suffix，如 result_rts.txt）：
+ * - result.txt：时间、位置（deg、deg、m）、NED速度、姿态（deg）
+ * - navres.txt：时间、相对第一个输出历元的ENU位置、ENU速度、姿态（deg）
+ * - blhres.txt：与GNSS定位结果pos文件格式相同的BLH结果，标准差取最近一次输出的值
+ * - navxyz.txt：时间、ECEF位置、速度及其标准差，标准差取最近一次输出的值
+ * - navresstd.txt：时间、ENU位置、速度标准差，姿态标准差（deg），只在标准差有效的历元输出
+ *
+ * 抽稀只作用于导航结果，标准差有效的历元总会输出到 navresstd.txt。
+ * 配置为二进制输出时只写入 result.traj（格式见 TrajectoryFile），导航结果和标准差在同一条记录中，
+ * 可以用 tools traj2txt 转换为上述文本文件
+ */
+class ResultSink {
+public:
+    static constexpr size_t QUEUE_SIZE  = 4096;    // 队列容量（历元）
+    static constexpr size_t BUFFER_SIZE = 1 << 20; // 每个文件的写缓冲区大小（字节）
+
+    /**
+     * @brief 创建输出文件并启动输出线程
+     *
+     * @param options 使用其中的输出目录、抽稀（decimation、gnssonly）和输出格式（binaryoutput、stdinterval）
+     * @param suffix 文件名后缀
+     * @param echo 是否同时把 result.txt 的内容输出到终端
+     */
+    ResultSink(const GINSOptions &options, const string &suffix = "", bool echo = false);
+    ~ResultSink();
+
+    ResultSink(const ResultSink &)            = delete;
+    ResultSink &operator=(const ResultSink &) = delete;
+
+    /// 输出文件是否全部创建成功
+    bool isOpen() const {
+        return writer_.joinable();
+    }
+
+    /**
+     * @brief 提交一个历元的结果，只能在同一个线程中调用
+     *
+     * @param result 导航结果
+     */
+    void push(const NavResult &result);
+
+    /// 预先写入结果队列的内存，避免实时处理中第一次写入队列时缺页，只能在第一次 push 之前调用
+    void prefault() {
+        queue_.prefault();
+    }
+
+    /**
+     * @brief 整理一个历元的导航结果
+     *
+     * @param std 误差状态的标准差，为 nullptr 时本历元不输出标准差
+     * @param gnss 本历元是否进行了GNSS量测更新
+     */
+    static NavResult navResult(int week, double time, const PVA &pva, const GIEngine::StateVector *std, bool gnss);
+
+    /**
+     * @brief 是否到了输出标准差的时刻，是则更新下一次输出的时刻
+     *
+     * @param [in] time 当前时刻
+     * @param [in] stdinterval 输出标准差的时间间隔，为0时不输出
+     * @param [in,out] stdtime 下一次输出标准差的时刻，初值取负数
+     */
+    static bool isStdEpoch(double time, double stdinterval, double &stdtime);
+
+    /**
+     * @brief 等待输出线程写完所有结果并关闭文件，析构时自动调用
+     *
+     * @return true 全部写入成功
+     * @return false 文件写入失败
+     */
+    bool close();
+
+private:
+    enum FileID { RESULT, NAVRES, BLHRES, NAVXYZ, NAVRESSTD, FILE_COUNT };
+
+    // 队列中的记录，nav 表示是否输出导航结果（未被抽稀）
+    struct Record {
+        NavResult result;
+        bool nav;
+    };
+
+    /// 输出线程：从队列取出结果并格式化，直到 close 且队列为空
+    void run();
+
+    /// 格式化一个历元的结果，追加到各文件的缓冲区
+    void format(const Record &record);
+
+    /// 把缓冲区写入文件，force 为 false 时只写入超过 BUFFER_SIZE 的缓冲区
+    void flush(bool force);
+
+    string filenames_[FILE_COUNT];
+    fstream files_[FILE_COUNT];
+    string buffers_[FILE_COUNT];
+    string echobuf_;
+    TrajectoryWriter traj_; // 二进制输出
+
+    int decimation_;
+    bool gnssonly_;
+    bool binary_;
+    bool echo_;
+    size_t epoch_ = 0;    // 已提交的历元数，用于抽稀
+    bool ok_      = true; // 文件创建、写入是否成功
+
+    // 以下只由输出线程访问
+    bool has_origin_ = false;
+    Vector3d origin_;     // navres.txt 的ENU坐标原点（BLH）
+    NavResult lateststd_; // 最近一次有效的标准差
+
+    SpscQueue<Record, QUEUE_SIZE> queue_;
+    atomic<bool> done_{false};
+    thread writer_;
+};
@@ -56,9 +56,19 @@ public:
     }
 
     static Matrix3d rotvec2matrix(const Vector3d &rotvec){
-        double angle = rotvec.norm();
-        Matrix3d dcm = Eigen::Matrix3d::Identity() + sin(angle)/angle * skewSymmetric(rotvec)
-                        + (1-cos(angle))/(angle*angle) * skewSymmetric(rotvec) * skewSymmetric(rotvec);
+        double angle2 = rotvec.squaredNorm();
+        Matrix3d skew = skewSymmetric(rotvec);
+        double a, b;
+        if (angle2 < 1E-16) {
+            // 小角度时使用泰勒展开，避免 0/0
+            a = 1 - angle2 / 6.0;
+            b = 0.5 - angle2 / 24.0;
+        } else {
+            double angle = sqrt(angle2);
+            a            = sin(angle) / angle;
+            b            = (1 - cos(angle)) / angle2;
+        }
+        Matrix3d dcm = Eigen::Matrix3d::Identity() + a * skew + b * skew * skew;
         return dcm;
     }
 
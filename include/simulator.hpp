@@ -0,0 +1,144 @@
+#pragma once
+#include "resultsink.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+// 轨迹仿真参数
+typedef struct SimOptions {
+    int week            = 2315;     // GPS周
+    double starttime    = 287400.0; // 开始时刻（周内秒）
+    double duration     = 600.0;    // 仿真时长（s），不处理跨GPS周
+    int imurate         = 100;      // IMU采样率（Hz）
+    double gnssinterval = 1.0;      // GNSS采样间隔（s），为0时不生成GNSS数据
+
+    Vector3d initpos{30.528 * D2R, 114.357 * D2R, 20.0}; // 初始位置BLH（rad、rad、m）
+    Vector3d initatt{0, 0, 0};                            // 初始姿态（rad）
+    double statictime = 60.0;                             // 开始运动前的静止时长（s），用于初始对准
+    double speed      = 10.0;                             // 巡航速度（m/s）
+
+    ImuNoise imunoise;                 // IMU噪声参数，noise 为 true 时必须设置
+    bool noise    = true;              // 是否加入IMU噪声、零偏、比例因子误差和GNSS噪声
+    bool quantize = true;              // 是否按ASC文件的分辨率量化IMU增量，量化误差累积到下一个历元
+    ImuFormat format;                  // ASC文件的转换因子，量化和写出IMU增量时使用
+    Vector3d posstd{0.02, 0.02, 0.05}; // GNSS位置标准差（NED，m）
+    Vector3d velstd{0.01, 0.01, 0.02}; // GNSS速度标准差（NED，m/s）
+    Vector3d antlever{0, 0, 0};        // GNSS天线杆臂（b系，m）
+    uint64_t seed = 1;                 // 随机数种子
+} SimOptions;
+
+/**
+ * @brief 确定性的IMU/GNSS轨迹仿真
+ *
+ * 真值轨迹由解析的运动模型给出：静止 statictime 秒后加速到巡航速度，航向、俯仰、横滚按不同周期平滑摆动。
+ * 每个历元由目标姿态和速度经 INSMech::insMechInverse 反求无误差的IMU增量，再用 insMechFused 递推得到真值，
+ * 因此用无误差增量做机械编排可以在舍入误差内复现真值。
+ * 量测值为 (1+比例因子)·增量 + 零偏·dt + 白噪声，零偏和比例因子为一阶高斯-马尔可夫过程，
+ * 与 GIEngine 的误差模型一致。GNSS量测取自天线相位中心的真值加白噪声。
+ * 随机数由 mt19937_64 和 Box-Muller 变换生成，同一可执行程序和同一数学库（libm）下相同参数生成的数据逐位相同；
+ * Box-Muller 变换和运动模型用到 log、sin、cos 等函数，换用不同的 libm 或编译选项时结果可能有微小差异。
+ * 逐历元生成，内存占用与时长无关，也可以一次生成到内存中
+ */
+class Simulator {
+public:
+    explicit Simulator(const SimOptions &options);
+
+    /// IMU历元数（不含开始时刻）
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * @brief 生成下一个历元的IMU量测值，同时更新真值
+     *
+     * @param [out] imu IMU量测值（增量形式，轴系与 FileIO 读取的结果相同）
+     * @return true 生成成功
+     * @return false 已到仿真结束时刻
+     */
+    bool next(IMU &imu);
+
+    /// 当前历元的真值，姿态的欧拉角、四元数和方向余弦矩阵均有效
+    const PVA &truth() const {
+        return truth_;
+    }
+
+    /// 当前历元无误差的IMU增量
+    const IMU &clean() const {
+        return clean_;
+    }
+
+    /**
+     * @brief 当前历元是否为GNSS历元，是则取出GNSS量测值
+     *
+     * GNSS量测值在 next 中生成，是否调用本函数不影响之后的随机数序列
+     * @param [out] gnss GNSS量测值
+     * @return true 当前历元为GNSS历元
+     */
+    bool gnss(GNSS &gnss) const {
+        if (has_gnss_) {
+            gnss = gnss_;
+        }
+        return has_gnss_;
+    }
+
+    /**
+     * @brief 一次生成全部数据到内存
+     *
+     * @param [in] options 仿真参数
+     * @param [out] imudata IMU量测值，与读取仿真输出的ASC文件得到的结果相同（时刻相差不超过1ns）
+     * @param [out] gnssdata GNSS量测值
+     * @param [out] truth 每个IMU历元的真值，为 nullptr 时不保存
+     */
+    static void generate(const SimOptions &options, vector<IMU> &imudata, vector<GNSS> &gnssdata,
+                         vector<PVA> *truth = nullptr);
+
+    /**
+     * @brief 逐历元生成数据并写入ASC、pos文件
+     *
+     * @param options 仿真参数，quantize 为 false 时ASC文件中的增量仍会量化
+     * @param imufile IMU ASC格式数据文件路径
+     * @param gnssfile GNSS pos格式数据文件路径
+     * @param truth 真值输出，为 nullptr 时不输出
+     * @return true 写入成功
+     * @return false 文件创建或写入失败
+     */
+    static bool writeFiles(const SimOptions &options, const string &imufile, const string &gnssfile,
+                           ResultSink *truth = nullptr);
+
+private:
+    /// t 时刻（相对开始时刻）的目标姿态和NED速度
+    void profile(double t, Vector3d &euler, Vector3d &vel) const;
+
+    /// 标准正态分布随机数
+    double gauss();
+
+    /// 各分量独立、标准差为 std 的正态分布随机向量
+    Vector3d gauss(const Vector3d &std);
+
+    /// 一阶高斯-马尔可夫过程递推一步
+    void markov(Vector3d &value, const Vector3d &std);
+
+    /// 由当前真值生成GNSS量测值
+    void makeGnss();
+
+    SimOptions options_;
+    size_t size_;      // IMU历元数
+    size_t epoch_ = 0; // 当前历元
+    double dt_;        // IMU采样间隔
+    size_t gnss_step_; // 每隔几个IMU历元一个GNSS历元，为0时不生成
+
+    PVA pvapre_, truth_; // k-1、k 时刻的真值
+    IMU clean_;          // k 时刻无误差的增量
+    ImuError error_;     // 当前的零偏和比例因子误差
+    GNSS gnss_;          // k 时刻的GNSS量测值
+    bool has_gnss_ = false;
+
+    Vector3d dvel_residual_, dtheta_residual_; // 量化误差
+
+    mt19937_64 rng_;
+    bool has_spare_ = false; // Box-Muller 变换每次生成两个随机数，spare_ 为留待下次使用的一个
+    double spare_   = 0;
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include "gins.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 内存占用有上限的RTS平滑器
+ *
+ * 标准的RTS平滑需要保存每个节点的状态转移矩阵和先验、后验协方差（每个节点约10KB），
+ * 200Hz数据处理几个小时就需要几十GB内存。这里采用检查点重算的方式：
+ * - 正向滤波时把所有输入（IMU、GNSS数据）按紧凑的二进制格式顺序写入磁盘上的输入日志，
+ *   每积累 segmentSize() 个节点保存一次滤波器的完整状态作为检查点，只在内存中保留当前分段的节点
+ * - 反向平滑时从最后一个分段开始，从检查点恢复滤波器并从输入日志重放该分段的输入，
+ *   重新得到分段内的节点后做反向递推，分段首节点的平滑结果传递给前一个分段
+ *
+ * 重放与正向滤波执行的是同一段代码、使用相同的输入和初始状态，得到的节点逐位相同，
+ * 因此平滑结果与把所有节点保存在内存中的平滑器逐位一致，代价是多做一遍正向滤波。
+ * 峰值内存约为 segmentSize() 个节点加上所有检查点（每个约13KB，即一个 GIEngine 及其静止检测窗口）。
+ * 平滑结果按时间倒序产生，先写入临时文件，最后按时间顺序输出。
+ *
+ * 使用方法与 GIEngine 相同：addImuData、addGnssData、newImuProcess 依次调用完所有数据后，调用 smooth
+ */
+class RTSSmoother {
+public:
+    using StateMatrix = GIEngine::StateMatrix;
+    using StateVector = GIEngine::StateVector;
+    using Epoch       = GIEngine::Epoch;
+
+    /**
+     * @brief 平滑结果的输出函数
+     *
+     * @param time 时刻
+     * @param state 平滑后的导航状态和IMU误差
+     * @param std 平滑后误差状态的标准差
+     */
+    using Output = function<void(double time, const NavState &state, const StateVector &std)>;
+
+    /**
+     * @brief 初始化正向滤波器
+     *
+     * @param options 松组合配置参数，initstate 的位置、速度需要事先设置好
+     * @param max_memory 分段节点占用内存的上限（字节），为0时不分段，所有节点都保存在内存中
+     * @param tmpdir 输入日志和临时结果文件所在目录，为空时使用系统临时目录
+     */
+    RTSSmoother(const GINSOptions &options, size_t max_memory, const string &tmpdir = "");
+    ~RTSSmoother();
+
+    RTSSmoother(const RTSSmoother &)            = delete;
+    RTSSmoother &operator=(const RTSSmoother &) = delete;
+
+    /// 临时文件是否创建成功
+    bool isOpen() const {
+        return log_.is_open();
+    }
+
+    /// 加入新的IMU数据，同 GIEngine::addImuData
+    void addImuData(const IMU &imu);
+
+    /// 加入新的GNSS数据，同 GIEngine::addGnssData
+    void addGnssData(const GNSS &gnss);
+
+    /// 正向滤波递推一个历元，同 GIEngine::newImuProcess
+    void newImuProcess();
+
+    /// 正向滤波器，用于输出滤波结果
+    const GIEngine &engine() const {
+        return engine_;
+    }
+
+    /**
+     * @brief 反向平滑，按时间顺序输出每个IMU历元的平滑结果
+     *
+     * @param output 输出函数
+     * @return true 平滑完成
+     * @return false 临时文件读写失败
+     */
+    bool smooth(const Output &output);
+
+    /// 每个分段的节点数
+    size_t segmentSize() const {
+        return segment_size_;
+    }
+
+    /// 正向滤波得到的节点总数
+    size_t epochCount() const {
+        return epoch_count_;
+    }
+
+    /// 检查点个数，即分段数
+    size_t checkpointCount() const {
+        return checkpoints_.size();
+    }
+
+    /// 节点、检查点和平滑递推占用内存的峰值（字节），不含输入日志和临时文件（位于磁盘上）
+    size_t peakMemory() const {
+        return peak_memory_;
+    }
+
+private:
+    // 输入日志的记录类型
+    enum Op : uint8_t {
+        OP_IMU     = 1, // addImuData
+        OP_GNSS    = 2, // addGnssData
+        OP_PROCESS = 3, // newImuProcess
+    };
+
+    // 检查点：分段开始时的滤波器状态及其在输入日志中的位置
+    struct Checkpoint {
+        GIEngine engine;
+        uint64_t offset; // 分段第一条输入在输入日志中的偏移
+    };
+
+    /// 当前分段的节点数达到上限时保存检查点，开始新的分段
+    void checkSegment();
+
+    /**
+     * @brief 从检查点重放一个分段，重新得到分段内的节点
+     *
+     * @param [in] segment 分段索引
+     * @param [out] epochs 分段内的节点，第一个节点为分段开始时的状态
+     * @return true 重放成功
+     * @return false 输入日志读取失败
+     */
+    bool replay(size_t segment, vector<Epoch> &epochs);
+
+    /// 统计当前内存占用并更新峰值
+    void updatePeakMemory(size_t epochs);
+
+    GIEngine engine_;
+    size_t segment_size_;
+    size_t epoch_count_ = 0;
+    size_t peak_memory_ = 0;
+
+    vector<Epoch> epochs_;           // 当前（正向滤波时为最后一个）分段的节点
+    vector<Checkpoint> checkpoints_; // 各分段的检查点
+
+    string logfile_;    // 输入日志路径
+    string resultfile_; // 倒序平滑结果的临时文件路径
+    fstream log_;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 单生产者单消费者的无锁队列，容量在编译期确定
+ *
+ * 只允许一个线程调用 push、另一个线程调用 pop。队首、队尾索引各自只由一个线程写入，
+ * 通过 acquire/release 语义保证元素的写入先于索引的更新被对方看到，两个索引分属不同的缓存行，避免伪共享
+ *
+ * @tparam T 元素类型
+ * @tparam N 容量，必须是2的整数次幂
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue 的容量必须是2的整数次幂");
+
+public:
+    SpscQueue()
+        : buf_(N) {
+    }
+
+    SpscQueue(const SpscQueue &)            = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    /**
+     * @brief 写入队尾，只能在生产者线程调用
+     *
+     * @return true 写入成功
+     * @return false 队列已满
+     */
+    bool push(const T &item) {
+        size_t tail = tail_.load(memory_order_relaxed);
+        if (tail - head_.load(memory_order_acquire) == N) {
+            return false;
+        }
+        buf_[tail & (N - 1)] = item;
+        tail_.store(tail + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 取出队首元素，只能在消费者线程调用
+     *
+     * @return true 取出成功
+     * @return false 队列为空
+     */
+    bool pop(T &item) {
+        size_t head = head_.load(memory_order_relaxed);
+        if (head == tail_.load(memory_order_acquire)) {
+            return false;
+        }
+        item = buf_[head & (N - 1)];
+        head_.store(head + 1, memory_order_release);
+        return true;
+    }
+
+    /// 预先写入整个缓冲区，使其内存页在使用前分配好，只能在第一次 push 之前由生产者线程调用
+    void prefault() {
+        for (T &item : buf_) {
+            item = T();
+        }
+    }
+
+    /// 队列是否为空，在生产者线程调用时结果可能已过时
+    bool empty() const {
+        return head_.load(memory_order_acquire) == tail_.load(memory_order_acquire);
+    }
+
+private:
+    alignas(64) atomic<size_t> head_{0}; // 消费者写入
+    alignas(64) atomic<size_t> tail_{0}; // 生产者写入
+    vector<T> buf_;
+};
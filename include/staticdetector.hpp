@@ -0,0 +1,103 @@
+#pragma once
+#include "imubuffer.hpp"
+#include "threadpool.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+// 一个静止时段及其粗对准结果
+typedef struct StaticInterval {
+    size_t first; // 第一个历元的索引
+    size_t last;  // 最后一个历元之后的索引
+    double start; // 第一个历元的时刻（周内秒）
+    double end;   // 最后一个历元的时刻（周内秒）
+    Vector3d att; // 解析粗对准的欧拉角，按[roll,pitch,yaw]顺序（rad），align 之前为0
+} StaticInterval;
+
+/**
+ * @brief 静止检测：角速度、比力模长在滑动窗口内的均值和方差
+ *
+ * 每个历元的判断只使用以该历元结尾的窗口（共 window·rate 个历元），窗口未满时不判为静止。
+ * 逐历元的 update 可以作为导航解算中的一级数据流处理，用于触发零速修正；
+ * detect 在按列存储的数据上一次计算所有历元的结果，与逐历元处理的判断相同。
+ * IMU数据为增量形式，按标称采样频率换算为角速度和比力
+ */
+class StaticDetector {
+public:
+    /**
+     * @brief 创建逐历元的检测器，之后不再分配内存
+     *
+     * @param options 静止检测参数
+     * @param rate IMU标称采样频率（Hz）
+     */
+    StaticDetector(const StaticOptions &options, int rate);
+
+    /**
+     * @brief 加入一个历元并判断是否静止
+     *
+     * @param imu IMU数据（增量形式）
+     * @return true 以该历元结尾的窗口为静止
+     */
+    bool update(const IMU &imu);
+
+    /// 最近一次 update 的判断结果
+    bool isStatic() const {
+        return static_;
+    }
+
+    /// 清空窗口
+    void reset();
+
+    /// 窗口在堆上占用的内存（字节）
+    size_t heapMemory() const {
+        return (gyr_.capacity() + acc_.capacity()) * sizeof(double);
+    }
+
+    /**
+     * @brief 在整段数据上判断每个历元是否静止
+     *
+     * 模长、窗口内的和与方差分别在连续数组上计算，便于编译器向量化
+     *
+     * @param [in] imudata IMU数据（增量形式）
+     * @param [in] options 静止检测参数
+     * @param [in] rate IMU标称采样频率（Hz）
+     * @param [out] flags 每个历元是否静止，与 imudata 等长
+     */
+    static void detect(const ImuView &imudata, const StaticOptions &options, int rate, vector<uint8_t> &flags);
+
+    /**
+     * @brief 找出所有时长不短于 options.mintime 的静止时段
+     *
+     * 连续判为静止的历元及其窗口组成一个静止时段，时段之间不重叠
+     *
+     * @return vector<StaticInterval> 按时间顺序排列的静止时段，姿态为0
+     */
+    static vector<StaticInterval> intervals(const ImuView &imudata, const StaticOptions &options, int rate);
+
+    /**
+     * @brief 在线程池中对每个静止时段做解析粗对准，见 getInitAtt
+     *
+     * @param [in] imudata 检测静止时段时使用的IMU数据
+     * @param [in,out] intervals 静止时段，输出各时段的粗对准结果
+     * @param [in] pool 线程池
+     */
+    static void align(const ImuView &imudata, vector<StaticInterval> &intervals, ThreadPool &pool);
+
+private:
+    // 比力模长减去该值后累加，减小平方和的舍入误差
+    static constexpr double ACC_OFFSET = 9.8;
+
+    /// 窗口内的和、平方和是否满足静止条件，逐历元和批量计算共用
+    bool test(double gyr_sum, double gyr_sum2, double acc_sum, double acc_sum2) const;
+
+    StaticOptions options_;
+    double rate_;
+    size_t window_; // 窗口内的历元数
+
+    vector<double> gyr_, acc_; // 窗口内的角速度模长、比力模长（减去 ACC_OFFSET），环形缓冲区
+    size_t head_  = 0;         // 下一个写入位置
+    size_t count_ = 0;         // 窗口内的历元数
+    double gyr_sum_ = 0, gyr_sum2_ = 0, acc_sum_ = 0, acc_sum2_ = 0;
+    bool static_ = false;
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include "threadpool.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// 参数扫描的取值范围：各组噪声参数相对于配置文件的倍数，只有一个值时该参数不变
+typedef struct SweepSpace {
+    vector<double> arw{1.0};      // 角度随机游走
+    vector<double> vrw{1.0};      // 速度随机游走
+    vector<double> gbstd{1.0};    // 陀螺零偏不稳定性
+    vector<double> abstd{1.0};    // 加速度计零偏不稳定性
+    vector<double> gsstd{1.0};    // 陀螺比例因子不稳定性
+    vector<double> asstd{1.0};    // 加速度计比例因子不稳定性
+    vector<double> corrtime{1.0}; // 相关时间
+} SweepSpace;
+
+// 一组噪声参数的评价结果
+typedef struct SweepResult {
+    ImuNoise imunoise; // 噪声参数
+    size_t epochs;     // 与参考轨迹比较的历元数
+    double pos_rms;    // 与参考轨迹的三维位置误差RMS（m），没有参考轨迹时为NaN
+    double pos_max;    // 与参考轨迹的三维位置误差最大值（m），没有参考轨迹时为NaN
+    size_t updates;    // GNSS量测更新次数
+    double nis;        // 平均每维的归一化新息平方，噪声参数与实际误差相符时约为1
+} SweepResult;
+
+/**
+ * @brief IMU噪声参数扫描：数据只读入一次，在线程池中用不同的噪声参数并行解算并评价
+ *
+ * IMU、GNSS数据和参考轨迹在构造时读入内存，之后只读，各线程共享同一份数据；
+ * 每个工作线程只持有一个 GIEngine 和误差统计，不输出结果文件。
+ * 解算流程与 GINS 后处理相同：只处理配置的 starttime、endtime 时段，以时段内第一个GNSS历元的位置、速度初始化，
+ * 从下一个GNSS历元开始量测更新。
+ * 初始状态的标准差取自配置文件，不随扫描的噪声参数变化
+ */
+class NoiseSweep {
+public:
+    /**
+     * @brief 读入数据
+     *
+     * @param options 松组合配置参数，使用其中的IMU、GNSS文件、转换因子和初始状态
+     * @param reffile 参考轨迹文件（result.txt 格式：周内秒、纬度、经度（deg）、高程……），为空时不计算位置误差
+     * @param skip 解算开始后跳过的时长（s），这段时间内的位置误差不参与统计
+     */
+    NoiseSweep(const GINSOptions &options, const string &reffile = "", double skip = 0);
+
+    /**
+     * @brief 直接使用内存中的数据
+     *
+     * @param options 松组合配置参数，使用其中的初始状态
+     * @param imudata IMU数据
+     * @param gnssdata GNSS数据，第一个历元用于初始化，与读取pos文件后的用法相同
+     * @param skip 解算开始后跳过的时长（s）
+     */
+    NoiseSweep(const GINSOptions &options, vector<IMU> imudata, vector<GNSS> gnssdata, double skip = 0);
+
+    /// 按时间顺序加入一个参考轨迹历元，位置为BLH（rad、rad、m）
+    void addReference(double time, const Vector3d &blh);
+
+    /// 数据是否读入成功
+    bool isOpen() const {
+        return open_;
+    }
+
+    /// 是否有参考轨迹
+    bool hasReference() const {
+        return !reference_.empty();
+    }
+
+    /// IMU历元数
+    size_t size() const {
+        return imudata_.size();
+    }
+
+    /**
+     * @brief 用一组噪声参数解算并评价，可以在多个线程中同时调用
+     *
+     * @param imunoise 噪声参数
+     * @return SweepResult 评价结果
+     */
+    SweepResult evaluate(const ImuNoise &imunoise) const;
+
+    /**
+     * @brief 在线程池中评价多组噪声参数
+     *
+     * @param configs 各组噪声参数
+     * @param pool 线程池
+     * @return vector<SweepResult> 与 configs 顺序相同的评价结果
+     */
+    vector<SweepResult> run(const vector<ImuNoise> &configs, ThreadPool &pool) const;
+
+    /// 取值范围内所有倍数组合（网格），base 为配置文件中的噪声参数
+    static vector<ImuNoise> grid(const ImuNoise &base, const SweepSpace &space);
+
+    /**
+     * @brief 在取值范围内随机抽样，每个参数的倍数在给定的最小值、最大值之间按对数均匀分布
+     *
+     * @param base 配置文件中的噪声参数
+     * @param space 取值范围
+     * @param count 抽样组数
+     * @param seed 随机数种子
+     */
+    static vector<ImuNoise> sample(const ImuNoise &base, const SweepSpace &space, size_t count, uint64_t seed);
+
+private:
+    // 参考轨迹的一个历元
+    typedef struct RefPoint {
+        double time;  // 周内秒
+        Vector3d xyz; // ECEF坐标（m）
+    } RefPoint;
+
+    /// 读取 result.txt 格式的参考轨迹
+    bool loadReference(const string &reffile);
+
+    /// 在参考轨迹中线性内插 time 时刻的ECEF坐标，超出参考轨迹时段时返回 false
+    bool reference(double time, Vector3d &xyz) const;
+
+    GINSOptions options_;
+    vector<IMU> imudata_;
+    vector<GNSS> gnssdata_;
+    vector<RefPoint> reference_;
+    double skip_;
+    bool open_ = false;
+};
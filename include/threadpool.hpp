@@ -0,0 +1,138 @@
+#pragma once
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 固定线程数的线程池
+ *
+ * 任务按提交顺序从共享队列中取出执行，submit 返回 future 用于获取结果，
+ * parallelFor 用于把一组相互独立的计算分给所有线程并等待完成。
+ * 不能在线程池自己的任务中调用 parallelFor：所有线程都在等待时，内层的任务永远不会被执行。
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief 创建线程池
+     *
+     * @param threads 线程数，为0时使用硬件并发线程数
+     */
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = max(1u, thread::hardware_concurrency());
+        }
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; i++) {
+            workers_.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// 线程数
+    size_t size() const {
+        return workers_.size();
+    }
+
+    /**
+     * @brief 提交一个任务
+     *
+     * @param task 无参数的可调用对象
+     * @return future 任务的返回值，任务抛出的异常也通过它传递
+     */
+    template <typename F>
+    auto submit(F &&task) -> future<invoke_result_t<F>> {
+        using R       = invoke_result_t<F>;
+        auto pack     = make_shared<packaged_task<R()>>(std::forward<F>(task));
+        future<R> res = pack->get_future();
+        {
+            lock_guard<mutex> lock(mutex_);
+            tasks_.emplace_back([pack]() { (*pack)(); });
+        }
+        cv_.notify_one();
+        return res;
+    }
+
+    /**
+     * @brief 对 [0, n) 中的每个 i 并行执行 fn(i)，全部完成后返回
+     *
+     * 某个任务抛出异常时，仍等待其余任务全部结束（fn 及其引用的数据在此之前一直有效），再抛出第一个异常。
+     * 不能嵌套调用：在本线程池的任务中调用会触发断言
+     *
+     * @param n 任务数
+     * @param fn 接收任务索引的可调用对象，不同索引之间不能有数据依赖
+     */
+    template <typename F>
+    void parallelFor(size_t n, F &&fn) {
+        assert(currentPool() != this && "ThreadPool::parallelFor 不能在同一线程池的任务中嵌套调用");
+        vector<future<void>> results;
+        results.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            results.emplace_back(submit([&fn, i]() { fn(i); }));
+        }
+        exception_ptr error;
+        for (auto &res : results) {
+            try {
+                res.get();
+            } catch (...) {
+                if (!error) {
+                    error = current_exception();
+                }
+            }
+        }
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+
+private:
+    /// 当前线程所属的线程池，不是工作线程时为 nullptr
+    static const ThreadPool *&currentPool() {
+        thread_local const ThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    void workerLoop() {
+        currentPool() = this;
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    vector<thread> workers_;
+    deque<function<void()>> tasks_;
+    mutex mutex_;
+    condition_variable cv_;
+    bool stop_ = false;
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 按时刻查找按时间排序的IMU、GNSS数据，内存中的数据和内存映射的文本文件都只需 O(log n)
+ *
+ * 与 GIEngine、DataCache 的时间索引相同，时刻为GPS周内秒，不处理跨GPS周的数据
+ */
+class TimeIndex {
+public:
+    /**
+     * @brief 第一条时刻不早于 time 的记录
+     *
+     * @param data 按时刻递增排列的记录（IMU、GNSS 等带 time 成员的类型）
+     * @return size_t 记录索引，所有记录都早于 time 时返回 data.size()
+     */
+    template <typename T>
+    static size_t lowerBound(const vector<T> &data, double time) {
+        return lower_bound(data.begin(), data.end(), time, [](const T &rec, double t) { return rec.time < t; }) -
+               data.begin();
+    }
+
+    /**
+     * @brief 时段 [start, end) 内记录的索引范围
+     *
+     * @return pair<size_t, size_t> 第一条和最后一条之后的记录索引，时段内没有记录时两者相等
+     */
+    template <typename T>
+    static pair<size_t, size_t> window(const vector<T> &data, double start, double end) {
+        size_t first = lowerBound(data, start);
+        return {first, max(first, lowerBound(data, end))};
+    }
+
+    /**
+     * @brief 在内存映射的文本数据中二分查找第一条时刻不早于 time 的记录所在的行
+     *
+     * 每次取区间中点之后的第一条完整记录比较时刻，区间缩小到几行后顺序查找，只访问 O(log n) 个文件页。
+     * 不能解析的行（文件头、其他报文）跳过
+     *
+     * @param first 数据区的起始位置，必须是行首
+     * @param last 数据区的结束位置
+     * @param parse 解析一行的函数 bool(const char *line, const char *line_end, double &time)
+     * @return const char* 记录的行首，所有记录都早于 time 时返回 last
+     */
+    template <typename Parse>
+    static const char *seekLine(const char *first, const char *last, double time, Parse &&parse) {
+        const char *lo = first, *hi = last;
+        double rectime;
+        // 不变式：lo 之前的记录都早于 time，所求记录的行首在 [lo, hi] 中
+        while (hi - lo > SCAN_BYTES) {
+            const char *mid  = lo + (hi - lo) / 2;
+            const char *line = lineStart(mid, hi);
+            const char *rec  = nextRecord(line, hi, parse, rectime);
+            if (rec == hi) {
+                hi = mid;
+            } else if (rectime < time) {
+                lo = nextLine(rec, hi);
+            } else {
+                hi = rec;
+            }
+        }
+        // lo 之后剩余的几行顺序查找，所求记录可能在 hi 之后的第一条记录
+        for (const char *rec = nextRecord(lo, last, parse, rectime); rec < last;
+             rec             = nextRecord(nextLine(rec, last), last, parse, rectime)) {
+            if (rectime >= time) {
+                return rec;
+            }
+        }
+        return last;
+    }
+
+    /**
+     * @brief pos 之前最后一条能解析的记录所在的行
+     *
+     * @param first 数据区的起始位置，必须是行首
+     * @param pos 行首
+     * @param [out] time 记录的时刻
+     * @return const char* 记录的行首，没有时返回 nullptr
+     */
+    template <typename Parse>
+    static const char *prevRecord(const char *first, const char *pos, Parse &&parse, double &time) {
+        while (pos > first) {
+            // 上一行的行首：跳过 pos 前的换行符后向前找到上一个换行符
+            const char *end  = pos - 1;
+            const char *line = end;
+            while (line > first && line[-1] != '\n') {
+                line--;
+            }
+            if (parse(line, end, time)) {
+                return line;
+            }
+            pos = line;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief pos 之前最后一个历元的第一条记录所在的行
+     *
+     * 同一历元（时刻相差小于1E-6）的重复记录顺序读取时只保留第一条，因此向前跳过与找到的记录同一历元的记录
+     *
+     * @param first 数据区的起始位置，必须是行首
+     * @param pos 行首
+     * @param [out] time 历元第一条记录的时刻
+     * @return const char* 记录的行首，没有时返回 nullptr
+     */
+    template <typename Parse>
+    static const char *prevEpoch(const char *first, const char *pos, Parse &&parse, double &time) {
+        const char *rec = prevRecord(first, pos, parse, time);
+        double duptime;
+        while (rec != nullptr) {
+            const char *dup = prevRecord(first, rec, parse, duptime);
+            if (dup == nullptr || abs(duptime - time) >= 1E-6) {
+                break;
+            }
+            rec  = dup;
+            time = duptime;
+        }
+        return rec;
+    }
+
+private:
+    static constexpr ptrdiff_t SCAN_BYTES = 4096; // 区间小于该字节数后顺序查找
+
+    /// pos 所在行的下一行行首，没有时返回 last
+    static const char *nextLine(const char *pos, const char *last) {
+        const char *nl = static_cast<const char *>(memchr(pos, '\n', last - pos));
+        return nl == nullptr ? last : nl + 1;
+    }
+
+    /// 不早于 pos 的第一个行首，pos 之前必须还有数据
+    static const char *lineStart(const char *pos, const char *last) {
+        return pos[-1] == '\n' ? pos : nextLine(pos, last);
+    }
+
+    /// 从行首 line 开始的第一条能解析的记录，没有时返回 last
+    template <typename Parse>
+    static const char *nextRecord(const char *line, const char *last, Parse &parse, double &time) {
+        while (line < last) {
+            const char *nl       = static_cast<const char *>(memchr(line, '\n', last - line));
+            const char *line_end = nl == nullptr ? last : nl;
+            if (parse(line, line_end, time)) {
+                return line;
+            }
+            line = nl == nullptr ? last : nl + 1;
+        }
+        return last;
+    }
+};
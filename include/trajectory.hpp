@@ -0,0 +1,152 @@
+#pragma once
+#include "mmapfile.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * @brief 二进制轨迹文件
+ *
+ * 文件由64字节的文件头、定长记录和稀疏时间索引组成。每条记录由 fields() 个小端 double 组成，
+ * 依次为 Field 中的各个量，角度均为弧度，不输出标准差的历元标准差为 NaN。
+ * 记录紧接在文件头之后，可以直接用 NumPy 内存映射：
+ *     np.memmap(path, dtype='<f8', mode='r', offset=64, shape=(count, fields))
+ * 其中 count、fields 分别位于文件头偏移16（uint64）和12（uint32）处。
+ * 文件写完后在记录之后追加时间索引（每 INDEX_STRIDE 条记录的时间），再回写文件头，
+ * 未正常关闭的文件记录数为0。
+ */
+class TrajectoryFile {
+public:
+    static constexpr uint32_t VERSION      = 1;    // 文件格式版本，格式变化时递增
+    static constexpr uint32_t INDEX_STRIDE = 1024; // 时间索引的采样间隔（记录数）
+
+    // 记录中各个量的位置，标准差只在 hasStd() 时存在
+    enum Field : uint32_t {
+        WEEK, TIME,                  // GPS周、周内秒
+        LAT, LON, HGT,               // BLH位置（rad、rad、m）
+        VN, VE, VD,                  // NED速度
+        ROLL, PITCH, YAW,            // 欧拉角（rad）
+        NAV_FIELDS,                  // 不含标准差的字段数
+        SDN = NAV_FIELDS, SDE, SDD,  // 位置标准差（NED，m）
+        SVN, SVE, SVD,               // 速度标准差（NED，m/s）
+        SROLL, SPITCH, SYAW,         // 姿态标准差（rad）
+        STD_FIELDS,                  // 含标准差的字段数
+    };
+
+    enum Flag : uint32_t {
+        HAS_STD = 1,                 // 记录中包含标准差
+    };
+
+    /// 文件头，所有偏移量均相对于文件起始位置
+    struct Header {
+        char magic[8];         // 固定为 "GINSTRAJ"
+        uint32_t version;      // 文件格式版本
+        uint32_t fields;       // 每条记录的 double 个数
+        uint64_t count;        // 记录数
+        uint32_t flags;        // Flag 的组合
+        uint32_t index_stride; // 时间索引的采样间隔
+        uint64_t index_count;  // 时间索引的条目数
+        uint64_t index_offset; // 时间索引的偏移
+        uint64_t reserved[2];  // 保留，填0
+    };
+    static_assert(sizeof(Header) == 64, "TrajectoryFile::Header 必须为64字节");
+
+    /**
+     * @brief 映射并校验轨迹文件
+     *
+     * @param [in] path 文件路径
+     * @return true 打开成功
+     * @return false 文件不存在、格式版本不符、未正常关闭或已损坏
+     */
+    bool open(const string &path);
+
+    /// 记录数
+    size_t size() const {
+        return header_ == nullptr ? 0 : header_->count;
+    }
+
+    /// 记录中是否包含标准差
+    bool hasStd() const {
+        return (header_->flags & HAS_STD) != 0;
+    }
+
+    /// 每条记录的 double 个数
+    size_t fields() const {
+        return header_->fields;
+    }
+
+    /// 第 i 条记录的周内秒
+    double time(size_t i) const {
+        return record(i)[TIME];
+    }
+
+    /// 第 i 条记录的首地址
+    const double *record(size_t i) const {
+        return records_ + i * header_->fields;
+    }
+
+    /// 读取第 i 条记录，标准差为 NaN 时 hasstd 为 false
+    NavResult get(size_t i) const;
+
+    /**
+     * @brief 利用稀疏时间索引二分查找第一条周内秒不小于 time 的记录
+     *
+     * @param [in] time 周内秒
+     * @return size_t 记录索引，所有记录都早于 time 时返回 size()
+     */
+    size_t lowerBound(double time) const;
+
+private:
+    MmapFile file_;
+    const Header *header_  = nullptr;
+    const double *records_ = nullptr;
+    const double *index_   = nullptr;
+};
+
+/**
+ * @brief 顺序写入二进制轨迹文件，格式见 TrajectoryFile
+ */
+class TrajectoryWriter {
+public:
+    TrajectoryWriter() = default;
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter &)            = delete;
+    TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+    /**
+     * @brief 创建轨迹文件并写入文件头
+     *
+     * @param path 文件路径
+     * @param withstd 记录中是否包含标准差
+     * @return true 创建成功
+     * @return false 创建失败
+     */
+    bool open(const string &path, bool withstd);
+
+    bool isOpen() const {
+        return ofs_.is_open();
+    }
+
+    /// 追加一条记录，result.time 必须单调不减
+    void write(const NavResult &result);
+
+    /**
+     * @brief 写入时间索引，回写文件头并关闭文件，析构时自动调用
+     *
+     * @return true 全部写入成功
+     * @return false 写入失败
+     */
+    bool close();
+
+private:
+    string path_;
+    fstream ofs_;
+    vector<char> buf_;     // 文件流的写缓冲区
+    vector<double> index_; // 每 INDEX_STRIDE 条记录的时间
+    uint32_t fields_ = 0;
+    uint64_t count_  = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Eigen/Dense"
+#include <string>
 using Eigen::Matrix3d;
 using Eigen::Quaterniond;
 using Eigen::Vector3d;
@@ -24,14 +25,6 @@ typedef struct IMU {
     double dt;       // IMU当前历元与前一历元的时间间隔
     Vector3d dtheta; // IMU当前历元输出的角度增量
     Vector3d dvel;   // IMU当前历元输出的速度增量
-
-    void operator=(const IMU &right){
-        week = right.week;
-        time = right.time;
-        dt = right.dt;
-        dtheta = right.dtheta;
-        dvel = right.dvel;
-    }
 } IMU;
 
 typedef struct Attitude {
@@ -59,6 +52,13 @@ typedef struct NavState {
     ImuError imuerror; // IMU传感器误差
 } NavState;
 
+// ASC格式IMU数据的转换因子和采样频率，随数据集（IMU型号）变化，由配置文件给出
+typedef struct ImuFormat {
+    double acc_scale = 1.5258789063E-06; // 速度增量的转换因子，原始数据乘以转换因子得到 m/s
+    double gry_scale = 1.0850694444E-07; // 角度增量的转换因子，原始数据乘以转换因子得到 rad
+    int freq         = 100;              // IMU采样频率（Hz），增量转换为加速度、角速度时使用
+} ImuFormat;
+
 typedef struct ImuNoise {
     Vector3d gyr_arw;      // 角度随机游走
     Vector3d acc_vrw;      // 速度随机游走
@@ -67,4 +67,53 @@ typedef struct ImuNoise {
     Vector3d gyrscale_std; // 陀螺比例因子不稳定性
     Vector3d accscale_std; // 加速度计比例因子不稳定性
     double corr_time;      // 相关时间
-} ImuNoise;
\ No newline at end of file
+} ImuNoise;
+
+// 静止检测参数：滑动窗口内角速度模长的均值、标准差和比力模长的标准差都低于阈值时判为静止
+typedef struct StaticOptions {
+    double window  = 1.0;   // 滑动窗口时长（s）
+    double gyrmean = 0.005; // 角速度模长均值的上限（rad/s）
+    double gyrstd  = 0.005; // 角速度模长标准差的上限（rad/s）
+    double accstd  = 0.2;   // 比力模长标准差的上限（m/s^2）
+    double mintime = 10.0;  // 用于粗对准的静止时段的最短时长（s）
+} StaticOptions;
+
+// 一个历元的导航结果，由滤波线程交给输出线程
+typedef struct NavResult {
+    int week;        // GPS周
+    double time;     // GPS周内秒
+    Vector3d blh;    // BLH位置（rad、rad、m）
+    Vector3d vel;    // NED速度
+    Vector3d euler;  // 欧拉角（rad）
+    Vector3d posstd; // 位置标准差（NED，m）
+    Vector3d velstd; // 速度标准差（NED，m/s）
+    Vector3d attstd; // 姿态标准差（rad）
+    bool hasstd;     // 标准差是否有效，只在输出标准差的历元为 true
+    bool gnss;       // 本历元是否进行了GNSS量测更新
+} NavResult;
+
+// GNSS/INS 松组合的配置参数，由 FileIO::loadOptions 从yaml配置文件读取，均已转换为国际单位
+typedef struct GINSOptions {
+    std::string imufile;    // IMU ASC格式数据文件路径
+    std::string gnssfile;   // GNSS定位结果pos文件路径
+    std::string outputpath; // 结果输出目录
+    ImuFormat imuformat;    // IMU数据的转换因子和采样频率
+    double starttime;       // 处理时段的开始时刻（周内秒），为0时从数据开始处理
+    double endtime;         // 处理时段的结束时刻（周内秒，不含），为0时处理到数据结束
+
+    NavState initstate;     // 初始状态，位置、速度由第一个GNSS历元确定
+    NavState initstate_std; // 初始状态标准差，位置为NED坐标系下的米
+    ImuNoise imunoise;      // IMU噪声参数
+    Vector3d antlever;      // GNSS天线杆臂，b系，单位m
+
+    bool zupt;                // 是否在检测到静止的历元进行零速修正
+    double zuptstd;           // 零速修正的速度量测标准差（m/s）
+    StaticOptions staticopts; // 静止检测参数
+
+    double gnssinterval; // GNSS量测更新的最小时间间隔（s），距上次更新不足该间隔的GNSS数据不使用，为0时全部使用
+    bool lazycov;        // 是否累积状态转移矩阵，只在需要协方差时传播协方差
+    double stdinterval;  // 输出标准差的时间间隔，单位s，为0时不输出
+    int decimation;      // 每隔几个IMU历元输出一次导航结果
+    bool gnssonly;       // 只在GNSS量测更新的历元输出导航结果
+    bool binaryoutput;   // 结果输出为二进制轨迹文件 result.traj，而不是文本文件
+} GINSOptions;
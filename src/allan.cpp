@@ -0,0 +1,141 @@
+#include "allan.hpp"
+#include "profiler.hpp"
+#include <cmath>
+#include <limits>
+
+AllanVariance::AllanVariance(const vector<IMU> &imudata, size_t start_idx, size_t end_idx) {
+    GINS_PROFILE_SCOPE("allan.prepare");
+    end_idx   = min(end_idx, imudata.size());
+    start_idx = min(start_idx, end_idx);
+    size_     = end_idx - start_idx;
+
+    for (size_t i = start_idx; i < end_idx; i++) {
+        for (int a = 0; a < 3; a++) {
+            mean_[a] += imudata[i].dvel[a];
+            mean_[a + 3] += imudata[i].dtheta[a];
+        }
+    }
+    for (auto &item : mean_) {
+        item /= max<size_t>(size_, 1);
+    }
+
+    // 补齐的两个通道始终为0
+    cumsum_.assign((size_ + 1) * LANES, 0.0);
+    for (size_t i = 0; i < size_; i++) {
+        const IMU &imu       = imudata[start_idx + i];
+        double sample[LANES] = {imu.dvel[0], imu.dvel[1], imu.dvel[2], imu.dtheta[0], imu.dtheta[1], imu.dtheta[2]};
+        const double *prev   = &cumsum_[i * LANES];
+        double *cur          = &cumsum_[(i + 1) * LANES];
+        for (int a = 0; a < AXES; a++) {
+            cur[a] = prev[a] + (sample[a] - mean_[a]);
+        }
+    }
+}
+
+AllanVariance::AxisValues AllanVariance::clusterMean(size_t first, size_t m) const {
+    AxisValues res;
+    const double *s0 = &cumsum_[first * LANES];
+    const double *s1 = &cumsum_[(first + m) * LANES];
+    for (int a = 0; a < AXES; a++) {
+        res[a] = (s1[a] - s0[a]) / m;
+    }
+    return res;
+}
+
+AllanVariance::AxisValues AllanVariance::accumulate(size_t m, size_t step, size_t terms) const {
+    // 相邻两簇均值之差 = (S[k+2m] - 2*S[k+m] + S[k]) / m，先累加分子的平方，最后统一除以 m^2
+    alignas(64) double acc[LANES] = {};
+    const double *sum             = cumsum_.data();
+    const size_t offset           = m * LANES;
+    for (size_t k = 0, first = 0; k < terms; k++, first += step * LANES) {
+        const double *s0 = sum + first;
+        const double *s1 = s0 + offset;
+        const double *s2 = s1 + offset;
+        for (int a = 0; a < LANES; a++) {
+            double diff = s2[a] - 2.0 * s1[a] + s0[a];
+            acc[a] += diff * diff;
+        }
+    }
+
+    AxisValues res;
+    double md = static_cast<double>(m);
+    for (int a = 0; a < AXES; a++) {
+        res[a] = sqrt(acc[a] / (2.0 * terms * md * md));
+    }
+    return res;
+}
+
+AllanVariance::AxisValues AllanVariance::deviation(size_t m, bool overlapping) const {
+    GINS_PROFILE_SCOPE("allan.deviation");
+    if (m == 0 || 2 * m > size_) {
+        AxisValues res;
+        res.fill(numeric_limits<double>::quiet_NaN());
+        return res;
+    }
+    // 完全重叠估计：簇起点逐样本滑动；非重叠估计：只使用前 K*m 个样本
+    return overlapping ? accumulate(m, 1, size_ - 2 * m + 1) : accumulate(m, m, size_ / m - 1);
+}
+
+vector<AllanVariance::AxisValues> AllanVariance::deviations(const vector<size_t> &clusters, bool overlapping,
+                                                            ThreadPool *pool) const {
+    return parallelMap(clusters.size(), pool, [&](size_t i) { return deviation(clusters[i], overlapping); });
+}
+
+vector<AllanVariance::AxisValues> AllanVariance::deviationsByBins(const vector<int> &bins, ThreadPool *pool) const {
+    return parallelMap(bins.size(), pool, [&](size_t i) { return deviationByBins(bins[i]); });
+}
+
+AllanVariance::AxisValues AllanVariance::deviationByBins(int bins) const {
+    GINS_PROFILE_SCOPE("allan.deviation");
+    size_t m = bins > 1 ? size_ / bins : 0;
+    if (m == 0) {
+        AxisValues res;
+        res.fill(numeric_limits<double>::quiet_NaN());
+        return res;
+    }
+
+    // 第 i 块为 [i*m, i*m+i) 与 [0, size-m) 的交集，块内的和由累积和加回均值得到
+    size_t limit = size_ - m;
+    auto blockMean = [&](size_t i, double *res) {
+        size_t first     = min(i * m, limit);
+        size_t last      = min(i * m + i, limit);
+        const double *s0 = &cumsum_[first * LANES];
+        const double *s1 = &cumsum_[last * LANES];
+        for (int a = 0; a < AXES; a++) {
+            res[a] = (s1[a] - s0[a] + (last - first) * mean_[a]) / m;
+        }
+    };
+    double prev[LANES], cur[LANES], acc[LANES] = {};
+    blockMean(0, prev);
+    for (int i = 1; i < bins; i++) {
+        blockMean(i, cur);
+        for (int a = 0; a < AXES; a++) {
+            double diff = cur[a] - prev[a];
+            acc[a] += diff * diff;
+            prev[a] = cur[a];
+        }
+    }
+
+    AxisValues res;
+    for (int a = 0; a < AXES; a++) {
+        res[a] = sqrt(acc[a] / (2.0 * (bins - 1)));
+    }
+    return res;
+}
+
+vector<size_t> AllanVariance::logSpacedClusters(size_t max_m, int points_per_decade) {
+    vector<size_t> clusters;
+    if (max_m == 0 || points_per_decade <= 0) {
+        return clusters;
+    }
+    double decades = log10(static_cast<double>(max_m));
+    int points     = static_cast<int>(ceil(decades * points_per_decade));
+    for (int i = 0; i <= points; i++) {
+        size_t m = static_cast<size_t>(llround(pow(10.0, decades * i / max(points, 1))));
+        m        = min(max<size_t>(m, 1), max_m);
+        if (clusters.empty() || m > clusters.back()) {
+            clusters.push_back(m);
+        }
+    }
+    return clusters;
+}
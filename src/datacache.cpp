@@ -0,0 +1,251 @@
+#include "datacache.hpp"
+#include "fileio.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+namespace {
+constexpr char CACHE_MAGIC[8] = {'G', 'I', 'N', 'S', 'C', 'A', 'C', 'H'};
+constexpr uint64_t ALIGNMENT  = 64;
+
+inline uint64_t alignUp(uint64_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/**
+ * @brief 按列写出缓存文件：第0列为int32的周，其余各列为double
+ *
+ * @param cachefile 缓存文件路径
+ * @param type 数据类型
+ * @param count 记录数
+ * @param columns 总列数（含周）
+ * @param format IMU数据的转换因子和采样频率，写入文件头
+ * @param week 取第 i 条记录的周
+ * @param value 取第 i 条记录第 c 列的值（c >= 1，第1列必须是周内秒）
+ */
+bool writeColumns(const string &cachefile, DataCache::Type type, size_t count, uint32_t columns,
+                  const ImuFormat &format, const function<int32_t(size_t)> &week,
+                  const function<double(size_t, uint32_t)> &value) {
+    DataCache::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version      = DataCache::VERSION;
+    header.type         = type;
+    header.count        = count;
+    header.acc_scale    = format.acc_scale;
+    header.gry_scale    = format.gry_scale;
+    header.freq         = format.freq;
+    header.columns      = columns;
+    header.index_stride = DataCache::INDEX_STRIDE;
+    header.index_count  = (count + DataCache::INDEX_STRIDE - 1) / DataCache::INDEX_STRIDE;
+
+    uint64_t offset = alignUp(sizeof(header));
+    for (uint32_t c = 0; c < columns; c++) {
+        header.column_offset[c] = offset;
+        offset                  = alignUp(offset + count * (c == 0 ? sizeof(int32_t) : sizeof(double)));
+    }
+    header.index_offset = offset;
+
+    // 先写入临时文件，完成后再改名，避免其他进程读到写了一半的缓存
+    string tmpfile = cachefile + ".tmp";
+    fstream ofs(tmpfile, ios::out | ios::binary | ios::trunc);
+    if (!ofs.is_open()) {
+        cerr << "缓存文件：" << tmpfile << " 创建失败！" << endl;
+        return false;
+    }
+    auto pad = [&ofs]() {
+        static const char zeros[ALIGNMENT] = {};
+        ofs.write(zeros, alignUp(ofs.tellp()) - static_cast<uint64_t>(ofs.tellp()));
+    };
+
+    vector<char> buf(1 << 20);
+    ofs.rdbuf()->pubsetbuf(buf.data(), buf.size());
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    pad();
+    for (size_t i = 0; i < count; i++) {
+        int32_t w = week(i);
+        ofs.write(reinterpret_cast<const char *>(&w), sizeof(w));
+    }
+    pad();
+    for (uint32_t c = 1; c < columns; c++) {
+        for (size_t i = 0; i < count; i++) {
+            double v = value(i, c);
+            ofs.write(reinterpret_cast<const char *>(&v), sizeof(v));
+        }
+        pad();
+    }
+    for (size_t i = 0; i < count; i += DataCache::INDEX_STRIDE) {
+        double t = value(i, 1);
+        ofs.write(reinterpret_cast<const char *>(&t), sizeof(t));
+    }
+    ofs.close();
+    if (!ofs) {
+        cerr << "缓存文件：" << tmpfile << " 写入失败！" << endl;
+        filesystem::remove(tmpfile);
+        return false;
+    }
+
+    error_code ec;
+    filesystem::rename(tmpfile, cachefile, ec);
+    if (ec) {
+        cerr << "缓存文件：" << cachefile << " 写入失败：" << ec.message() << endl;
+        filesystem::remove(tmpfile);
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+string DataCache::cachePath(const string &srcfile) {
+    return srcfile + ".gcache";
+}
+
+bool DataCache::writeIMU(const string &cachefile, const vector<IMU> &imu_data, const ImuFormat &format) {
+    // 列：周、周内秒、dt、角度增量xyz、速度增量xyz（原始计数）
+    return writeColumns(
+        cachefile, IMU_DATA, imu_data.size(), 9, format, [&](size_t i) { return imu_data[i].week; },
+        [&](size_t i, uint32_t c) {
+            const IMU &imu = imu_data[i];
+            switch (c) {
+                case 1:
+                    return imu.time;
+                case 2:
+                    return imu.dt;
+                case 3:
+                case 4:
+                case 5:
+                    return imu.dtheta[c - 3];
+                default:
+                    return imu.dvel[c - 6];
+            }
+        });
+}
+
+bool DataCache::writeGNSS(const string &cachefile, const vector<GNSS> &gnss_data) {
+    // 列：周、周内秒、BLH、位置标准差、NED速度、速度标准差
+    return writeColumns(
+        cachefile, GNSS_DATA, gnss_data.size(), 14, ImuFormat(), [&](size_t i) { return gnss_data[i].week; },
+        [&](size_t i, uint32_t c) {
+            const GNSS &gnss = gnss_data[i];
+            if (c == 1) {
+                return gnss.time;
+            } else if (c < 5) {
+                return gnss.blh[c - 2];
+            } else if (c < 8) {
+                return gnss.posstd[c - 5];
+            } else if (c < 11) {
+                return gnss.vel[c - 8];
+            }
+            return gnss.velstd[c - 11];
+        });
+}
+
+bool DataCache::convert(const string &srcfile, const ImuFormat &format) {
+    string cachefile = cachePath(srcfile);
+    string suffix    = srcfile.substr(srcfile.find_last_of(".") + 1, 3);
+
+    // 删除旧缓存，确保读取的是源文件
+    filesystem::remove(cachefile);
+    if (suffix == "ASC") {
+        // 转换因子取1，得到调整轴系后的原始计数
+        ImuFormat counts = format;
+        counts.acc_scale = 1;
+        counts.gry_scale = 1;
+        vector<IMU> imu_data;
+        return FileIO::getIMUdataMmap(srcfile, imu_data, true, counts) && writeIMU(cachefile, imu_data, format);
+    } else if (suffix == "pos") {
+        vector<GNSS> gnss_data;
+        return FileIO::getGNSSdata(srcfile, gnss_data) && writeGNSS(cachefile, gnss_data);
+    }
+    cerr << "文件名：" << srcfile << " 错误，目前只处理ASC格式和pos格式数据！" << endl;
+    return false;
+}
+
+bool DataCache::openFresh(const string &srcfile, Type type, const ImuFormat &format) {
+    string cachefile = cachePath(srcfile);
+    error_code ec;
+    auto cache_time = filesystem::last_write_time(cachefile, ec);
+    if (ec) {
+        return false;
+    }
+    auto src_time = filesystem::last_write_time(srcfile, ec);
+    if (ec || cache_time < src_time || !open(cachefile, type)) {
+        return false;
+    }
+    // 转换因子或采样频率变化后，缓存中的数值不再有效
+    if (type == IMU_DATA && (header_->acc_scale != format.acc_scale || header_->gry_scale != format.gry_scale ||
+                             header_->freq != format.freq)) {
+        file_.close();
+        header_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool DataCache::open(const string &cachefile, Type type) {
+    header_ = nullptr;
+    if (!file_.open(cachefile) || file_.size() < sizeof(Header)) {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(file_.data());
+    uint32_t columns     = type == IMU_DATA ? 9 : 14;
+    if (memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header->version != VERSION ||
+        header->type != type || header->columns != columns || header->index_stride != INDEX_STRIDE ||
+        header->index_offset + header->index_count * sizeof(double) > file_.size()) {
+        file_.close();
+        return false;
+    }
+    header_ = header;
+    week_   = reinterpret_cast<const int32_t *>(file_.data() + header_->column_offset[0]);
+    time_   = column(1);
+    index_  = reinterpret_cast<const double *>(file_.data() + header_->index_offset);
+    return true;
+}
+
+void DataCache::getIMU(size_t i, IMU &imu, bool is_imu_increment) const {
+    // 与 FileIO::parseIMUline 的运算顺序相同
+    getCounts(i, imu);
+    imu.dvel *= header_->acc_scale;
+    imu.dtheta *= header_->gry_scale;
+    if (!is_imu_increment) {
+        imu.dvel *= header_->freq;   // 转换为加速度
+        imu.dtheta *= header_->freq; // 转换为角速度
+    }
+}
+
+void DataCache::getCounts(size_t i, IMU &imu) const {
+    imu.week = week_[i];
+    imu.time = time_[i];
+    imu.dt   = column(2)[i];
+    imu.dtheta << column(3)[i], column(4)[i], column(5)[i];
+    imu.dvel << column(6)[i], column(7)[i], column(8)[i];
+}
+
+void DataCache::getGNSS(size_t i, GNSS &gnss) const {
+    gnss.week = week_[i];
+    gnss.time = time_[i];
+    gnss.blh << column(2)[i], column(3)[i], column(4)[i];
+    gnss.posstd << column(5)[i], column(6)[i], column(7)[i];
+    gnss.vel << column(8)[i], column(9)[i], column(10)[i];
+    gnss.velstd << column(11)[i], column(12)[i], column(13)[i];
+    gnss.isvalid = true;
+}
+
+size_t DataCache::lowerBound(double time) const {
+    // 先在稀疏索引中确定所在的块，再在块内二分查找；所求记录在索引第 block 条之前的一个块内或就是该条，
+    // 与 TrajectoryFile::lowerBound 相同
+    size_t n     = size();
+    size_t block = lower_bound(index_, index_ + header_->index_count, time) - index_;
+    size_t first = block == 0 ? 0 : (block - 1) * INDEX_STRIDE;
+    size_t last  = min(n, block * INDEX_STRIDE);
+    return lower_bound(time_ + first, time_ + last, time) - time_;
+}
+
+void DataCache::releaseBefore(size_t count) const {
+    for (uint32_t c = 0; c < header_->columns; c++) {
+        file_.release(header_->column_offset[c], count * (c == 0 ? sizeof(int32_t) : sizeof(double)));
+    }
+}
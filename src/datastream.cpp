@@ -0,0 +1,265 @@
+#include "datastream.hpp"
+#include "fileio.hpp"
+#include "profiler.hpp"
+#include "timeindex.hpp"
+#include <cstring>
+#include <iostream>
+
+namespace {
+// 每消费这么多字节的文件数据，就把已读区域的物理页归还给内核一次
+constexpr size_t RELEASE_STEP = 16 << 20;
+
+/// 取出 [first, last) 中的下一行，返回下一行的起始位置
+inline const char *nextLine(const char *first, const char *last, const char *&line_end) {
+    const char *nl = static_cast<const char *>(memchr(first, '\n', last - first));
+    line_end       = nl == nullptr ? last : nl;
+    return nl == nullptr ? last : nl + 1;
+}
+} // namespace
+
+bool IMUStream::open(const string &imufile, bool is_imu_increment, const ImuFormat &format) {
+    if (imufile.substr(imufile.find_last_of(".") + 1, 3) != "ASC") {
+        cerr << "文件名：" << imufile << " 错误，目前只处理ASC格式数据！" << endl;
+        return false;
+    }
+    is_imu_increment_ = is_imu_increment;
+    format_           = format;
+    released_         = 0;
+    cache_idx_        = 0;
+    end_time_         = 1E300;
+    buffer_.clear();
+    from_cache_ = cache_.openFresh(imufile, DataCache::IMU_DATA, format_);
+    if (from_cache_) {
+        return true;
+    }
+    if (!file_.open(imufile)) {
+        cerr << "文件：" << imufile << " 打开失败！" << endl;
+        return false;
+    }
+    file_.adviseSequential();
+
+    // 第一条完整记录只用于确定起始周内秒，与 FileIO::getIMUdata 保持一致
+    const char *end = file_.end(), *line_end;
+    IMU imu;
+    cur_ = file_.begin();
+    while (cur_ < end) {
+        const char *line = cur_;
+        cur_             = nextLine(cur_, end, line_end);
+        if (FileIO::parseIMUline(line, line_end, imu, is_imu_increment_, format_)) {
+            wsec_ = imu.time;
+            break;
+        }
+    }
+    data_       = cur_;
+    first_wsec_ = wsec_;
+    return true;
+}
+
+void IMUStream::refill() {
+    GINS_PROFILE_SCOPE("parse.imu");
+    if (from_cache_) {
+        IMU imu;
+        while (!buffer_.full() && cache_idx_ < cache_.size()) {
+            cache_.getIMU(cache_idx_++, imu, is_imu_increment_);
+            buffer_.push(imu);
+        }
+        if (cache_idx_ - released_ >= RELEASE_STEP / sizeof(double)) {
+            cache_.releaseBefore(cache_idx_);
+            released_ = cache_idx_;
+        }
+        return;
+    }
+
+    const char *end = file_.end(), *line_end;
+    IMU imu;
+    while (!buffer_.full() && cur_ < end) {
+        const char *line = cur_;
+        cur_             = nextLine(cur_, end, line_end);
+        if (!FileIO::parseIMUline(line, line_end, imu, is_imu_increment_, format_)) {
+            continue;
+        }
+        // 可能会出现一个历元多次采样的问题
+        if (abs(imu.time - wsec_) < 1E-6) {
+            continue;
+        }
+        imu.dt = imu.time - wsec_;
+        wsec_  = imu.time;
+        buffer_.push(imu);
+    }
+
+    size_t consumed = cur_ - file_.begin();
+    if (consumed - released_ >= RELEASE_STEP) {
+        file_.releaseBefore(consumed);
+        released_ = consumed;
+    }
+}
+
+bool IMUStream::next(IMU &imu) {
+    if (peek() == nullptr) {
+        return false;
+    }
+    imu = buffer_.front();
+    buffer_.pop();
+    return true;
+}
+
+const IMU *IMUStream::peek() {
+    if (buffer_.empty()) {
+        refill();
+    }
+    return buffer_.empty() || buffer_.front().time >= end_time_ ? nullptr : &buffer_.front();
+}
+
+bool IMUStream::seek(double time, size_t before) {
+    GINS_PROFILE_SCOPE("seek.imu");
+    buffer_.clear();
+    if (from_cache_) {
+        size_t idx = cache_.lowerBound(time);
+        cache_idx_ = idx > before ? idx - before : 0;
+        released_  = cache_idx_;
+        return peek() != nullptr;
+    }
+
+    IMU imu;
+    auto parse = [&](const char *line, const char *line_end, double &rectime) {
+        bool ok = FileIO::parseIMUline(line, line_end, imu, is_imu_increment_, format_);
+        rectime = imu.time;
+        return ok;
+    };
+    // 与起始记录同一历元的重复记录不会被读出，不计入向前退的记录
+    auto prevEpoch = [&](const char *pos, double &rectime) {
+        const char *prev = TimeIndex::prevEpoch(data_, pos, parse, rectime);
+        return prev != nullptr && abs(rectime - first_wsec_) < 1E-6 ? nullptr : prev;
+    };
+    const char *pos = TimeIndex::seekLine(data_, file_.end(), time, parse);
+    double rectime;
+    for (size_t i = 0; i < before; i++) {
+        const char *prev = prevEpoch(pos, rectime);
+        if (prev == nullptr) {
+            break;
+        }
+        pos = prev;
+    }
+    // 定位后第一条记录的 dt 由它之前的一条记录确定
+    const char *prev = prevEpoch(pos, rectime);
+    cur_             = pos;
+    wsec_            = prev == nullptr ? first_wsec_ : rectime;
+    released_        = cur_ - file_.begin();
+    return peek() != nullptr;
+}
+
+bool GNSSStream::open(const string &gnssfile) {
+    if (gnssfile.substr(gnssfile.find_last_of(".") + 1, 3) != "pos") {
+        cerr << "文件名：" << gnssfile << " 错误，目前只处理pos格式数据！" << endl;
+        return false;
+    }
+    buffer_.clear();
+    cache_idx_  = 0;
+    end_time_   = 1E300;
+    from_cache_ = cache_.openFresh(gnssfile, DataCache::GNSS_DATA);
+    if (from_cache_) {
+        return true;
+    }
+    if (!file_.open(gnssfile)) {
+        cerr << "文件：" << gnssfile << " 打开失败！" << endl;
+        return false;
+    }
+
+    // 跳过前两行的文件头，第一条记录只用于确定起始周内秒，与 FileIO::getGNSSdata 保持一致
+    const char *end = file_.end(), *line_end;
+    cur_            = file_.begin();
+    for (int i = 0; i < 2 && cur_ < end; i++) {
+        cur_ = nextLine(cur_, end, line_end);
+    }
+    GNSS gnss;
+    while (cur_ < end) {
+        const char *line = cur_;
+        cur_             = nextLine(cur_, end, line_end);
+        if (FileIO::parseGNSSline(line, line_end, gnss)) {
+            wsec_ = gnss.time;
+            break;
+        }
+    }
+    data_       = cur_;
+    first_wsec_ = wsec_;
+    return true;
+}
+
+void GNSSStream::refill() {
+    GINS_PROFILE_SCOPE("parse.gnss");
+    if (from_cache_) {
+        GNSS gnss;
+        while (!buffer_.full() && cache_idx_ < cache_.size()) {
+            cache_.getGNSS(cache_idx_++, gnss);
+            buffer_.push(gnss);
+        }
+        return;
+    }
+
+    const char *end = file_.end(), *line_end;
+    GNSS gnss;
+    while (!buffer_.full() && cur_ < end) {
+        const char *line = cur_;
+        cur_             = nextLine(cur_, end, line_end);
+        if (!FileIO::parseGNSSline(line, line_end, gnss)) {
+            continue;
+        }
+        // 可能会出现一个历元多次采样的问题
+        if (abs(gnss.time - wsec_) < 1E-6) {
+            continue;
+        }
+        wsec_ = gnss.time;
+        buffer_.push(gnss);
+    }
+}
+
+bool GNSSStream::next(GNSS &gnss) {
+    if (peek() == nullptr) {
+        return false;
+    }
+    gnss = buffer_.front();
+    buffer_.pop();
+    return true;
+}
+
+const GNSS *GNSSStream::peek() {
+    if (buffer_.empty()) {
+        refill();
+    }
+    return buffer_.empty() || buffer_.front().time >= end_time_ ? nullptr : &buffer_.front();
+}
+
+bool GNSSStream::seek(double time, size_t before) {
+    GINS_PROFILE_SCOPE("seek.gnss");
+    buffer_.clear();
+    if (from_cache_) {
+        size_t idx = cache_.lowerBound(time);
+        cache_idx_ = idx > before ? idx - before : 0;
+        return peek() != nullptr;
+    }
+
+    GNSS gnss;
+    auto parse = [&](const char *line, const char *line_end, double &rectime) {
+        bool ok = FileIO::parseGNSSline(line, line_end, gnss);
+        rectime = gnss.time;
+        return ok;
+    };
+    // 与起始记录同一历元的重复记录不会被读出，不计入向前退的记录
+    auto prevEpoch = [&](const char *pos, double &rectime) {
+        const char *prev = TimeIndex::prevEpoch(data_, pos, parse, rectime);
+        return prev != nullptr && abs(rectime - first_wsec_) < 1E-6 ? nullptr : prev;
+    };
+    const char *pos = TimeIndex::seekLine(data_, file_.end(), time, parse);
+    double rectime;
+    for (size_t i = 0; i < before; i++) {
+        const char *prev = prevEpoch(pos, rectime);
+        if (prev == nullptr) {
+            break;
+        }
+        pos = prev;
+    }
+    const char *prev = prevEpoch(pos, rectime);
+    cur_             = pos;
+    wsec_            = prev == nullptr ? first_wsec_ : rectime;
+    return peek() != nullptr;
+}
@@ -0,0 +1,49 @@
+#include "driver.hpp"
+#include "profiler.hpp"
+
+namespace {
+template <typename Filter>
+size_t runFilter(Filter &filter, const IMU &imupre, const FilterDriver::ImuSource &imu_source,
+                 const FilterDriver::GnssSource &gnss_source, const FilterDriver::EpochCallback &epoch) {
+    GINS_PROFILE_SCOPE("filter");
+    GNSS gnss;
+    filter.addImuData(imupre);
+    bool has_gnss = gnss_source(gnss);
+    if (has_gnss) {
+        filter.addGnssData(gnss);
+    }
+
+    IMU imucur; // k 时刻IMU输出数据
+    size_t epochs = 0;
+    while (imu_source(imucur)) {
+        if (imucur.dvel.norm() < 1E-10 || imucur.dtheta.norm() < 1E-10) {
+            continue;
+        }
+        epochs++;
+        filter.addImuData(imucur);
+        filter.newImuProcess();
+
+        // 当前GNSS数据已用于更新（或早于当前历元）时，加入下一个GNSS数据
+        while (has_gnss && gnss.time <= imucur.time) {
+            has_gnss = gnss_source(gnss);
+            if (has_gnss) {
+                filter.addGnssData(gnss);
+            }
+        }
+        if (epoch) {
+            epoch(imucur);
+        }
+    }
+    return epochs;
+}
+} // namespace
+
+size_t FilterDriver::run(GIEngine &engine, const IMU &imupre, const ImuSource &imu, const GnssSource &gnss,
+                         const EpochCallback &epoch) {
+    return runFilter(engine, imupre, imu, gnss, epoch);
+}
+
+size_t FilterDriver::run(RTSSmoother &smoother, const IMU &imupre, const ImuSource &imu, const GnssSource &gnss,
+                         const EpochCallback &epoch) {
+    return runFilter(smoother, imupre, imu, gnss, epoch);
+}
@@ -1,19 +1,44 @@
 #include "fileio.hpp"
+#include "datacache.hpp"
+#include "mmapfile.hpp"
+#include "profiler.hpp"
+#include "threadpool.hpp"
 #include <absl/strings/str_split.h>
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <yaml-cpp/yaml.h>
 
 // #define FileIODebug
 
-double FileIO::acc_scale = 1.5258789063E-06;
-double FileIO::gry_scale = 1.0850694444E-07;
-int FileIO::freq         = 100;
+namespace {
+/// 源文件有可用的二进制缓存时直接从缓存读取IMU数据
+bool loadIMUcache(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment, const ImuFormat &format) {
+    DataCache cache;
+    if (!cache.openFresh(imufile, DataCache::IMU_DATA, format)) {
+        return false;
+    }
+    size_t offset = imu_data.size();
+    imu_data.resize(offset + cache.size());
+    for (size_t i = 0; i < cache.size(); i++) {
+        cache.getIMU(i, imu_data[offset + i], is_imu_increment);
+    }
+    return true;
+}
+} // namespace
 
-bool FileIO::getIMUdata(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment) {
+bool FileIO::getIMUdata(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment,
+                        const ImuFormat &format) {
+    GINS_PROFILE_SCOPE("fileio.imu");
     if (imufile.substr(imufile.find_last_of(".") + 1, 3) != "ASC") {
         cerr << "文件名：" << imufile << " 错误，目前只处理ASC格式数据！" << endl;
         return false;
     }
+    if (loadIMUcache(imufile, imu_data, is_imu_increment, format)) {
+        return true;
+    }
     fstream ifs(imufile, ios::in);
     if (!ifs.is_open()) {
         cerr << "文件：" << imufile << " 打开失败！" << endl;
@@ -51,26 +76,312 @@ bool FileIO::getIMUdata(const string &imufile, vector<IMU> &imu_data, bool is_im
 
         // 此处经过了轴系调整
         imu.dvel << -stod(splits[7]), stod(splits[8]), -stod(splits[6]);
-        imu.dvel *= acc_scale; // 此时imu.dvel的值是速度增量
+        imu.dvel *= format.acc_scale; // 此时imu.dvel的值是速度增量
 
         imu.dtheta << -stod(splits[10]), stod(splits[11]), -stod(splits[9]);
-        imu.dtheta *= gry_scale; // 此时的imu.dtheta的值角度增量
+        imu.dtheta *= format.gry_scale; // 此时的imu.dtheta的值角度增量
 
         if (!is_imu_increment) {
-            imu.dvel *= freq;   // 转换为加速度
-            imu.dtheta *= freq; // 转换为角速度
+            imu.dvel *= format.freq;   // 转换为加速度
+            imu.dtheta *= format.freq; // 转换为角速度
+        }
+
+        imu_data.emplace_back(imu);
+    }
+    return true;
+}
+
+namespace {
+/// ASC记录的分隔符，与 getIMUdata 中先把 ';' 和 '*' 替换为 ',' 再切分的做法等价
+inline bool isASCdelim(char c) {
+    return c == ',' || c == ';' || c == '*';
+}
+
+/// 解析 [first, last) 区间的浮点数，跳过前导空白，与 stod 的行为保持一致
+inline bool parseDouble(const char *first, const char *last, double &value) {
+    while (first < last && (*first == ' ' || *first == '\t')) {
+        first++;
+    }
+    return std::from_chars(first, last, value).ec == std::errc();
+}
+
+/// 取出 [first, last) 中的下一行，返回下一行的起始位置
+inline const char *nextLine(const char *first, const char *last, const char *&line_end) {
+    const char *nl = static_cast<const char *>(memchr(first, '\n', last - first));
+    line_end       = nl == nullptr ? last : nl;
+    return nl == nullptr ? last : nl + 1;
+}
+} // namespace
+
+bool FileIO::parseIMUline(const char *first, const char *last, IMU &imu, bool is_imu_increment,
+                          const ImuFormat &format) {
+    // 需要的字段：3-周，4-周内秒，6~8-加速度计，9~11-陀螺仪
+    double fields[12];
+    int idx = 0;
+    while (first < last && idx < 12) {
+        const char *tok = first;
+        while (first < last && !isASCdelim(*first)) {
+            first++;
+        }
+        const char *tok_end = first;
+        if (first < last) {
+            first++; // 跳过分隔符
+        }
+
+        // 与 absl::SkipWhitespace 一致，空字段不计数
+        const char *p = tok;
+        while (p < tok_end && isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p == tok_end) {
+            continue;
+        }
+        if ((idx == 3 || idx == 4 || idx >= 6) && !parseDouble(tok, tok_end, fields[idx])) {
+            return false;
+        }
+        idx++;
+    }
+    if (idx < 12) {
+        return false;
+    }
+
+    imu.week = fields[3];
+    imu.time = fields[4];
+
+    // 此处经过了轴系调整
+    imu.dvel << -fields[7], fields[8], -fields[6];
+    imu.dvel *= format.acc_scale; // 此时imu.dvel的值是速度增量
+
+    imu.dtheta << -fields[10], fields[11], -fields[9];
+    imu.dtheta *= format.gry_scale; // 此时的imu.dtheta的值角度增量
+
+    if (!is_imu_increment) {
+        imu.dvel *= format.freq;   // 转换为加速度
+        imu.dtheta *= format.freq; // 转换为角速度
+    }
+    return true;
+}
+
+bool FileIO::parseGNSSline(const char *first, const char *last, GNSS &gnss) {
+    // pos文件以空格分隔，共14个字段
+    double fields[14];
+    int idx = 0;
+    while (first < last && idx < 14) {
+        const char *tok = first;
+        while (first < last && *first != ' ') {
+            first++;
+        }
+        const char *tok_end = first;
+        if (first < last) {
+            first++;
         }
 
+        const char *p = tok;
+        while (p < tok_end && isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p == tok_end) {
+            continue;
+        }
+        if (!parseDouble(tok, tok_end, fields[idx])) {
+            return false;
+        }
+        idx++;
+    }
+    if (idx < 14) {
+        return false;
+    }
+
+    gnss.week = fields[0];
+    gnss.time = fields[1];
+    gnss.blh << fields[2] * D2R, fields[3] * D2R, fields[4]; // BLH位置（rad）
+    gnss.posstd << fields[5], fields[6], fields[7];          // NED位置标准差（m）
+    gnss.vel << fields[8], fields[9], -fields[10];           // NED速度（m/s）
+    gnss.velstd << fields[11], fields[12], fields[13];       // NED速度标准差（m/s）
+    gnss.isvalid = true;
+    return true;
+}
+
+bool FileIO::getIMUdataMmap(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment,
+                            const ImuFormat &format) {
+    GINS_PROFILE_SCOPE("fileio.imu.mmap");
+    if (imufile.substr(imufile.find_last_of(".") + 1, 3) != "ASC") {
+        cerr << "文件名：" << imufile << " 错误，目前只处理ASC格式数据！" << endl;
+        return false;
+    }
+    if (loadIMUcache(imufile, imu_data, is_imu_increment, format)) {
+        return true;
+    }
+    MmapFile file;
+    if (!file.open(imufile)) {
+        cerr << "文件：" << imufile << " 打开失败！" << endl;
+        return false;
+    }
+    file.adviseSequential();
+
+    const char *cur = file.begin(), *end = file.end(), *line_end;
+    IMU imu;
+
+    // 第一条完整记录只用于确定起始周内秒
+    bool has_first = false;
+    while (cur < end && !has_first) {
+        const char *line = cur;
+        cur              = nextLine(cur, end, line_end);
+        has_first        = parseIMUline(line, line_end, imu, is_imu_increment, format);
+    }
+    if (!has_first) {
+        return true;
+    }
+    double wsec = imu.time; // IMU周内秒
+
+    // 按平均行长预估记录数，避免 vector 反复扩容
+    imu_data.reserve(imu_data.size() + file.size() / max<ptrdiff_t>(cur - file.begin(), 1));
+    while (cur < end) {
+        const char *line = cur;
+        cur              = nextLine(cur, end, line_end);
+        if (!parseIMUline(line, line_end, imu, is_imu_increment, format)) {
+            continue;
+        }
+
+        // 可能会出现一个历元多次采样的问题
+        if (abs(imu.time - wsec) < 1E-6) {
+#ifdef FileIODebug
+            cout.flags(ios::fixed);
+            cout.precision(6);
+            cout << "IMU 重复历元，上一历元的time：" << wsec << ",\t" << "当前历元的time：" << imu.time << endl;
+#endif
+            continue;
+        }
+        imu.dt = imu.time - wsec;
+        wsec   = imu.time;
+        imu_data.emplace_back(imu);
+    }
+    return true;
+}
+
+namespace {
+/**
+ * @brief 解析 [first, last) 区间内的所有IMU记录并去除重复历元
+ *
+ * @param has_wsec 是否已知前一条记录的周内秒；为 false 时区间内第一条记录直接保留，其 dt 由调用者修正
+ * @param wsec 前一条记录的周内秒
+ */
+void parseIMUchunk(const char *first, const char *last, bool has_wsec, double wsec, bool is_imu_increment,
+                   const ImuFormat &format, vector<IMU> &imu_data) {
+    const char *line_end;
+    IMU imu;
+    while (first < last) {
+        const char *line = first;
+        first            = nextLine(first, last, line_end);
+        if (!FileIO::parseIMUline(line, line_end, imu, is_imu_increment, format)) {
+            continue;
+        }
+        if (!has_wsec) {
+            imu.dt   = 0;
+            wsec     = imu.time;
+            has_wsec = true;
+            imu_data.emplace_back(imu);
+            continue;
+        }
+        // 可能会出现一个历元多次采样的问题
+        if (abs(imu.time - wsec) < 1E-6) {
+            continue;
+        }
+        imu.dt = imu.time - wsec;
+        wsec   = imu.time;
         imu_data.emplace_back(imu);
     }
+}
+} // namespace
+
+bool FileIO::getIMUdataParallel(const string &imufile, vector<IMU> &imu_data, bool is_imu_increment, int threads,
+                                const ImuFormat &format) {
+    GINS_PROFILE_SCOPE("fileio.imu.parallel");
+    if (imufile.substr(imufile.find_last_of(".") + 1, 3) != "ASC") {
+        cerr << "文件名：" << imufile << " 错误，目前只处理ASC格式数据！" << endl;
+        return false;
+    }
+    if (loadIMUcache(imufile, imu_data, is_imu_increment, format)) {
+        return true;
+    }
+    MmapFile file;
+    if (!file.open(imufile)) {
+        cerr << "文件：" << imufile << " 打开失败！" << endl;
+        return false;
+    }
+
+    // 第一条完整记录只用于确定起始周内秒
+    const char *cur = file.begin(), *end = file.end(), *line_end;
+    IMU imu;
+    bool has_first = false;
+    while (cur < end && !has_first) {
+        const char *line = cur;
+        cur              = nextLine(cur, end, line_end);
+        has_first        = parseIMUline(line, line_end, imu, is_imu_increment, format);
+    }
+    if (!has_first) {
+        return true;
+    }
+    double wsec = imu.time;
+
+    // 按换行符切分数据块，块数多于线程数以平衡各线程的负载
+    ThreadPool pool(threads > 0 ? threads : 0);
+    size_t nchunks = min<size_t>(pool.size() * 4, max<size_t>(1, (end - cur) >> 20));
+    vector<const char *> bounds{cur};
+    for (size_t i = 1; i < nchunks; i++) {
+        const char *pos = max(bounds.back(), cur + (end - cur) * i / nchunks);
+        nextLine(pos, end, line_end);
+        bounds.push_back(line_end == end ? end : line_end + 1);
+    }
+    bounds.push_back(end);
+
+    vector<vector<IMU>> chunks(nchunks);
+    pool.parallelFor(nchunks, [&](size_t i) {
+        chunks[i].reserve((bounds[i + 1] - bounds[i]) / max<ptrdiff_t>(cur - file.begin(), 1));
+        parseIMUchunk(bounds[i], bounds[i + 1], false, 0, is_imu_increment, format, chunks[i]);
+    });
+
+    // 按顺序拼接：用前一块最后保留的周内秒修正本块第一条记录的 dt；
+    // 若本块第一条记录与之重复，则该块的去重结果可能改变，按串行规则重新解析整块
+    vector<size_t> offsets(nchunks + 1, imu_data.size());
+    for (size_t i = 0; i < nchunks; i++) {
+        vector<IMU> &chunk = chunks[i];
+        if (!chunk.empty()) {
+            if (abs(chunk.front().time - wsec) < 1E-6) {
+                chunk.clear();
+                parseIMUchunk(bounds[i], bounds[i + 1], true, wsec, is_imu_increment, format, chunk);
+            } else {
+                chunk.front().dt = chunk.front().time - wsec;
+            }
+        }
+        if (!chunk.empty()) {
+            wsec = chunk.back().time;
+        }
+        offsets[i + 1] = offsets[i] + chunk.size();
+    }
+
+    imu_data.resize(offsets[nchunks]);
+    pool.parallelFor(nchunks, [&](size_t i) {
+        copy(chunks[i].begin(), chunks[i].end(), imu_data.begin() + offsets[i]);
+    });
     return true;
 }
 
 bool FileIO::getGNSSdata(const string &gnssfile, vector<GNSS> &gnss_data) {
+    GINS_PROFILE_SCOPE("fileio.gnss");
     if (gnssfile.substr(gnssfile.find_last_of(".") + 1, 3) != "pos") {
         cerr << "文件名：" << gnssfile << " 错误，目前只处理pos格式数据！" << endl;
         return false;
     }
+    DataCache cache;
+    if (cache.openFresh(gnssfile, DataCache::GNSS_DATA)) {
+        size_t offset = gnss_data.size();
+        gnss_data.resize(offset + cache.size());
+        for (size_t i = 0; i < cache.size(); i++) {
+            cache.getGNSS(i, gnss_data[offset + i]);
+        }
+        return true;
+    }
     fstream ifs(gnssfile, ios::in);
     if (!ifs.is_open()) {
         cerr << "文件：" << gnssfile << " 打开失败！" << endl;
@@ -112,7 +423,167 @@ bool FileIO::getGNSSdata(const string &gnssfile, vector<GNSS> &gnss_data) {
         gnss.posstd << stod(splits[5]), stod(splits[6]), stod(splits[7]);          // NED位置标准差（m）
         gnss.vel << stod(splits[8]), stod(splits[9]), -stod(splits[10]);           // NED速度（m/s）
         gnss.velstd << stod(splits[11]), stod(splits[12]), stod(splits[13]);       // NED速度标准差（m/s）
+        gnss.isvalid = true;
         gnss_data.emplace_back(gnss);
     }
     return true;
-}
\ No newline at end of file
+}
+
+bool FileIO::loadOptions(const string &configfile, GINSOptions &options) {
+    YAML::Node config;
+    try {
+        config = YAML::LoadFile(configfile);
+    } catch (const YAML::Exception &e) {
+        cerr << "配置文件：" << configfile << " 读取失败！" << e.what() << endl;
+        return false;
+    }
+
+    // 读取三维向量参数，乘以单位转换系数
+    auto vector3 = [&config](const char *key, double scale, Vector3d &value) {
+        if (!config[key] || config[key].size() != 3) {
+            return false;
+        }
+        for (int i = 0; i < 3; i++) {
+            value[i] = config[key][i].as<double>() * scale;
+        }
+        return true;
+    };
+
+    try {
+        options.imufile    = config["imupath"].as<string>();
+        options.gnssfile   = config["gnsspath"].as<string>();
+        options.outputpath = config["outputpath"] ? config["outputpath"].as<string>() : string(".");
+
+        YAML::Node noise = config["imunoise"];
+        if (!noise) {
+            cerr << "配置文件：" << configfile << " 缺少 imunoise 参数！" << endl;
+            return false;
+        }
+        ImuNoise &imunoise = options.imunoise;
+        for (int i = 0; i < 3; i++) {
+            imunoise.gyr_arw[i]      = noise["arw"][i].as<double>() * D2R / 60.0;
+            imunoise.acc_vrw[i]      = noise["vrw"][i].as<double>() / 60.0;
+            imunoise.gyrbias_std[i]  = noise["gbstd"][i].as<double>() * D2R / 3600.0;
+            imunoise.accbias_std[i]  = noise["abstd"][i].as<double>() * 1E-5;
+            imunoise.gyrscale_std[i] = noise["gsstd"][i].as<double>() * 1E-6;
+            imunoise.accscale_std[i] = noise["asstd"][i].as<double>() * 1E-6;
+        }
+        imunoise.corr_time = noise["corrtime"].as<double>() * 3600.0;
+
+        // 初始状态，位置和速度在解算时由第一个GNSS历元确定
+        PVA &initpva = options.initstate.pav;
+        initpva.pos.setZero();
+        initpva.vel.setZero();
+        if (!vector3("initatt", D2R, initpva.att.euler)) {
+            cerr << "配置文件：" << configfile << " 缺少 initatt 参数！" << endl;
+            return false;
+        }
+        ImuError &initerror = options.initstate.imuerror;
+        if (!vector3("initgyrbias", D2R / 3600.0, initerror.gyrbias)) {
+            initerror.gyrbias.setZero();
+        }
+        if (!vector3("initaccbias", 1E-5, initerror.accbias)) {
+            initerror.accbias.setZero();
+        }
+        if (!vector3("initgyrscale", 1E-6, initerror.gyrscale)) {
+            initerror.gyrscale.setZero();
+        }
+        if (!vector3("initaccscale", 1E-6, initerror.accscale)) {
+            initerror.accscale.setZero();
+        }
+
+        // 初始状态标准差
+        PVA &initstd = options.initstate_std.pav;
+        if (!vector3("initposstd", 1.0, initstd.pos) || !vector3("initvelstd", 1.0, initstd.vel) ||
+            !vector3("initattstd", D2R, initstd.att.euler)) {
+            cerr << "配置文件：" << configfile << " 缺少 initposstd、initvelstd 或 initattstd 参数！" << endl;
+            return false;
+        }
+        ImuError &initerror_std = options.initstate_std.imuerror;
+        if (!vector3("initbgstd", D2R / 3600.0, initerror_std.gyrbias)) {
+            initerror_std.gyrbias = imunoise.gyrbias_std;
+        }
+        if (!vector3("initbastd", 1E-5, initerror_std.accbias)) {
+            initerror_std.accbias = imunoise.accbias_std;
+        }
+        if (!vector3("initsgstd", 1E-6, initerror_std.gyrscale)) {
+            initerror_std.gyrscale = imunoise.gyrscale_std;
+        }
+        if (!vector3("initsastd", 1E-6, initerror_std.accscale)) {
+            initerror_std.accscale = imunoise.accscale_std;
+        }
+
+        if (!vector3("antlever", 1.0, options.antlever)) {
+            options.antlever.setZero();
+        }
+
+        ImuFormat &imuformat = options.imuformat;
+        imuformat            = ImuFormat();
+        if (config["accscale"]) {
+            imuformat.acc_scale = config["accscale"].as<double>();
+        }
+        if (config["gyrscale"]) {
+            imuformat.gry_scale = config["gyrscale"].as<double>();
+        }
+        if (config["imurate"]) {
+            imuformat.freq = config["imurate"].as<int>();
+        }
+
+        options.starttime = config["starttime"] ? config["starttime"].as<double>() : 0.0;
+        options.endtime   = config["endtime"] ? config["endtime"].as<double>() : 0.0;
+        if (options.starttime < 0 || options.endtime < 0 ||
+            (options.endtime > 0 && options.endtime <= options.starttime)) {
+            cerr << "配置文件：" << configfile << " starttime、endtime 不能为负数，且 endtime 必须晚于 starttime！" << endl;
+            return false;
+        }
+
+        options.zupt              = config["zupt"] ? config["zupt"].as<bool>() : false;
+        options.zuptstd           = config["zuptstd"] ? config["zuptstd"].as<double>() : 0.01;
+        StaticOptions &staticopts = options.staticopts;
+        staticopts                = StaticOptions();
+        if (config["staticwindow"]) {
+            staticopts.window = config["staticwindow"].as<double>();
+        }
+        if (config["staticgyrmean"]) {
+            staticopts.gyrmean = config["staticgyrmean"].as<double>();
+        }
+        if (config["staticgyrstd"]) {
+            staticopts.gyrstd = config["staticgyrstd"].as<double>();
+        }
+        if (config["staticaccstd"]) {
+            staticopts.accstd = config["staticaccstd"].as<double>();
+        }
+        if (options.zuptstd <= 0 || staticopts.window * options.imuformat.freq < 2) {
+            cerr << "配置文件：" << configfile << " zuptstd 必须为正数，staticwindow 内至少要有两个IMU历元！" << endl;
+            return false;
+        }
+
+        options.gnssinterval = config["gnssinterval"] ? config["gnssinterval"].as<double>() : 0.0;
+        options.lazycov      = config["lazycov"] ? config["lazycov"].as<bool>() : false;
+        options.stdinterval  = config["stdinterval"] ? config["stdinterval"].as<double>() : 0.0;
+        options.decimation   = config["outputdecimation"] ? config["outputdecimation"].as<int>() : 1;
+        options.gnssonly     = config["outputgnssonly"] ? config["outputgnssonly"].as<bool>() : false;
+        string format        = config["outputformat"] ? config["outputformat"].as<string>() : "text";
+        options.binaryoutput = format == "binary";
+        if (format != "text" && format != "binary") {
+            cerr << "配置文件：" << configfile << " outputformat 只能为 text 或 binary！" << endl;
+            return false;
+        }
+        if (imuformat.acc_scale <= 0 || imuformat.gry_scale <= 0 || imuformat.freq <= 0) {
+            cerr << "配置文件：" << configfile << " accscale、gyrscale、imurate 必须为正数！" << endl;
+            return false;
+        }
+        if (options.gnssinterval < 0) {
+            cerr << "配置文件：" << configfile << " gnssinterval 不能为负数！" << endl;
+            return false;
+        }
+        if (options.decimation < 1) {
+            cerr << "配置文件：" << configfile << " outputdecimation 必须为正整数！" << endl;
+            return false;
+        }
+    } catch (const YAML::Exception &e) {
+        cerr << "配置文件：" << configfile << " 参数错误！" << e.what() << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,499 @@
+#include "gins.hpp"
+#include "earth.hpp"
+#include "insmech.hpp"
+#include "profiler.hpp"
+#include "rotation.hpp"
+#include <iostream>
+
+using Eigen::Matrix;
+
+GIEngine::GIEngine(const GINSOptions &options)
+    : options_(options)
+    , detector_(options.staticopts, options.imuformat.freq) {
+    timestamp_      = 0;
+    pvacur_         = options.initstate.pav;
+    pvacur_.att.cbn = Rotation::euler2matrix(pvacur_.att.euler);
+    pvacur_.att.qbn = Rotation::euler2quaternion(pvacur_.att.euler);
+    pvapre_         = pvacur_;
+    imuerror_       = options.initstate.imuerror;
+
+    imupre_.dt = imucur_.dt = 0;
+    imupre_.dtheta.setZero();
+    imupre_.dvel.setZero();
+    imucur_.dtheta.setZero();
+    imucur_.dvel.setZero();
+    gnssdata_.isvalid = false;
+
+    // 初始协方差
+    const NavState &initstd = options.initstate_std;
+    StateVector var;
+    var << initstd.pav.pos, initstd.pav.vel, initstd.pav.att.euler, initstd.imuerror.gyrbias,
+        initstd.imuerror.accbias, initstd.imuerror.gyrscale, initstd.imuerror.accscale;
+    Cov_ = var.cwiseProduct(var).asDiagonal();
+
+    // 系统噪声，零偏和比例因子为一阶高斯-马尔可夫过程，驱动白噪声谱密度为 2σ²/T
+    const ImuNoise &noise = options.imunoise;
+    double corr           = 2.0 / noise.corr_time;
+    qc_ << noise.acc_vrw.cwiseProduct(noise.acc_vrw), noise.gyr_arw.cwiseProduct(noise.gyr_arw),
+        corr * noise.gyrbias_std.cwiseProduct(noise.gyrbias_std),
+        corr * noise.accbias_std.cwiseProduct(noise.accbias_std),
+        corr * noise.gyrscale_std.cwiseProduct(noise.gyrscale_std),
+        corr * noise.accscale_std.cwiseProduct(noise.accscale_std);
+
+    dx_.setZero();
+    Phiacc_.setIdentity();
+    Qsum_.setZero();
+}
+
+void GIEngine::addImuData(const IMU &imu) {
+    imupre_ = imucur_;
+    imucur_ = imu;
+    imuCompensate(imucur_);
+}
+
+void GIEngine::newImuProcess() {
+    GINS_PROFILE_SCOPE("gins.epoch");
+    // 当前GNSS数据有效时判断是否需要在本历元进行量测更新
+    double updatetime = gnssdata_.isvalid ? gnssdata_.time : -1;
+    int res           = isToUpdate(imupre_.time, imucur_.time, updatetime);
+
+    size_t recorded = epochs_ == nullptr ? 0 : epochs_->size();
+    if (res == 0) {
+        insPropagation(imupre_, imucur_);
+    } else if (res == 1) {
+        // GNSS数据靠近 k-1 时刻，先更新再递推
+        gnssCorrect(gnssdata_, imupre_.time);
+        insPropagation(imupre_, imucur_);
+    } else if (res == 2) {
+        // GNSS数据靠近 k 时刻，先递推再更新
+        insPropagation(imupre_, imucur_);
+        gnssCorrect(gnssdata_, imucur_.time);
+    } else {
+        // GNSS数据位于两个IMU历元之间，内插IMU数据到GNSS时刻，先递推到GNSS时刻，更新后再递推到 k 时刻
+        IMU midimu;
+        imuInterpolate(imupre_, imucur_, updatetime, midimu);
+        insPropagation(imupre_, midimu);
+        gnssCorrect(gnssdata_, updatetime);
+        insPropagation(midimu, imucur_);
+    }
+    updated_ = res != 0;
+    if (updated_) {
+        lastupdate_       = updatetime;
+        gnssdata_.isvalid = false;
+        GINS_PROFILE_COUNT("gins.gnss", 1);
+    }
+
+    // 静止检测只使用IMU数据，判为静止时在 k 时刻零速修正
+    zupted_ = options_.zupt && detector_.update(imucur_);
+    if (zupted_) {
+        zuptCorrect(imucur_.time);
+        GINS_PROFILE_COUNT("gins.zupt", 1);
+    }
+    if (epochs_ != nullptr && epochs_->size() > recorded) {
+        epochs_->back().output = true;
+    }
+
+    timestamp_ = imucur_.time;
+    if (!pending_) {
+        checkCov();
+    }
+}
+
+void GIEngine::insPropagation(const IMU &imupre, const IMU &imucur) {
+    GINS_PROFILE_SCOPE("gins.propagate");
+    if (imucur.dt <= 0) {
+        return;
+    }
+
+    // 连续时间误差状态方程的系数矩阵 F，使用 k-1 时刻的状态
+    const PVA &pva        = pvacur_;
+    const Vector3d &vel   = pva.vel;
+    const Matrix3d &cbn   = pva.att.cbn;
+    EarthTerms earth      = Earth::getTerms(pva.pos, vel);
+    const Vector2d &rmrn  = earth.rmrn;
+    double gravity        = earth.gravity;
+    double h              = pva.pos[2];
+    double sinlat         = earth.sinlat;
+    double coslat         = earth.coslat;
+    double tanlat         = sinlat / coslat;
+    double rmh            = rmrn[0] + h;
+    double rnh            = rmrn[1] + h;
+    const Vector3d &wie_n = earth.wie_n;
+    const Vector3d &wen_n = earth.wen_n;
+    Vector3d accel        = imucur.dvel / imucur.dt;
+    Vector3d omega        = imucur.dtheta / imucur.dt;
+    Matrix3d I33          = Matrix3d::Identity();
+
+    StateMatrix F = StateMatrix::Zero();
+    Matrix3d temp;
+
+    // 位置误差
+    temp.setZero();
+    temp(0, 0)                = -vel[2] / rmh;
+    temp(0, 2)                = vel[0] / rmh;
+    temp(1, 0)                = vel[1] * tanlat / rnh;
+    temp(1, 1)                = -(vel[2] + vel[0] * tanlat) / rnh;
+    temp(1, 2)                = vel[1] / rnh;
+    F.block<3, 3>(P_ID, P_ID) = temp;
+    F.block<3, 3>(P_ID, V_ID) = I33;
+
+    // 速度误差
+    double sec2 = 1.0 / (coslat * coslat);
+    temp.setZero();
+    temp(0, 0) = -2 * vel[1] * Earth::WIE * coslat / rmh - vel[1] * vel[1] / rmh / rnh * sec2;
+    temp(0, 2) = vel[0] * vel[2] / rmh / rmh - vel[1] * vel[1] * tanlat / rnh / rnh;
+    temp(1, 0) = 2 * Earth::WIE * (vel[0] * coslat - vel[2] * sinlat) / rmh + vel[0] * vel[1] / rmh / rnh * sec2;
+    temp(1, 2) = (vel[1] * vel[2] + vel[0] * vel[1] * tanlat) / rnh / rnh;
+    temp(2, 0) = 2 * Earth::WIE * vel[1] * sinlat / rmh;
+    temp(2, 2) = -vel[1] * vel[1] / rnh / rnh - vel[0] * vel[0] / rmh / rmh +
+                 2 * gravity / (sqrt(rmrn[0] * rmrn[1]) + h);
+    F.block<3, 3>(V_ID, P_ID) = temp;
+    temp.setZero();
+    temp(0, 0)                  = vel[2] / rmh;
+    temp(0, 1)                  = -2 * (Earth::WIE * sinlat + vel[1] * tanlat / rnh);
+    temp(0, 2)                  = vel[0] / rmh;
+    temp(1, 0)                  = 2 * Earth::WIE * sinlat + vel[1] * tanlat / rnh;
+    temp(1, 1)                  = (vel[2] + vel[0] * tanlat) / rnh;
+    temp(1, 2)                  = 2 * Earth::WIE * coslat + vel[1] / rnh;
+    temp(2, 0)                  = -2 * vel[0] / rmh;
+    temp(2, 1)                  = -2 * (Earth::WIE * coslat + vel[1] / rnh);
+    F.block<3, 3>(V_ID, V_ID)   = temp;
+    F.block<3, 3>(V_ID, PHI_ID) = Rotation::skewSymmetric(cbn * accel);
+    F.block<3, 3>(V_ID, BA_ID)  = cbn;
+    F.block<3, 3>(V_ID, SA_ID)  = cbn * accel.asDiagonal();
+
+    // 姿态误差
+    temp.setZero();
+    temp(0, 0)                    = -Earth::WIE * sinlat / rmh;
+    temp(0, 2)                    = vel[1] / rnh / rnh;
+    temp(1, 2)                    = -vel[0] / rmh / rmh;
+    temp(2, 0)                    = -Earth::WIE * coslat / rmh - vel[1] / rmh / rnh * sec2;
+    temp(2, 2)                    = -vel[1] * tanlat / rnh / rnh;
+    F.block<3, 3>(PHI_ID, P_ID)   = temp;
+    temp.setZero();
+    temp(0, 1)                    = 1 / rnh;
+    temp(1, 0)                    = -1 / rmh;
+    temp(2, 1)                    = -tanlat / rnh;
+    F.block<3, 3>(PHI_ID, V_ID)   = temp;
+    F.block<3, 3>(PHI_ID, PHI_ID) = -Rotation::skewSymmetric(wie_n + wen_n);
+    F.block<3, 3>(PHI_ID, BG_ID)  = -cbn;
+    F.block<3, 3>(PHI_ID, SG_ID)  = -cbn * omega.asDiagonal();
+
+    // IMU零偏和比例因子误差，一阶高斯-马尔可夫过程
+    double inv_corr             = -1.0 / options_.imunoise.corr_time;
+    F.block<3, 3>(BG_ID, BG_ID) = inv_corr * I33;
+    F.block<3, 3>(BA_ID, BA_ID) = inv_corr * I33;
+    F.block<3, 3>(SG_ID, SG_ID) = inv_corr * I33;
+    F.block<3, 3>(SA_ID, SA_ID) = inv_corr * I33;
+
+    // 离散化，状态转移矩阵取一阶近似
+    StateMatrix Phi = StateMatrix::Identity() + F * imucur.dt;
+
+    // 系统噪声，速度、姿态误差的驱动噪声由b系转到n系，零偏和比例因子误差的驱动噪声直接作用于各状态
+    Matrix3d qvel                   = cbn * qc_.segment<3>(VRW_ID).asDiagonal() * cbn.transpose() * imucur.dt;
+    Matrix3d qatt                   = cbn * qc_.segment<3>(ARW_ID).asDiagonal() * cbn.transpose() * imucur.dt;
+    Matrix<double, 12, 1> qimuerror = qc_.segment<12>(BGSTD_ID) * imucur.dt;
+
+    // 机械编排，pvapre_、pvacur_ 各向前推进一个历元
+    INSMech::insMechFused(pvapre_, pvacur_, imupre, imucur);
+
+    // 延迟传播，记录RTS平滑节点时需要逐历元的协方差，不使用延迟传播
+    if (options_.lazycov && epochs_ == nullptr) {
+        chainTransition(Phi, Phiacc_);
+        Qsum_.block<3, 3>(V_ID, V_ID) += qvel;
+        Qsum_.block<3, 3>(PHI_ID, PHI_ID) += qatt;
+        Qsum_.diagonal().segment<12>(BG_ID) += qimuerror;
+        pending_ = true;
+        return;
+    }
+
+    // 误差状态反馈后恒为0，只需传播协方差。系统噪声按梯形积分，
+    // Φ P Φ^T + (Φ Q Φ^T + Q) / 2 = Φ (P + Q/2) Φ^T + Q/2，只需做一次结构化的矩阵乘法
+    StateMatrix Qd                   = StateMatrix::Zero();
+    Qd.block<3, 3>(V_ID, V_ID)       = qvel / 2.0;
+    Qd.block<3, 3>(PHI_ID, PHI_ID)   = qatt / 2.0;
+    Qd.diagonal().segment<12>(BG_ID) = qimuerror / 2.0;
+    Cov_ += Qd;
+    propagateCovariance(Phi, Qd, Cov_);
+
+    if (epochs_ != nullptr) {
+        recordEpoch(imucur.time, Phi, Cov_, StateVector::Zero());
+    }
+}
+
+void GIEngine::propagateCovariance(const StateMatrix &Phi, const StateMatrix &Q, StateMatrix &P) {
+    // B = Φ P，导航误差的行块只累加非零块，IMU误差的行块为逐行缩放
+    StateMatrix B;
+    for (int i = 0; i < NAV_BLOCKS; i++) {
+        const int *nz = PHI_NONZERO[i];
+        B.middleRows<3>(3 * i).noalias() = Phi.block<3, 3>(3 * i, 3 * nz[0]) * P.middleRows<3>(3 * nz[0]);
+        for (nz++; *nz >= 0; nz++) {
+            B.middleRows<3>(3 * i).noalias() += Phi.block<3, 3>(3 * i, 3 * *nz) * P.middleRows<3>(3 * *nz);
+        }
+    }
+    for (int i = NAV_BLOCKS; i < BLOCKS; i++) {
+        B.middleRows<3>(3 * i) = Phi.block<3, 3>(3 * i, 3 * i).diagonal().asDiagonal() * P.middleRows<3>(3 * i);
+    }
+
+    // P = B Φ^T + Q，只计算上三角的块
+    for (int j = 0; j < NAV_BLOCKS; j++) {
+        for (int i = 0; i <= j; i++) {
+            const int *nz = PHI_NONZERO[j];
+            Matrix3d C    = B.block<3, 3>(3 * i, 3 * nz[0]) * Phi.block<3, 3>(3 * j, 3 * nz[0]).transpose();
+            for (nz++; *nz >= 0; nz++) {
+                C.noalias() += B.block<3, 3>(3 * i, 3 * *nz) * Phi.block<3, 3>(3 * j, 3 * *nz).transpose();
+            }
+            P.block<3, 3>(3 * i, 3 * j) = C + Q.block<3, 3>(3 * i, 3 * j);
+        }
+    }
+    for (int j = NAV_BLOCKS; j < BLOCKS; j++) {
+        Vector3d phi = Phi.block<3, 3>(3 * j, 3 * j).diagonal();
+        for (int i = 0; i <= j; i++) {
+            P.block<3, 3>(3 * i, 3 * j) = B.block<3, 3>(3 * i, 3 * j) * phi.asDiagonal();
+            P.block<3, 3>(3 * i, 3 * j) += Q.block<3, 3>(3 * i, 3 * j);
+        }
+    }
+
+    // 下三角由上三角对称得到
+    for (int j = 0; j < RANK; j++) {
+        for (int i = j + 1; i < RANK; i++) {
+            P(i, j) = P(j, i);
+        }
+    }
+}
+
+void GIEngine::chainTransition(const StateMatrix &Phi, StateMatrix &Phiacc) {
+    // 导航误差的行块：Phi 的非零块分别乘 Phiacc 的导航误差行块（稠密）或IMU误差的对角块
+    Matrix<double, 3 * NAV_BLOCKS, RANK> nav;
+    for (int i = 0; i < NAV_BLOCKS; i++) {
+        auto row = nav.middleRows<3>(3 * i);
+        row.setZero();
+        for (const int *nz = PHI_NONZERO[i]; *nz >= 0; nz++) {
+            int l = *nz;
+            if (l < NAV_BLOCKS) {
+                row.noalias() += Phi.block<3, 3>(3 * i, 3 * l) * Phiacc.middleRows<3>(3 * l);
+            } else {
+                row.block<3, 3>(0, 3 * l).noalias() +=
+                    Phi.block<3, 3>(3 * i, 3 * l) * Phiacc.block<3, 3>(3 * l, 3 * l).diagonal().asDiagonal();
+            }
+        }
+    }
+    Phiacc.topRows<3 * NAV_BLOCKS>() = nav;
+
+    // IMU误差的对角块逐元素相乘
+    for (int i = NAV_BLOCKS; i < BLOCKS; i++) {
+        Phiacc.block<3, 3>(3 * i, 3 * i).diagonal().array() *= Phi.block<3, 3>(3 * i, 3 * i).diagonal().array();
+    }
+}
+
+void GIEngine::flushCovariance() const {
+    GINS_PROFILE_SCOPE("gins.covariance");
+    if (!pending_) {
+        return;
+    }
+
+    // 累积区间内系统噪声的积分
+    StateMatrix A     = Phiacc_ - StateMatrix::Identity();
+    StateMatrix AQ    = A * Qsum_;
+    StateMatrix Qint  = Qsum_ + (AQ + AQ.transpose()) / 2.0 + AQ * A.transpose() / 3.0;
+    StateMatrix PPhiT = Cov_ * Phiacc_.transpose();
+    Cov_              = Phiacc_ * PPhiT + Qint;
+    Cov_              = (Cov_ + Cov_.transpose()) / 2.0;
+
+    Phiacc_.setIdentity();
+    Qsum_.setZero();
+    pending_ = false;
+    checkCov();
+}
+
+void GIEngine::gnssUpdate(const GNSS &gnss) {
+    GINS_PROFILE_SCOPE("gins.gnssupdate");
+    const PVA &pva   = pvacur_;
+    EarthTerms earth = Earth::getTerms(pva.pos, pva.vel);
+    double rmh       = earth.rmrn[0] + pva.pos[2];
+    double rnh       = earth.rmrn[1] + pva.pos[2];
+
+    // BLH增量与NED坐标的转换
+    Vector3d Dr(rmh, rnh * earth.coslat, -1);
+    Vector3d lever_n = pva.att.cbn * options_.antlever;
+
+    // 天线相位中心的位置新息，NED坐标系，单位m
+    Vector3d antenna_pos = pva.pos + lever_n.cwiseQuotient(Dr);
+    Vector3d dz_pos      = Dr.cwiseProduct(antenna_pos - gnss.blh);
+
+    Matrix<double, 3, RANK> Hpos = Matrix<double, 3, RANK>::Zero();
+    Hpos.block<3, 3>(0, P_ID)    = Matrix3d::Identity();
+    Hpos.block<3, 3>(0, PHI_ID)  = Rotation::skewSymmetric(lever_n);
+
+    if (gnss.velstd.minCoeff() <= 0) {
+        // 没有可用的GNSS速度时只做位置更新
+        Matrix3d R = gnss.posstd.cwiseProduct(gnss.posstd).asDiagonal();
+        measurementUpdate<3>(dz_pos, Hpos, R);
+        return;
+    }
+
+    // 天线相位中心的速度 v + cbn*(ω×l) - (wie+wen)×(cbn*l)
+    Matrix3d win_skew  = Rotation::skewSymmetric(earth.wie_n + earth.wen_n);
+    Vector3d omega     = imucur_.dt > 0 ? Vector3d(imucur_.dtheta / imucur_.dt) : Vector3d::Zero();
+    Vector3d lever_vel = pva.att.cbn * omega.cross(options_.antlever);
+    Vector3d dz_vel    = pva.vel + lever_vel - win_skew * lever_n - gnss.vel;
+
+    Matrix<double, 6, 1> dz;
+    dz << dz_pos, dz_vel;
+    Matrix<double, 6, RANK> H = Matrix<double, 6, RANK>::Zero();
+    H.block<3, RANK>(0, 0)    = Hpos;
+    H.block<3, 3>(3, V_ID)    = Matrix3d::Identity();
+    H.block<3, 3>(3, PHI_ID)  = Rotation::skewSymmetric(lever_vel) - win_skew * Rotation::skewSymmetric(lever_n);
+    Matrix<double, 6, 1> rdiag;
+    rdiag << gnss.posstd.cwiseProduct(gnss.posstd), gnss.velstd.cwiseProduct(gnss.velstd);
+    Matrix<double, 6, 6> R = rdiag.asDiagonal();
+    measurementUpdate<6>(dz, H, R);
+}
+
+void GIEngine::gnssCorrect(const GNSS &gnss, double time) {
+    flushCovariance();
+    if (epochs_ == nullptr) {
+        gnssUpdate(gnss);
+        stateFeedback();
+        return;
+    }
+
+    StateMatrix Pminus = Cov_;
+    gnssUpdate(gnss);
+    StateVector dx = dx_;
+    stateFeedback();
+    recordEpoch(time, StateMatrix::Identity(), Pminus, dx);
+}
+
+void GIEngine::zuptUpdate() {
+    GINS_PROFILE_SCOPE("gins.zuptupdate");
+    Matrix<double, 3, RANK> H = Matrix<double, 3, RANK>::Zero();
+    H.block<3, 3>(0, V_ID)    = Matrix3d::Identity();
+    Matrix3d R                = Matrix3d::Identity() * (options_.zuptstd * options_.zuptstd);
+    measurementUpdate<3>(pvacur_.vel, H, R);
+}
+
+void GIEngine::zuptCorrect(double time) {
+    flushCovariance();
+    if (epochs_ == nullptr) {
+        zuptUpdate();
+        stateFeedback();
+        return;
+    }
+
+    StateMatrix Pminus = Cov_;
+    zuptUpdate();
+    StateVector dx = dx_;
+    stateFeedback();
+    recordEpoch(time, StateMatrix::Identity(), Pminus, dx);
+}
+
+template <int N>
+void GIEngine::measurementUpdate(const Matrix<double, N, 1> &dz, const Matrix<double, N, RANK> &H,
+                                 const Matrix<double, N, N> &R) {
+    // K = P*H^T*(H*P*H^T + R)^-1，S 对称正定，用 Cholesky 分解求解
+    Matrix<double, N, RANK> HP = H * Cov_;
+    Matrix<double, N, N> S     = HP * H.transpose() + R;
+    Eigen::LLT<Matrix<double, N, N>> llt(S);
+    Matrix<double, RANK, N> K = llt.solve(HP).transpose();
+
+    // 新息 v = dz - H*dx，NIS = v^T S^-1 v
+    Matrix<double, N, 1> v = dz - H * dx_;
+    innovation_.updates++;
+    innovation_.dims += N;
+    innovation_.nis += v.dot(llt.solve(v));
+
+    dx_             = dx_ + K * v;
+    StateMatrix IKH = StateMatrix::Identity() - K * H;
+    Cov_            = IKH * Cov_ * IKH.transpose() + K * R * K.transpose();
+}
+
+void GIEngine::stateFeedback() {
+    correctState(pvacur_, imuerror_, dx_);
+    dx_.setZero();
+}
+
+void GIEngine::correctState(PVA &pva, ImuError &imuerror, const StateVector &dx) {
+    Vector2d rmrn = Earth::getRmRn(pva.pos[0]);
+    Vector3d Dr(rmrn[0] + pva.pos[2], (rmrn[1] + pva.pos[2]) * cos(pva.pos[0]), -1);
+
+    // 位置、速度、姿态误差反馈
+    pva.pos -= dx.segment<3>(P_ID).cwiseQuotient(Dr);
+    pva.vel -= dx.segment<3>(V_ID);
+    pva.att.cbn = Rotation::rotvec2matrix(dx.segment<3>(PHI_ID)) * pva.att.cbn;
+
+    // IMU误差反馈
+    imuerror.gyrbias += dx.segment<3>(BG_ID);
+    imuerror.accbias += dx.segment<3>(BA_ID);
+    imuerror.gyrscale += dx.segment<3>(SG_ID);
+    imuerror.accscale += dx.segment<3>(SA_ID);
+}
+
+void GIEngine::recordEpochs(vector<Epoch> *epochs) {
+    flushCovariance();
+    epochs_ = epochs;
+    if (epochs_ != nullptr) {
+        recordEpoch(timestamp_, StateMatrix::Identity(), Cov_, StateVector::Zero());
+    }
+}
+
+void GIEngine::recordEpoch(double time, const StateMatrix &Phi, const StateMatrix &Pminus, const StateVector &dx) {
+    Epoch &epoch   = epochs_->emplace_back();
+    epoch.time     = time;
+    epoch.output   = false;
+    epoch.pva      = pvacur_;
+    epoch.imuerror = imuerror_;
+    epoch.Phi      = Phi;
+    epoch.Pminus   = Pminus;
+    epoch.Pplus    = Cov_;
+    epoch.dx       = dx;
+}
+
+void GIEngine::imuCompensate(IMU &imu) const {
+    imu.dtheta -= imuerror_.gyrbias * imu.dt;
+    imu.dvel -= imuerror_.accbias * imu.dt;
+    imu.dtheta = imu.dtheta.cwiseQuotient(Vector3d::Ones() + imuerror_.gyrscale);
+    imu.dvel   = imu.dvel.cwiseQuotient(Vector3d::Ones() + imuerror_.accscale);
+}
+
+void GIEngine::checkCov() const {
+    for (int i = 0; i < RANK; i++) {
+        if (Cov_(i, i) < 0) {
+            cerr << "协方差矩阵对角线第 " << i << " 个元素为负数，时间：" << timestamp_ << endl;
+            return;
+        }
+    }
+}
+
+int GIEngine::isToUpdate(double imutime1, double imutime2, double updatetime) {
+    if (abs(imutime1 - updatetime) < TIME_ALIGN_ERR) {
+        return 1;
+    } else if (abs(imutime2 - updatetime) <= TIME_ALIGN_ERR) {
+        return 2;
+    } else if (imutime1 < updatetime && updatetime < imutime2) {
+        return 3;
+    }
+    return 0;
+}
+
+void GIEngine::imuInterpolate(const IMU &imu1, IMU &imu2, double timestamp, IMU &midimu) {
+    double lambda = (timestamp - imu1.time) / (imu2.time - imu1.time);
+
+    midimu.week   = imu2.week;
+    midimu.time   = timestamp;
+    midimu.dt     = timestamp - imu1.time;
+    midimu.dtheta = imu2.dtheta * lambda;
+    midimu.dvel   = imu2.dvel * lambda;
+
+    imu2.dt -= midimu.dt;
+    imu2.dtheta -= midimu.dtheta;
+    imu2.dvel -= midimu.dvel;
+}
+
+NavState GIEngine::getNavState() const {
+    NavState state;
+    state.pav      = pvacur_;
+    state.imuerror = imuerror_;
+    INSMech::updateAttitude(state.pav.att);
+    return state;
+}
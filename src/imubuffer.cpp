@@ -0,0 +1,137 @@
+#include "imubuffer.hpp"
+#include <algorithm>
+
+namespace {
+constexpr int LANES = 8; // 部分和的个数，打破累加的串行依赖，使求和可以向量化
+
+/// 连续数组求和，使用多个部分和
+inline double sumColumn(const double *x, size_t n) {
+    double partial[LANES] = {};
+    size_t i              = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int l = 0; l < LANES; l++) {
+            partial[l] += x[i + l];
+        }
+    }
+    for (; i < n; i++) {
+        partial[0] += x[i];
+    }
+    double res = 0;
+    for (double p : partial) {
+        res += p;
+    }
+    return res;
+}
+
+/// 连续数组相对于 mean 的离差平方和
+inline double sumSquaredDeviation(const double *x, size_t n, double mean) {
+    double partial[LANES] = {};
+    size_t i              = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int l = 0; l < LANES; l++) {
+            double d = x[i + l] - mean;
+            partial[l] += d * d;
+        }
+    }
+    for (; i < n; i++) {
+        double d = x[i] - mean;
+        partial[0] += d * d;
+    }
+    double res = 0;
+    for (double p : partial) {
+        res += p;
+    }
+    return res;
+}
+} // namespace
+
+ImuView ImuView::sub(size_t first, size_t count) const {
+    ImuView res;
+    first     = min(first, size_);
+    res.size_ = min(count, size_ - first);
+    res.week_ = week_ + first;
+    res.time_ = time_ + first;
+    res.dt_   = dt_ + first;
+    for (int a = 0; a < 3; a++) {
+        res.dtheta_[a] = dtheta_[a] + first;
+        res.dvel_[a]   = dvel_[a] + first;
+    }
+    return res;
+}
+
+ImuStats ImuView::sum() const {
+    ImuStats res;
+    for (int a = 0; a < 3; a++) {
+        res.dtheta[a] = sumColumn(dtheta_[a], size_);
+        res.dvel[a]   = sumColumn(dvel_[a], size_);
+    }
+    return res;
+}
+
+ImuStats ImuView::mean() const {
+    ImuStats res = sum();
+    res.dtheta /= size_;
+    res.dvel /= size_;
+    return res;
+}
+
+ImuStats ImuView::variance() const {
+    ImuStats avg = mean(), res;
+    for (int a = 0; a < 3; a++) {
+        res.dtheta[a] = sumSquaredDeviation(dtheta_[a], size_, avg.dtheta[a]) / (size_ - 1);
+        res.dvel[a]   = sumSquaredDeviation(dvel_[a], size_, avg.dvel[a]) / (size_ - 1);
+    }
+    return res;
+}
+
+ImuBuffer::ImuBuffer(const vector<IMU> &imudata, size_t first, size_t last) {
+    last  = min(last, imudata.size());
+    first = min(first, last);
+    reserve(last - first);
+    for (size_t i = first; i < last; i++) {
+        push_back(imudata[i]);
+    }
+}
+
+void ImuBuffer::reserve(size_t n) {
+    week_.reserve(n);
+    time_.reserve(n);
+    dt_.reserve(n);
+    for (int a = 0; a < 3; a++) {
+        dtheta_[a].reserve(n);
+        dvel_[a].reserve(n);
+    }
+}
+
+void ImuBuffer::clear() {
+    week_.clear();
+    time_.clear();
+    dt_.clear();
+    for (int a = 0; a < 3; a++) {
+        dtheta_[a].clear();
+        dvel_[a].clear();
+    }
+}
+
+void ImuBuffer::push_back(const IMU &imu) {
+    week_.push_back(imu.week);
+    time_.push_back(imu.time);
+    dt_.push_back(imu.dt);
+    for (int a = 0; a < 3; a++) {
+        dtheta_[a].push_back(imu.dtheta[a]);
+        dvel_[a].push_back(imu.dvel[a]);
+    }
+}
+
+ImuView ImuBuffer::view() const {
+    ImuView res;
+    res.size_ = size();
+    res.week_ = week_.data();
+    res.time_ = time_.data();
+    res.dt_   = dt_.data();
+    for (int a = 0; a < 3; a++) {
+        res.dtheta_[a] = dtheta_[a].data();
+        res.dvel_[a]   = dvel_[a].data();
+    }
+    return res;
+}
@@ -1,71 +1,63 @@
 #include "init.hpp"
+#include "datacache.hpp"
 #include "earth.hpp"
-#include <absl/strings/str_split.h>
+#include "fileio.hpp"
+#include "profiler.hpp"
 #include <fstream>
+#include <iomanip>
 
-bool getRawIMUdata(const string &imufile, vector<IMU> &imudata) {
+bool getRawIMUdata(const string &imufile, vector<IMU> &imudata, int threads, const ImuFormat &format) {
+    GINS_PROFILE_SCOPE("allan.load");
     if (imufile.substr(imufile.find_last_of(".") + 1, 3) != "ASC") {
         cerr << "文件名：" << imufile << " 错误，目前只处理ASC格式数据！" << endl;
         return false;
     }
-    fstream ifs(imufile, ios::in);
-    if (!ifs.is_open()) {
-        cerr << "文件：" << imufile << " 打开失败！" << endl;
-        return false;
-    }
-    double acc_scale = 1.5258789063E-06;
-    double gyr_scale = 1.0850694444E-07;
-    int freq         = 100;
-
-    string line;
-    getline(ifs, line);
-    line.replace(line.find(";"), 1, ",");
-    line.replace(line.find("*"), 1, ",");
-    vector<string> splits = absl::StrSplit(line, absl::ByAnyChar(","), absl::SkipWhitespace());
-
-    double wsec = stod(splits[4]); // IMU周内秒
     fstream accx("AllanAccX.txt", ios::out), accy("AllanAccY.txt", ios::out), accz("AllanAccZ.txt", ios::out);
     fstream gyrx("AllanGyrX.txt", ios::out), gyry("AllanGyrY.txt", ios::out), gyrz("AllanGyrZ.txt", ios::out);
-    while (getline(ifs, line)) {
-        line.replace(line.find(";"), 1, ",");
-        line.replace(line.find("*"), 1, ",");
-        vector<string> splits = absl::StrSplit(line, absl::ByAnyChar(","), absl::SkipWhitespace());
 
-        // 可能会出现一个历元多次采样的问题
-        if (abs(stod(splits[4]) - wsec) < 1E-6) {
-#ifdef FileIODebug
-            cout.flags(ios::fixed);
-            cout.precision(6);
-            cout << "IMU 重复历元，上一历元的time：" << wsec << ",\t" << "当前历元的time：" << stod(splits[4]) << endl;
-#endif
-            continue;
-        }
-
-        // 解析IMU数据
+    // 缓存和 FileIO 中的原始计数已按 FileIO 的轴系调整，这里换回原始轴系，再转换为加速度和角速度
+    auto output = [&](const IMU &counts) {
         IMU imu;
-        imu.week = stod(splits[3]);
-        imu.time = stod(splits[4]);
-        imu.dt   = imu.time - wsec;
-        wsec     = imu.time;
-        imu.dvel << stod(splits[6]), -stod(splits[7]), stod(splits[8]);
-        imu.dvel *= acc_scale * freq;
+        imu.week = counts.week;
+        imu.time = counts.time;
+        imu.dt   = counts.dt;
+        imu.dvel << -counts.dvel[2], counts.dvel[0], counts.dvel[1];
+        imu.dvel *= format.acc_scale * format.freq;
+        imu.dtheta << -counts.dtheta[2], counts.dtheta[0], counts.dtheta[1];
+        imu.dtheta *= format.gry_scale * format.freq;
+
         accz << setiosflags(ios::fixed) << setprecision(16) << imu.dvel[0] << endl;
         accy << setiosflags(ios::fixed) << setprecision(16) << imu.dvel[1] << endl;
         accx << setiosflags(ios::fixed) << setprecision(16) << imu.dvel[2] << endl;
-
-        imu.dtheta << stod(splits[9]), -stod(splits[10]), stod(splits[11]);
-        imu.dtheta *= gyr_scale * freq;
         gyrz << setiosflags(ios::fixed) << setprecision(16) << imu.dtheta[0] << endl;
         gyry << setiosflags(ios::fixed) << setprecision(16) << imu.dtheta[1] << endl;
         gyrx << setiosflags(ios::fixed) << setprecision(16) << imu.dtheta[2] << endl;
         imudata.emplace_back(imu);
+    };
+
+    DataCache cache;
+    if (cache.openFresh(imufile, DataCache::IMU_DATA, format)) {
+        IMU counts;
+        imudata.reserve(imudata.size() + cache.size());
+        for (size_t i = 0; i < cache.size(); i++) {
+            cache.getCounts(i, counts);
+            output(counts);
+        }
+        return true;
+    }
+
+    // 没有缓存时多线程解析源文件：转换因子取1，得到与缓存相同的原始计数，重复历元的处理与逐行读取相同
+    ImuFormat raw_format;
+    raw_format.acc_scale = 1;
+    raw_format.gry_scale = 1;
+    vector<IMU> counts;
+    if (!FileIO::getIMUdataParallel(imufile, counts, true, threads, raw_format)) {
+        return false;
+    }
+    imudata.reserve(imudata.size() + counts.size());
+    for (const IMU &imu : counts) {
+        output(imu);
     }
-    accz.close();
-    accy.close();
-    accx.close();
-    gyrz.close();
-    gyry.close();
-    gyrx.close();
     return true;
 }
 
@@ -109,17 +101,45 @@ void allanAnalysis(vector<IMU> &imudata, const int &start_idx, const int &end_id
     }
 }
 
-Vector3d getInitAtt(vector<IMU> &imudata, const int &start_idx, const int &end_idx, double phi, const double &&g) {
-    Vector3d Wib_b(0.0, 0.0, 0.0);
-    Vector3d g_b(0.0, 0.0, 0.0);
-    for (int i = start_idx; i < end_idx; i++) {
-        // 计算所有角速度的和用于求均值
-        Wib_b += imudata[i].dtheta;
-        g_b -= imudata[i].dvel;
+void allanAnalysis(const ImuView &imudata, const int &bins, vector<double> &res_allan_std) {
+    res_allan_std.clear();
+    // 分块方式与上面的 allanAnalysis 相同，每块的和由 ImuView::sum 批量计算
+    vector<ImuStats> means(bins);
+    int k    = imudata.size() / bins; // 每一分块的长度
+    int size = imudata.size();
+    for (int i = 0; i < bins; i++) {
+        int first  = min(i * k, max(size - k, 0));
+        int last   = min(i * k + i, max(size - k, 0));
+        ImuStats s = imudata.sub(first, max(last - first, 0)).sum();
+        means[i].dvel   = s.dvel / k;
+        means[i].dtheta = s.dtheta / k;
     }
-    Wib_b /= (end_idx - start_idx);
-    g_b /= (end_idx - start_idx);
 
+    // 根据平均值计算Allan方差
+    Vector3d acc_tmp{0.0, 0.0, 0.0}, gry_tmp{0.0, 0.0, 0.0};
+    for (int i = 0; i < bins - 1; i++) {
+        acc_tmp += (means[i + 1].dvel - means[i].dvel).array().square().matrix();
+        gry_tmp += (means[i + 1].dtheta - means[i].dtheta).array().square().matrix();
+    }
+    acc_tmp = (acc_tmp / (2 * (bins - 1))).array().sqrt();
+    gry_tmp = (gry_tmp / (2 * (bins - 1))).array().sqrt();
+    for (auto &item : acc_tmp) {
+        res_allan_std.emplace_back(item);
+    }
+    for (auto &item : gry_tmp) {
+        res_allan_std.emplace_back(item);
+    }
+}
+
+namespace {
+/**
+ * @brief 由静止时段的角速度均值、重力均值做解析粗对准
+ *
+ * @param Wib_b b系下的平均角增量
+ * @param g_b b系下的平均重力（速度增量取反）
+ * @return Vector3d 欧拉角，按[roll,pitch,yaw]顺序
+ */
+Vector3d analyticAlignment(const Vector3d &Wib_b, const Vector3d &g_b) {
     Matrix3d A;
     A << 0, 0, 1, 0, 1, 0, 1, 0, 0;
 
@@ -131,8 +151,26 @@ Vector3d getInitAtt(vector<IMU> &imudata, const int &start_idx, const int &end_i
     B.block(2, 0, 1, 3) = tmp2.normalized().transpose();
     // cout << "B = \n" << B << endl;
     Matrix3d Cb_n = A * B;
-    cout << "Cb_n = \n" << Cb_n << endl;
     Vector3d initAtt = Rotation::matrix2euler(Cb_n);
     // Vector3d initAtt = Cb_n.eulerAngles(2,1,0);
     return initAtt;
-}
\ No newline at end of file
+}
+} // namespace
+
+Vector3d getInitAtt(vector<IMU> &imudata, const int &start_idx, const int &end_idx, double phi, const double &&g) {
+    Vector3d Wib_b(0.0, 0.0, 0.0);
+    Vector3d g_b(0.0, 0.0, 0.0);
+    for (int i = start_idx; i < end_idx; i++) {
+        // 计算所有角速度的和用于求均值
+        Wib_b += imudata[i].dtheta;
+        g_b -= imudata[i].dvel;
+    }
+    Wib_b /= (end_idx - start_idx);
+    g_b /= (end_idx - start_idx);
+    return analyticAlignment(Wib_b, g_b);
+}
+
+Vector3d getInitAtt(const ImuView &imudata) {
+    ImuStats mean = imudata.mean();
+    return analyticAlignment(mean.dtheta, -mean.dvel);
+}
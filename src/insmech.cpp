@@ -1,4 +1,5 @@
 #include "earth.hpp"
+#include "profiler.hpp"
 #include "rotation.hpp"
 
 #include "insmech.hpp"
@@ -10,7 +11,84 @@ void INSMech::insMech(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &im
     posUpdate(pvapre, pvacur, imupre, imucur);
 }
 
+void INSMech::insMechFused(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &imucur) {
+    GINS_PROFILE_SCOPE("insmech");
+    // k-2、k-1 时刻的地理参数
+    EarthTerms pre = Earth::getTerms(pvapre.pos, pvapre.vel);
+    EarthTerms cur = Earth::getTerms(pvacur.pos, pvacur.vel);
+    double dt      = imucur.dt;
+
+    // 姿态更新，使用 k-1 时刻的地理参数
+    Vector3d phik          = imucur.dtheta + imupre.dtheta.cross(imucur.dtheta) / 12.0;
+    Vector3d zetak         = (cur.wie_n + cur.wen_n) * dt;
+    const Matrix3d &cbnpre = pvacur.att.cbn; // k-1 时刻的姿态
+    Matrix3d cbn           = Rotation::rotvec2matrix(-zetak) * cbnpre * Rotation::rotvec2matrix(phik);
+
+    // 速度更新，k-1/2 时刻的地理参数和速度由 k-2、k-1 时刻外推
+    Vector3d wie_n  = 3.0 / 2.0 * cur.wie_n - 1.0 / 2.0 * pre.wie_n;
+    Vector3d wen_n  = 3.0 / 2.0 * cur.wen_n - 1.0 / 2.0 * pre.wen_n;
+    double gravity  = 3.0 / 2.0 * cur.gravity - 1.0 / 2.0 * pre.gravity;
+    Vector3d midvel = 3.0 / 2.0 * pvacur.vel - 1.0 / 2.0 * pvapre.vel;
+
+    // b系比力积分项，包含旋转效应和双子样划桨效应
+    Vector3d d_vfb = imucur.dvel + imucur.dtheta.cross(imucur.dvel) / 2.0 +
+                     imupre.dtheta.cross(imucur.dvel) / 12.0 + imupre.dvel.cross(imucur.dtheta) / 12.0;
+    Matrix3d cnn   = Matrix3d::Identity() - 0.5 * Rotation::skewSymmetric((wie_n + wen_n) * dt);
+    Vector3d d_vfn = cnn * cbnpre * d_vfb;
+    Vector3d d_vgn = (Vector3d(0, 0, gravity) - (2.0 * wie_n + wen_n).cross(midvel)) * dt;
+    Vector3d vel   = pvacur.vel + d_vfn + d_vgn;
+
+    // 位置更新，k-1 时刻的子午圈半径直接复用
+    midvel        = (vel + pvacur.vel) / 2.0;
+    Vector3d pos  = pvacur.pos;
+    pos[2]        = pvacur.pos[2] - midvel[2] * dt;
+    double midh   = (pos[2] + pvacur.pos[2]) / 2.0;
+    pos[0]        = pvacur.pos[0] + midvel[0] / (cur.rmrn(0) + midh) * dt;
+    double midphi = (pos[0] + pvacur.pos[0]) / 2.0;
+    Vector2d RmRn = Earth::getRmRn(midphi);
+    pos[1]        = pvacur.pos[1] + midvel[1] / ((RmRn(1) + midh) * cos(midphi)) * dt;
+
+    // pvapre 从 k-2 时刻更新为 k-1 时刻，pvacur 从 k-1 时刻更新为 k 时刻
+    pvapre         = pvacur;
+    pvacur.pos     = pos;
+    pvacur.vel     = vel;
+    pvacur.att.cbn = cbn;
+}
+
+void INSMech::insMechInverse(const PVA &pvapre, const PVA &pvacur, const IMU &imupre, const Matrix3d &cbn,
+                             const Vector3d &vel, IMU &imucur) {
+    // 与 insMechFused 相同的地理参数
+    EarthTerms pre = Earth::getTerms(pvapre.pos, pvapre.vel);
+    EarthTerms cur = Earth::getTerms(pvacur.pos, pvacur.vel);
+    double dt      = imucur.dt;
+
+    // 姿态：cbn = C(-zetak) * cbnpre * C(phik)，先求 phik，再由 phik = dtheta + dtheta_pre x dtheta / 12 解 dtheta
+    Vector3d zetak         = (cur.wie_n + cur.wen_n) * dt;
+    const Matrix3d &cbnpre = pvacur.att.cbn;
+    Matrix3d cphi          = cbnpre.transpose() * Rotation::rotvec2matrix(zetak) * cbn;
+    Vector3d phik          = Rotation::quaternion2vector(Rotation::matrix2quaternion(cphi));
+    imucur.dtheta = (Matrix3d::Identity() + Rotation::skewSymmetric(imupre.dtheta) / 12.0).lu().solve(phik);
+
+    // 速度：先求n系比力积分项，再由b系比力积分项与速度增量的线性关系解 dvel
+    Vector3d wie_n  = 3.0 / 2.0 * cur.wie_n - 1.0 / 2.0 * pre.wie_n;
+    Vector3d wen_n  = 3.0 / 2.0 * cur.wen_n - 1.0 / 2.0 * pre.wen_n;
+    double gravity  = 3.0 / 2.0 * cur.gravity - 1.0 / 2.0 * pre.gravity;
+    Vector3d midvel = 3.0 / 2.0 * pvacur.vel - 1.0 / 2.0 * pvapre.vel;
+    Matrix3d cnn    = Matrix3d::Identity() - 0.5 * Rotation::skewSymmetric((wie_n + wen_n) * dt);
+    Vector3d d_vgn  = (Vector3d(0, 0, gravity) - (2.0 * wie_n + wen_n).cross(midvel)) * dt;
+    Vector3d d_vfb  = (cnn * cbnpre).lu().solve(vel - pvacur.vel - d_vgn);
+    Matrix3d A      = Matrix3d::Identity() + Rotation::skewSymmetric(imucur.dtheta) / 2.0 +
+                 Rotation::skewSymmetric(imupre.dtheta) / 12.0;
+    imucur.dvel = A.lu().solve(d_vfb - imupre.dvel.cross(imucur.dtheta) / 12.0);
+}
+
+void INSMech::updateAttitude(Attitude &att) {
+    att.euler = Rotation::matrix2euler(att.cbn);
+    att.qbn   = Rotation::matrix2quaternion(att.cbn);
+}
+
 void INSMech::attUpdate(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &imucur) {
+    GINS_PROFILE_SCOPE("insmech.att");
     // 计算 k-1 时刻地理参数
     Eigen::Vector2d RmRn;
     Eigen::Vector3d wie_n, wen_n;
@@ -34,6 +112,7 @@ void INSMech::attUpdate(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &
 }
 
 void INSMech::velUpdate(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &imucur) {
+    GINS_PROFILE_SCOPE("insmech.vel");
 
     Eigen::Vector3d d_vfb, d_vfn, d_vgn, gl, midvel, midpos, wie_n, wen_n;
     Eigen::Vector3d temp1, temp2, temp3;
@@ -93,6 +172,7 @@ void INSMech::velUpdate(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &
 }
 
 void INSMech::posUpdate(PVA &pvapre, PVA &pvacur, const IMU &imupre, const IMU &imucur) {
+    GINS_PROFILE_SCOPE("insmech.pos");
 
     Eigen::Vector3d temp1, temp2, midvel;
 
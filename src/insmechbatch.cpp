@@ -0,0 +1,278 @@
+#include "insmechbatch.hpp"
+#include "earth.hpp"
+#include "insmech.hpp"
+#include <cmath>
+#include <utility>
+
+namespace {
+// 等效旋转矢量模长的平方小于该值时使用泰勒级数，级数截断误差小于 1E-18
+constexpr double SERIES_LIMIT = 0.04;
+
+// 纬度三角函数递推的历元数，之后重新直接计算一次，避免舍入误差累积
+constexpr size_t SINCOS_REFRESH = 64;
+
+/// 由 sin(x)、cos(x) 计算 sin(x+d)、cos(x+d)，d 很小时使用泰勒级数
+inline void sincosAdd(double sinx, double cosx, double d, double &sinres, double &cosres) {
+    double d2   = d * d;
+    double sind = d * (1 - d2 / 6 * (1 - d2 / 20));
+    double cosd = 1 - d2 / 2 * (1 - d2 / 12);
+    sinres      = sinx * cosd + cosx * sind;
+    cosres      = cosx * cosd - sinx * sind;
+}
+
+/// sin(x)/x 和 (1-cos(x))/x^2 的泰勒级数，t = x^2
+inline void rotvecCoefSeries(double t, double &a, double &b) {
+    a = 1 - t / 6 * (1 - t / 20 * (1 - t / 42 * (1 - t / 72 * (1 - t / 110))));
+    b = 0.5 * (1 - t / 12 * (1 - t / 30 * (1 - t / 56 * (1 - t / 90 * (1 - t / 132)))));
+}
+
+/// sin(x)/x 和 (1-cos(x))/x^2，t = x^2
+inline void rotvecCoef(double t, double &a, double &b) {
+    double x = sqrt(t);
+    a        = sin(x) / x;
+    b        = (1 - cos(x)) / t;
+}
+
+/// 按行存储的3x3矩阵，在向量化循环中按值传递，以便编译器把元素放在寄存器中
+struct Mat3 {
+    double m[9];
+};
+
+/// 等效旋转矢量 v 对应的方向余弦矩阵 I + a*(v×) + b*(v×)^2
+inline Mat3 rotvec2matrix(double v0, double v1, double v2, double a, double b) {
+    double t = v0 * v0 + v1 * v1 + v2 * v2;
+    return {{1 + b * (v0 * v0 - t), -a * v2 + b * v0 * v1, a * v1 + b * v0 * v2, a * v2 + b * v1 * v0,
+             1 + b * (v1 * v1 - t), -a * v0 + b * v1 * v2, -a * v1 + b * v2 * v0, a * v0 + b * v2 * v1,
+             1 + b * (v2 * v2 - t)}};
+}
+
+/// 3x3 矩阵相乘 x * y
+inline Mat3 matmul(const Mat3 &x, const Mat3 &y) {
+    Mat3 res;
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            res.m[r * 3 + c] = x.m[r * 3] * y.m[c] + x.m[r * 3 + 1] * y.m[3 + c] + x.m[r * 3 + 2] * y.m[6 + c];
+        }
+    }
+    return res;
+}
+} // namespace
+
+INSMechBatch::INSMechBatch(size_t lanes)
+    : lanes_(lanes)
+    , stride_((lanes + 7) / 8 * 8) {
+    data_.assign(stride_ * COLUMNS, 0.0);
+    for (int c = 0; c < COLUMNS; c++) {
+        cols_[c] = data_.data() + c * stride_;
+    }
+}
+
+void INSMechBatch::initialize(size_t lane, const PVA &pvapre, const PVA &pvacur, const IMU &imupre) {
+    EarthTerms pre = Earth::getTerms(pvapre.pos, pvapre.vel);
+    EarthTerms cur = Earth::getTerms(pvacur.pos, pvacur.vel);
+    for (int a = 0; a < 3; a++) {
+        col(LAT + a)[lane]   = pvacur.pos[a];
+        col(VN + a)[lane]    = pvacur.vel[a];
+        col(PVN + a)[lane]   = pvapre.vel[a];
+        col(WENN + a)[lane]  = cur.wen_n[a];
+        col(PWENN + a)[lane] = pre.wen_n[a];
+        col(PDTH0 + a)[lane] = imupre.dtheta[a];
+        col(PDV0 + a)[lane]  = imupre.dvel[a];
+        for (int b = 0; b < 3; b++) {
+            col(C00 + a * 3 + b)[lane] = pvacur.att.cbn(a, b);
+        }
+    }
+    col(SINLAT)[lane] = sin(pvacur.pos[0]);
+    col(COSLAT)[lane] = cos(pvacur.pos[0]);
+    col(RM)[lane]     = cur.rmrn[0];
+    col(RN)[lane]     = cur.rmrn[1];
+    col(WIEN)[lane]   = cur.wie_n[0];
+    col(WIED)[lane]   = cur.wie_n[2];
+    col(GRAV)[lane]   = cur.gravity;
+    col(PWIEN)[lane]  = pre.wie_n[0];
+    col(PWIED)[lane]  = pre.wie_n[2];
+    col(PGRAV)[lane]  = pre.gravity;
+}
+
+void INSMechBatch::setIMU(size_t lane, const IMU &imucur) {
+    col(DT)[lane] = imucur.dt;
+    for (int a = 0; a < 3; a++) {
+        col(DTH0 + a)[lane] = imucur.dtheta[a];
+        col(DV0 + a)[lane]  = imucur.dvel[a];
+    }
+}
+
+void INSMechBatch::update() {
+    const size_t n = lanes_;
+    const double *dt = col(DT), *dth0 = col(DTH0), *dth1 = col(DTH1), *dth2 = col(DTH2);
+    const double *dv0 = col(DV0), *dv1 = col(DV1), *dv2 = col(DV2);
+    const double *pdth0 = col(PDTH0), *pdth1 = col(PDTH1), *pdth2 = col(PDTH2);
+    const double *pdv0 = col(PDV0), *pdv1 = col(PDV1), *pdv2 = col(PDV2);
+    const double *wien = col(WIEN), *wied = col(WIED), *wenn = col(WENN), *wene = col(WENE), *wend = col(WEND);
+    const double *pwien = col(PWIEN), *pwied = col(PWIED), *pwenn = col(PWENN), *pwene = col(PWENE);
+    const double *pwend = col(PWEND), *grav = col(GRAV), *pgrav = col(PGRAV);
+    const double *rm = col(RM), *sinlat = col(SINLAT), *coslat = col(COSLAT);
+    double *phi0 = col(PHI0), *phi1 = col(PHI1), *phi2 = col(PHI2), *cbba = col(CBBA), *cbbb = col(CBBB);
+    double *zeta0 = col(ZETA0), *zeta1 = col(ZETA1), *zeta2 = col(ZETA2), *cnna = col(CNNA), *cnnb = col(CNNB);
+    double *lat = col(LAT), *lon = col(LON), *hgt = col(HGT);
+    double *vn = col(VN), *ve = col(VE), *vd = col(VD), *pvn = col(PVN), *pve = col(PVE), *pvd = col(PVD);
+    double *c00 = col(C00), *c01 = col(C01), *c02 = col(C02), *c10 = col(C10), *c11 = col(C11), *c12 = col(C12);
+    double *c20 = col(C20), *c21 = col(C21), *c22 = col(C22);
+
+    // b系等效旋转矢量（含圆锥误差补偿）和n系等效旋转矢量，及其转换为方向余弦矩阵的系数
+#pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        phi0[i]  = dth0[i] + (pdth1[i] * dth2[i] - pdth2[i] * dth1[i]) / 12.0;
+        phi1[i]  = dth1[i] + (pdth2[i] * dth0[i] - pdth0[i] * dth2[i]) / 12.0;
+        phi2[i]  = dth2[i] + (pdth0[i] * dth1[i] - pdth1[i] * dth0[i]) / 12.0;
+        zeta0[i] = (wien[i] + wenn[i]) * dt[i];
+        zeta1[i] = wene[i] * dt[i];
+        zeta2[i] = (wied[i] + wend[i]) * dt[i];
+        rotvecCoefSeries(phi0[i] * phi0[i] + phi1[i] * phi1[i] + phi2[i] * phi2[i], cbba[i], cbbb[i]);
+        rotvecCoefSeries(zeta0[i] * zeta0[i] + zeta1[i] * zeta1[i] + zeta2[i] * zeta2[i], cnna[i], cnnb[i]);
+    }
+
+    // 旋转角超出级数适用范围的轨迹（高动态）改用三角函数
+    for (size_t i = 0; i < n; i++) {
+        double t = phi0[i] * phi0[i] + phi1[i] * phi1[i] + phi2[i] * phi2[i];
+        if (t >= SERIES_LIMIT) {
+            rotvecCoef(t, cbba[i], cbbb[i]);
+        }
+        t = zeta0[i] * zeta0[i] + zeta1[i] * zeta1[i] + zeta2[i] * zeta2[i];
+        if (t >= SERIES_LIMIT) {
+            rotvecCoef(t, cnna[i], cnnb[i]);
+        }
+    }
+
+#pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        // 姿态更新，cbn = cnn * cbn * cbb
+        Mat3 cold = {{c00[i], c01[i], c02[i], c10[i], c11[i], c12[i], c20[i], c21[i], c22[i]}};
+        Mat3 cbb  = rotvec2matrix(phi0[i], phi1[i], phi2[i], cbba[i], cbbb[i]);
+        Mat3 cnn  = rotvec2matrix(-zeta0[i], -zeta1[i], -zeta2[i], cnna[i], cnnb[i]);
+        Mat3 cnew = matmul(cnn, matmul(cold, cbb));
+        c00[i] = cnew.m[0], c01[i] = cnew.m[1], c02[i] = cnew.m[2];
+        c10[i] = cnew.m[3], c11[i] = cnew.m[4], c12[i] = cnew.m[5];
+        c20[i] = cnew.m[6], c21[i] = cnew.m[7], c22[i] = cnew.m[8];
+
+        // k-1/2 时刻的地理参数和速度由 k-2、k-1 时刻外推
+        double wie_n  = 1.5 * wien[i] - 0.5 * pwien[i];
+        double wie_d  = 1.5 * wied[i] - 0.5 * pwied[i];
+        double wen_n  = 1.5 * wenn[i] - 0.5 * pwenn[i];
+        double wen_e  = 1.5 * wene[i] - 0.5 * pwene[i];
+        double wen_d  = 1.5 * wend[i] - 0.5 * pwend[i];
+        double g      = 1.5 * grav[i] - 0.5 * pgrav[i];
+        double midv_n = 1.5 * vn[i] - 0.5 * pvn[i];
+        double midv_e = 1.5 * ve[i] - 0.5 * pve[i];
+        double midv_d = 1.5 * vd[i] - 0.5 * pvd[i];
+
+        // b系比力积分项，包含旋转效应和双子样划桨效应
+        double f0 = dv0[i] + (dth1[i] * dv2[i] - dth2[i] * dv1[i]) / 2.0 +
+                    (pdth1[i] * dv2[i] - pdth2[i] * dv1[i]) / 12.0 + (pdv1[i] * dth2[i] - pdv2[i] * dth1[i]) / 12.0;
+        double f1 = dv1[i] + (dth2[i] * dv0[i] - dth0[i] * dv2[i]) / 2.0 +
+                    (pdth2[i] * dv0[i] - pdth0[i] * dv2[i]) / 12.0 + (pdv2[i] * dth0[i] - pdv0[i] * dth2[i]) / 12.0;
+        double f2 = dv2[i] + (dth0[i] * dv1[i] - dth1[i] * dv0[i]) / 2.0 +
+                    (pdth0[i] * dv1[i] - pdth1[i] * dv0[i]) / 12.0 + (pdv0[i] * dth1[i] - pdv1[i] * dth0[i]) / 12.0;
+
+        // 比力积分项投影到n系，(I - 0.5*(w×)) * cbn * f
+        double fn = cold.m[0] * f0 + cold.m[1] * f1 + cold.m[2] * f2;
+        double fe = cold.m[3] * f0 + cold.m[4] * f1 + cold.m[5] * f2;
+        double fd = cold.m[6] * f0 + cold.m[7] * f1 + cold.m[8] * f2;
+        double w0 = (wie_n + wen_n) * dt[i], w1 = wen_e * dt[i], w2 = (wie_d + wen_d) * dt[i];
+        double dvn = fn - 0.5 * (w1 * fd - w2 * fe);
+        double dve = fe - 0.5 * (w2 * fn - w0 * fd);
+        double dvd = fd - 0.5 * (w0 * fe - w1 * fn);
+
+        // 重力/哥氏积分项
+        double c0 = 2 * wie_n + wen_n, c1 = wen_e, c2 = 2 * wie_d + wen_d;
+        dvn -= (c1 * midv_d - c2 * midv_e) * dt[i];
+        dve -= (c2 * midv_n - c0 * midv_d) * dt[i];
+        dvd += (g - (c0 * midv_e - c1 * midv_n)) * dt[i];
+
+        // 速度更新，新速度暂存在 k-2 时刻速度的列中
+        double vn_new = vn[i] + dvn, ve_new = ve[i] + dve, vd_new = vd[i] + dvd;
+        pvn[i] = vn_new;
+        pve[i] = ve_new;
+        pvd[i] = vd_new;
+
+        // 位置更新
+        double mv_n = (vn_new + vn[i]) / 2.0, mv_e = (ve_new + ve[i]) / 2.0, mv_d = (vd_new + vd[i]) / 2.0;
+        double h    = hgt[i] - mv_d * dt[i];
+        double midh = (h + hgt[i]) / 2.0;
+        double phi  = lat[i] + mv_n / (rm[i] + midh) * dt[i];
+
+        // 半历元纬度的三角函数，历元间纬度变化很小，由 k-1 时刻纬度的三角函数递推
+        double sinmid, cosmid;
+        sincosAdd(sinlat[i], coslat[i], (phi - lat[i]) / 2.0, sinmid, cosmid);
+        double rnmid  = Earth::RA / sqrt(1 - Earth::E1 * sinmid * sinmid);
+        lon[i] += mv_e / ((rnmid + midh) * cosmid) * dt[i];
+        phi0[i] = phi - lat[i]; // 纬度增量暂存在 PHI0 列中，用于递推新纬度的三角函数
+        lat[i]  = phi;
+        hgt[i]  = h;
+    }
+
+    // k-1 时刻的速度、地理参数、IMU数据变为 k-2 时刻的
+    swapColumns(VN, PVN, 3);
+    swapColumns(WIEN, PWIEN, 6);
+    swapColumns(DTH0, PDTH0, 6);
+
+    // 新纬度的三角函数同样递推，每隔 SINCOS_REFRESH 个历元直接计算一次
+    double *sinlat_new = col(SINLAT), *coslat_new = col(COSLAT);
+    const double *dlat = col(PHI0);
+    if (++epoch_ % SINCOS_REFRESH == 0) {
+        for (size_t i = 0; i < n; i++) {
+            sinlat_new[i] = sin(lat[i]);
+            coslat_new[i] = cos(lat[i]);
+        }
+    } else {
+#pragma omp simd
+        for (size_t i = 0; i < n; i++) {
+            sincosAdd(sinlat_new[i], coslat_new[i], dlat[i], sinlat_new[i], coslat_new[i]);
+        }
+    }
+    updateTerms();
+}
+
+void INSMechBatch::updateTerms() {
+    const size_t n       = lanes_;
+    const double *sinlat = col(SINLAT), *coslat = col(COSLAT), *hgt = col(HGT), *vn = col(VN), *ve = col(VE);
+    double *rm = col(RM), *rn = col(RN), *wien = col(WIEN), *wied = col(WIED);
+    double *wenn = col(WENN), *wene = col(WENE), *wend = col(WEND), *grav = col(GRAV);
+
+    // 与 Earth::getTerms 相同
+#pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        double sin2    = sinlat[i] * sinlat[i];
+        double tmp     = 1 - Earth::E1 * sin2;
+        double sqrttmp = sqrt(tmp);
+        rm[i]          = Earth::RA * (1 - Earth::E1) / (sqrttmp * tmp);
+        rn[i]          = Earth::RA / sqrttmp;
+        double rmh     = rm[i] + hgt[i];
+        double rnh     = rn[i] + hgt[i];
+        wien[i]        = Earth::WIE * coslat[i];
+        wied[i]        = -Earth::WIE * sinlat[i];
+        wenn[i]        = ve[i] / rnh;
+        wene[i]        = -vn[i] / rmh;
+        wend[i]        = -ve[i] * sinlat[i] / coslat[i] / rnh;
+        grav[i]        = Earth::normalGravity(sin2, hgt[i]);
+    }
+}
+
+void INSMechBatch::swapColumns(int first, int second, int count) {
+    for (int c = 0; c < count; c++) {
+        swap(cols_[first + c], cols_[second + c]);
+    }
+}
+
+PVA INSMechBatch::state(size_t lane) const {
+    PVA pva;
+    for (int a = 0; a < 3; a++) {
+        pva.pos[a] = col(LAT + a)[lane];
+        pva.vel[a] = col(VN + a)[lane];
+        for (int b = 0; b < 3; b++) {
+            pva.att.cbn(a, b) = col(C00 + a * 3 + b)[lane];
+        }
+    }
+    INSMech::updateAttitude(pva.att);
+    return pva;
+}
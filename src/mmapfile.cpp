@@ -0,0 +1,57 @@
+#include "mmapfile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MmapFile::open(const string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const char *>(addr);
+    }
+    // 映射建立后文件描述符即可关闭，映射区域依然有效
+    ::close(fd);
+    is_open_ = true;
+    return true;
+}
+
+void MmapFile::close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char *>(data_), size_);
+    }
+    data_    = nullptr;
+    size_    = 0;
+    is_open_ = false;
+}
+
+void MmapFile::adviseSequential() const {
+    if (data_ != nullptr) {
+        madvise(const_cast<char *>(data_), size_, MADV_SEQUENTIAL);
+    }
+}
+
+void MmapFile::release(size_t offset, size_t length) const {
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t last              = offset + length < size_ ? offset + length : size_;
+    size_t first             = (offset + page - 1) / page * page;
+    last                     = last / page * page;
+    if (data_ != nullptr && first < last) {
+        madvise(const_cast<char *>(data_ + first), last - first, MADV_DONTNEED);
+    }
+}
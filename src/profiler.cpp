@@ -0,0 +1,165 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+atomic<bool> Profiler::enabled_{false};
+
+namespace {
+// 已注册的阶段，deque 追加元素时不移动已有元素
+mutex g_mutex;
+deque<Profiler::Stage> g_stages;
+
+/// 第 b 个桶的上界（ns）
+inline uint64_t upperBound(int b) {
+    return b >= 63 ? UINT64_MAX : (uint64_t(2) << b) - 1;
+}
+
+/// 按总耗时从大到小排列的计时阶段和按注册顺序排列的计数，只包含有记录的阶段
+void sortedStages(vector<const Profiler::Stage *> &timers, vector<const Profiler::Stage *> &counters) {
+    lock_guard<mutex> lock(g_mutex);
+    for (const auto &stage : g_stages) {
+        if (stage.calls.load(memory_order_relaxed) == 0) {
+            continue;
+        }
+        (stage.kind == Profiler::TIMER ? timers : counters).push_back(&stage);
+    }
+    stable_sort(timers.begin(), timers.end(), [](const Profiler::Stage *a, const Profiler::Stage *b) {
+        return a->total.load(memory_order_relaxed) > b->total.load(memory_order_relaxed);
+    });
+}
+
+/// JSON字符串，阶段名称只含ASCII字符，只需转义引号和反斜杠
+string jsonString(const string &s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+} // namespace
+
+void Profiler::Stage::record(uint64_t ns) {
+    calls.fetch_add(1, memory_order_relaxed);
+    total.fetch_add(ns, memory_order_relaxed);
+    buckets[ns == 0 ? 0 : bit_width(ns) - 1].fetch_add(1, memory_order_relaxed);
+    uint64_t prev = max.load(memory_order_relaxed);
+    while (ns > prev && !max.compare_exchange_weak(prev, ns, memory_order_relaxed)) {
+    }
+}
+
+uint64_t Profiler::Stage::percentile(double q) const {
+    uint64_t n = calls.load(memory_order_relaxed);
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(q * n + 0.5), 1);
+    uint64_t sum  = 0;
+    uint64_t mx   = max.load(memory_order_relaxed);
+    for (int b = 0; b < BUCKETS; b++) {
+        sum += buckets[b].load(memory_order_relaxed);
+        if (sum >= rank) {
+            return std::min(upperBound(b), mx);
+        }
+    }
+    return mx;
+}
+
+Profiler::Stage &Profiler::stage(const char *name, Kind kind) {
+    lock_guard<mutex> lock(g_mutex);
+    for (auto &stage : g_stages) {
+        if (stage.name == name && stage.kind == kind) {
+            return stage;
+        }
+    }
+    return g_stages.emplace_back(name, kind);
+}
+
+void Profiler::reset() {
+    lock_guard<mutex> lock(g_mutex);
+    for (auto &stage : g_stages) {
+        stage.calls.store(0, memory_order_relaxed);
+        stage.total.store(0, memory_order_relaxed);
+        stage.max.store(0, memory_order_relaxed);
+        for (auto &bucket : stage.buckets) {
+            bucket.store(0, memory_order_relaxed);
+        }
+    }
+}
+
+void Profiler::report(ostream &os) {
+    vector<const Stage *> timers, counters;
+    sortedStages(timers, counters);
+
+    auto us              = [](uint64_t ns) { return ns / 1000.0; };
+    ios::fmtflags flags  = os.flags();
+    streamsize precision = os.precision();
+    os << "各阶段耗时（us，包含嵌套阶段）：" << endl;
+    // 中文按两列宽对齐，表头直接写出空格
+    os << "阶段                            次数        总耗时        平均         p50         p99        最大" << endl;
+    os << fixed << setprecision(3);
+    for (const Stage *stage : timers) {
+        uint64_t calls = stage->calls.load(memory_order_relaxed);
+        uint64_t total = stage->total.load(memory_order_relaxed);
+        os << left << setw(24) << stage->name << right << setw(12) << calls << setw(14) << us(total) << setw(12)
+           << us(total) / calls << setw(12) << us(stage->percentile(0.5)) << setw(12) << us(stage->percentile(0.99))
+           << setw(12) << us(stage->max.load(memory_order_relaxed)) << endl;
+    }
+    for (const Stage *stage : counters) {
+        os << left << setw(24) << stage->name << right << setw(12) << stage->calls.load(memory_order_relaxed)
+           << " 次计数，合计 " << stage->total.load(memory_order_relaxed) << endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+bool Profiler::writeJson(const string &path) {
+    vector<const Stage *> timers, counters;
+    sortedStages(timers, counters);
+
+    ofstream ofs(path);
+    if (!ofs.is_open()) {
+        cerr << "性能统计文件：" << path << " 创建失败！" << endl;
+        return false;
+    }
+    ofs << "{\n  \"stages\": [";
+    for (size_t i = 0; i < timers.size(); i++) {
+        const Stage *stage = timers[i];
+        ofs << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(stage->name)
+            << ", \"calls\": " << stage->calls.load(memory_order_relaxed)
+            << ", \"total_ns\": " << stage->total.load(memory_order_relaxed)
+            << ", \"max_ns\": " << stage->max.load(memory_order_relaxed) << ", \"p50_ns\": " << stage->percentile(0.5)
+            << ", \"p99_ns\": " << stage->percentile(0.99) << ", \"histogram\": [";
+        // 直方图只输出非空的桶：[桶上界（ns），次数]
+        bool first = true;
+        for (int b = 0; b < BUCKETS; b++) {
+            uint64_t count = stage->buckets[b].load(memory_order_relaxed);
+            if (count != 0) {
+                ofs << (first ? "" : ", ") << "[" << upperBound(b) << ", " << count << "]";
+                first = false;
+            }
+        }
+        ofs << "]}";
+    }
+    ofs << "\n  ],\n  \"counters\": [";
+    for (size_t i = 0; i < counters.size(); i++) {
+        ofs << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(counters[i]->name)
+            << ", \"events\": " << counters[i]->calls.load(memory_order_relaxed)
+            << ", \"total\": " << counters[i]->total.load(memory_order_relaxed) << "}";
+    }
+    ofs << "\n  ]\n}\n";
+    ofs.close();
+    if (!ofs) {
+        cerr << "性能统计文件：" << path << " 写入失败！" << endl;
+        return false;
+    }
+    return true;
+}
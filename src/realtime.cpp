@@ -0,0 +1,345 @@
+#include "realtime.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+uint64_t FrameIO::now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+DataFrame FrameIO::toFrame(const IMU &imu, uint64_t stamp) {
+    DataFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic     = MAGIC;
+    frame.type      = FRAME_IMU;
+    frame.stamp     = stamp;
+    frame.week      = imu.week;
+    frame.time      = imu.time;
+    frame.values[0] = imu.dt;
+    copy(imu.dtheta.data(), imu.dtheta.data() + 3, frame.values + 1);
+    copy(imu.dvel.data(), imu.dvel.data() + 3, frame.values + 4);
+    return frame;
+}
+
+DataFrame FrameIO::toFrame(const GNSS &gnss, uint64_t stamp) {
+    DataFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = MAGIC;
+    frame.type  = FRAME_GNSS;
+    frame.stamp = stamp;
+    frame.week  = gnss.week;
+    frame.time  = gnss.time;
+    copy(gnss.blh.data(), gnss.blh.data() + 3, frame.values);
+    copy(gnss.posstd.data(), gnss.posstd.data() + 3, frame.values + 3);
+    copy(gnss.vel.data(), gnss.vel.data() + 3, frame.values + 6);
+    copy(gnss.velstd.data(), gnss.velstd.data() + 3, frame.values + 9);
+    return frame;
+}
+
+void FrameIO::fromFrame(const DataFrame &frame, IMU &imu) {
+    imu.week = static_cast<int>(frame.week);
+    imu.time = frame.time;
+    imu.dt   = frame.values[0];
+    imu.dtheta << frame.values[1], frame.values[2], frame.values[3];
+    imu.dvel << frame.values[4], frame.values[5], frame.values[6];
+}
+
+void FrameIO::fromFrame(const DataFrame &frame, GNSS &gnss) {
+    gnss.week = static_cast<int>(frame.week);
+    gnss.time = frame.time;
+    gnss.blh << frame.values[0], frame.values[1], frame.values[2];
+    gnss.posstd << frame.values[3], frame.values[4], frame.values[5];
+    gnss.vel << frame.values[6], frame.values[7], frame.values[8];
+    gnss.velstd << frame.values[9], frame.values[10], frame.values[11];
+    gnss.isvalid = true;
+}
+
+int FrameIO::openSource(const string &source) {
+    if (source == "-") {
+        return STDIN_FILENO;
+    }
+    if (source.rfind("unix:", 0) == 0) {
+        string path = source.substr(5);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            cerr << "UNIX域套接字路径过长：" << path << endl;
+            return -1;
+        }
+        memcpy(addr.sun_path, path.c_str(), path.size());
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+            cerr << "UNIX域套接字：" << path << " 连接失败：" << strerror(errno) << endl;
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+        return fd;
+    }
+    // 命名管道在写入端打开之前会阻塞
+    int fd = open(source.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "数据源：" << source << " 打开失败：" << strerror(errno) << endl;
+    }
+    return fd;
+}
+
+int FrameIO::openSink(const string &dest) {
+    if (dest == "-") {
+        return STDOUT_FILENO;
+    }
+    if (dest.rfind("unix:", 0) == 0) {
+        string path = dest.substr(5);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            cerr << "UNIX域套接字路径过长：" << path << endl;
+            return -1;
+        }
+        memcpy(addr.sun_path, path.c_str(), path.size());
+        unlink(path.c_str());
+        int server = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server < 0 || bind(server, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(server, 1) != 0) {
+            cerr << "UNIX域套接字：" << path << " 创建失败：" << strerror(errno) << endl;
+            if (server >= 0) {
+                close(server);
+            }
+            return -1;
+        }
+        cerr << "等待接收方连接 " << path << " ..." << endl;
+        int fd = accept(server, nullptr, nullptr);
+        close(server);
+        unlink(path.c_str());
+        if (fd < 0) {
+            cerr << "UNIX域套接字：" << path << " 接受连接失败：" << strerror(errno) << endl;
+        }
+        return fd;
+    }
+    // 命名管道在读取端打开之前会阻塞
+    int fd = open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cerr << "输出目标：" << dest << " 打开失败：" << strerror(errno) << endl;
+    }
+    return fd;
+}
+
+bool FrameIO::isSocket(int fd) {
+    struct stat st;
+    return fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+bool FrameIO::writeFrame(int fd, const DataFrame &frame) {
+    const char *data = reinterpret_cast<const char *>(&frame);
+    size_t done      = 0;
+    while (done < sizeof(frame)) {
+        ssize_t n = write(fd, data + done, sizeof(frame) - done);
+        if (n > 0) {
+            done += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+DataFrame FrameIO::ackFrame(const DataFrame &frame) {
+    DataFrame ack;
+    memset(&ack, 0, sizeof(ack));
+    ack.magic = MAGIC;
+    ack.type  = FRAME_ACK;
+    ack.stamp = frame.stamp;
+    ack.week  = frame.week;
+    ack.time  = frame.time;
+    return ack;
+}
+
+bool FrameIO::readFrame(int fd, DataFrame &frame) {
+    char *data  = reinterpret_cast<char *>(&frame);
+    size_t done = 0;
+    while (done < sizeof(frame)) {
+        ssize_t n = read(fd, data + done, sizeof(frame) - done);
+        if (n > 0) {
+            done += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n < 0 || done > 0) {
+                cerr << "实时数据读取中断！" << endl;
+            }
+            return false;
+        }
+    }
+    if (frame.magic != MAGIC || frame.type < FRAME_IMU || frame.type > FRAME_ACK) {
+        cerr << "实时数据帧格式错误！" << endl;
+        return false;
+    }
+    return frame.type != FRAME_END;
+}
+
+int LatencyHistogram::bucket(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return static_cast<int>(ns);
+    }
+    // 最高位所在的2的整数次幂区间，再取其后4位作为区间内的桶
+    int exponent = bit_width(ns) - 1;
+    int sub      = static_cast<int>((ns >> (exponent - 4)) & (SUB_BUCKETS - 1));
+    return min((exponent - 3) * SUB_BUCKETS + sub, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::upperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int exponent = bucket / SUB_BUCKETS + 3;
+    int sub      = bucket % SUB_BUCKETS;
+    return ((uint64_t(SUB_BUCKETS + sub + 1)) << (exponent - 4)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    counts_[bucket(ns)]++;
+    count_++;
+    max_ = std::max(max_, ns);
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(ceil(q * count_));
+    uint64_t sum  = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        sum += counts_[b];
+        if (sum >= std::max<uint64_t>(rank, 1)) {
+            return std::min(upperBound(b), max_);
+        }
+    }
+    return max_;
+}
+
+void LatencyHistogram::report(ostream &os, const string &name) const {
+    auto us              = [](uint64_t ns) { return ns / 1000.0; };
+    ios::fmtflags flags  = os.flags();
+    streamsize precision = os.precision();
+    os << fixed << setprecision(1) << name << "：" << count_ << " 个历元，p50 " << us(percentile(0.5)) << " us，p99 "
+       << us(percentile(0.99)) << " us，p99.9 " << us(percentile(0.999)) << " us，最大 " << us(max_) << " us" << endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+bool RealtimeNavigator::configureThread(const RealtimeOptions &options) {
+    bool ok = true;
+    if (options.lockmemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        cerr << "锁定内存失败：" << strerror(errno) << endl;
+        ok = false;
+    }
+    if (options.priority > 0) {
+        sched_param param{};
+        param.sched_priority = options.priority;
+        int err              = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            cerr << "设置实时优先级失败：" << strerror(err) << endl;
+            ok = false;
+        }
+    }
+    if (options.cpu >= 0) {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options.cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0) {
+            cerr << "绑定CPU核心失败：" << strerror(err) << endl;
+            ok = false;
+        }
+#else
+        cerr << "当前平台不支持绑定CPU核心！" << endl;
+        ok = false;
+#endif
+    }
+
+    // 预先访问一段栈空间，处理过程中第一次用到更深的栈时不再缺页；锁定内存时这些页也一并锁定
+    constexpr size_t STACK_PREFAULT = 256 * 1024;
+    // 写入后再读回，读出的值交给空的内联汇编，编译器不能省略这段访问，也不会警告数组未使用
+    volatile char stack[STACK_PREFAULT];
+    char touched = 0;
+    for (size_t i = 0; i < STACK_PREFAULT; i += 4096) {
+        stack[i] = 0;
+        touched += stack[i];
+    }
+    asm volatile("" ::"r"(touched));
+    return ok;
+}
+
+RealtimeNavigator::RealtimeNavigator(const GINSOptions &options, ResultSink &sink)
+    : options_(options)
+    , sink_(sink) {
+}
+
+bool RealtimeNavigator::process(const DataFrame &frame) {
+    if (frame.type == FrameIO::FRAME_GNSS) {
+        GNSS gnss;
+        FrameIO::fromFrame(frame, gnss);
+        if (!engine_) {
+            if (!has_imu_) {
+                return false;
+            }
+            // 与批处理相同：初始位置、速度取自第一个GNSS数据，初始姿态取自配置文件
+            options_.initstate.pav.pos = gnss.blh;
+            options_.initstate.pav.vel = gnss.vel;
+            engine_.emplace(options_);
+            engine_->addImuData(imupre_);
+        } else if (gnss.time < engine_->timestamp()) {
+            late_gnss_++;
+        } else {
+            engine_->addGnssData(gnss);
+        }
+        return false;
+    }
+
+    if (frame.type != FrameIO::FRAME_IMU) {
+        return false;
+    }
+    IMU imu;
+    FrameIO::fromFrame(frame, imu);
+    if (!engine_) {
+        imupre_  = imu;
+        has_imu_ = true;
+        return false;
+    }
+    if (imu.dvel.norm() < 1E-10 || imu.dtheta.norm() < 1E-10) {
+        return false;
+    }
+    engine_->addImuData(imu);
+    engine_->newImuProcess();
+
+    NavState state = engine_->getNavState();
+    if (ResultSink::isStdEpoch(imu.time, options_.stdinterval, stdtime_)) {
+        GIEngine::StateVector std = engine_->getCovariance().diagonal().cwiseMax(0).cwiseSqrt();
+        sink_.push(ResultSink::navResult(imu.week, imu.time, state.pav, &std, engine_->gnssUpdated()));
+    } else {
+        sink_.push(ResultSink::navResult(imu.week, imu.time, state.pav, nullptr, engine_->gnssUpdated()));
+    }
+    epochs_++;
+    return true;
+}
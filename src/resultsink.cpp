@@ -0,0 +1,270 @@
+#include "resultsink.hpp"
+#include "earth.hpp"
+#include "profiler.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+/// 以定点格式追加一个数值，前面加空格分隔（行首除外）
+inline void append(string &buf, double value, int precision, bool first = false) {
+    char text[64];
+    if (!first) {
+        buf.push_back(' ');
+    }
+    auto result = to_chars(text, text + sizeof(text), value, chars_format::fixed, precision);
+    if (result.ec != errc()) {
+        // 数值过大时定点格式放不下，改用科学计数法
+        result = to_chars(text, text + sizeof(text), value, chars_format::scientific, precision);
+    }
+    buf.append(text, result.ptr);
+}
+
+inline void append(string &buf, const Vector3d &v, int precision, double scale = 1.0) {
+    append(buf, v[0] * scale, precision);
+    append(buf, v[1] * scale, precision);
+    append(buf, v[2] * scale, precision);
+}
+
+/// result.txt 的一行，与原先逐历元 << 输出的格式相同
+inline void appendResult(string &buf, const NavResult &res) {
+    append(buf, res.time, 8, true);
+    append(buf, res.blh[0] * R2D, 8);
+    append(buf, res.blh[1] * R2D, 8);
+    append(buf, res.blh[2], 8);
+    append(buf, res.vel, 8);
+    append(buf, res.euler, 8, R2D);
+    buf.push_back('\n');
+}
+
+/// NED 转 ENU
+inline Vector3d ned2enu(const Vector3d &ned) {
+    return {ned[1], ned[0], -ned[2]};
+}
+
+/// NED 标准差按 ENU 顺序排列
+inline Vector3d std2enu(const Vector3d &std) {
+    return {std[1], std[0], std[2]};
+}
+} // namespace
+
+ResultSink::ResultSink(const GINSOptions &options, const string &suffix, bool echo)
+    : decimation_(max(options.decimation, 1))
+    , gnssonly_(options.gnssonly)
+    , binary_(options.binaryoutput)
+    , echo_(echo) {
+    lateststd_.posstd.setZero();
+    lateststd_.velstd.setZero();
+    lateststd_.attstd.setZero();
+
+    if (binary_) {
+        ok_ = traj_.open(options.outputpath + "/result" + suffix + ".traj", options.stdinterval > 0);
+        if (ok_) {
+            writer_ = thread(&ResultSink::run, this);
+        }
+        return;
+    }
+
+    const char *names[FILE_COUNT] = {"result", "navres", "blhres", "navxyz", "navresstd"};
+    for (int i = 0; i < FILE_COUNT; i++) {
+        filenames_[i] = options.outputpath + "/" + names[i] + suffix + ".txt";
+        files_[i].open(filenames_[i], ios::out | ios::binary);
+        if (!files_[i].is_open()) {
+            cerr << "结果文件：" << filenames_[i] << " 创建失败！" << endl;
+            ok_ = false;
+            return;
+        }
+        buffers_[i].reserve(BUFFER_SIZE + 1024);
+    }
+    buffers_[BLHRES] = "% week sow lat(deg) lon(deg) h(m) sdn sde sdu(m) vn ve vd(m/s) svn sve svd(m/s)\n";
+
+    writer_ = thread(&ResultSink::run, this);
+}
+
+ResultSink::~ResultSink() {
+    close();
+}
+
+NavResult ResultSink::navResult(int week, double time, const PVA &pva, const GIEngine::StateVector *std, bool gnss) {
+    NavResult result;
+    result.week   = week;
+    result.time   = time;
+    result.blh    = pva.pos;
+    result.vel    = pva.vel;
+    result.euler  = pva.att.euler;
+    result.hasstd = std != nullptr;
+    result.gnss   = gnss;
+    if (std != nullptr) {
+        result.posstd = std->segment<3>(GIEngine::P_ID);
+        result.velstd = std->segment<3>(GIEngine::V_ID);
+        result.attstd = std->segment<3>(GIEngine::PHI_ID);
+    }
+    return result;
+}
+
+bool ResultSink::isStdEpoch(double time, double stdinterval, double &stdtime) {
+    if (stdinterval <= 0 || time < stdtime) {
+        return false;
+    }
+    stdtime = (floor(time / stdinterval + 1E-6) + 1) * stdinterval;
+    return true;
+}
+
+void ResultSink::push(const NavResult &result) {
+    if (!isOpen()) {
+        return;
+    }
+    bool nav = gnssonly_ ? result.gnss : epoch_++ % decimation_ == 0;
+    if (!nav && !result.hasstd) {
+        return;
+    }
+    Record record{result, nav};
+    // 滤波线程为实时优先级时 yield 不会让出CPU给输出线程，等待较久后改为休眠
+    for (int idle = 0; !queue_.push(record); idle++) {
+        if (idle < 64) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(chrono::microseconds(50));
+        }
+    }
+}
+
+bool ResultSink::close() {
+    if (!writer_.joinable()) {
+        return ok_;
+    }
+    done_.store(true, memory_order_release);
+    writer_.join();
+
+    if (binary_) {
+        ok_ = traj_.close();
+        return ok_;
+    }
+    for (int i = 0; i < FILE_COUNT; i++) {
+        files_[i].close();
+        if (!files_[i]) {
+            cerr << "结果文件：" << filenames_[i] << " 写入失败！" << endl;
+            ok_ = false;
+        }
+    }
+    return ok_;
+}
+
+void ResultSink::run() {
+    Record record;
+    int idle = 0;
+    while (true) {
+        if (queue_.pop(record)) {
+            format(record);
+            flush(false);
+            idle = 0;
+            continue;
+        }
+        // done_ 之前提交的结果都已在队列中，取空后才能退出
+        if (done_.load(memory_order_acquire)) {
+            if (queue_.empty()) {
+                break;
+            }
+            continue;
+        }
+        // 队列为空说明已经追上滤波线程，终端输出及时刷新
+        if (echo_ && !echobuf_.empty()) {
+            cout.write(echobuf_.data(), static_cast<streamsize>(echobuf_.size()));
+            cout.flush();
+            echobuf_.clear();
+        }
+        if (++idle < 64) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+    }
+    flush(true);
+}
+
+void ResultSink::format(const Record &record) {
+    GINS_PROFILE_SCOPE("output.format");
+    const NavResult &res = record.result;
+    if (binary_) {
+        traj_.write(res);
+        if (echo_ && record.nav) {
+            appendResult(echobuf_, res);
+        }
+        return;
+    }
+    if (res.hasstd) {
+        lateststd_ = res;
+
+        string &buf = buffers_[NAVRESSTD];
+        append(buf, res.time, 6, true);
+        append(buf, std2enu(res.posstd), 6);
+        append(buf, std2enu(res.velstd), 6);
+        append(buf, res.attstd, 6, R2D);
+        buf.push_back('\n');
+    }
+    if (!record.nav) {
+        return;
+    }
+
+    string &result = buffers_[RESULT];
+    size_t begin   = result.size();
+    appendResult(result, res);
+    if (echo_) {
+        echobuf_.append(result, begin, string::npos);
+    }
+
+    if (!has_origin_) {
+        origin_     = res.blh;
+        has_origin_ = true;
+    }
+    Vector2d rmrn = Earth::getRmRn(origin_[0]);
+    Vector3d enu{(res.blh[1] - origin_[1]) * (rmrn[1] + origin_[2]) * cos(origin_[0]),
+                 (res.blh[0] - origin_[0]) * (rmrn[0] + origin_[2]), res.blh[2] - origin_[2]};
+    string &navres = buffers_[NAVRES];
+    append(navres, res.time, 6, true);
+    append(navres, enu, 4);
+    append(navres, ned2enu(res.vel), 4);
+    append(navres, res.euler, 6, R2D);
+    navres.push_back('\n');
+
+    string &blhres = buffers_[BLHRES];
+    append(blhres, res.week, 0, true);
+    append(blhres, res.time, 3);
+    append(blhres, res.blh[0] * R2D, 9);
+    append(blhres, res.blh[1] * R2D, 9);
+    append(blhres, res.blh[2], 4);
+    append(blhres, lateststd_.posstd, 4);
+    append(blhres, res.vel, 4);
+    append(blhres, lateststd_.velstd, 4);
+    blhres.push_back('\n');
+
+    // NED 对角协方差旋转到 ECEF
+    Matrix3d cne     = Earth::cne(res.blh);
+    Matrix3d cne2    = cne.cwiseAbs2();
+    Vector3d xyzstd  = (cne2 * lateststd_.posstd.cwiseAbs2()).cwiseSqrt();
+    Vector3d vxyzstd = (cne2 * lateststd_.velstd.cwiseAbs2()).cwiseSqrt();
+    string &navxyz   = buffers_[NAVXYZ];
+    append(navxyz, res.time, 6, true);
+    append(navxyz, Earth::blh2ecef(res.blh), 4);
+    append(navxyz, cne * res.vel, 4);
+    append(navxyz, xyzstd, 4);
+    append(navxyz, vxyzstd, 4);
+    navxyz.push_back('\n');
+}
+
+void ResultSink::flush(bool force) {
+    for (int i = 0; i < FILE_COUNT && !binary_; i++) {
+        if (buffers_[i].size() >= BUFFER_SIZE || (force && !buffers_[i].empty())) {
+            GINS_PROFILE_SCOPE("output.write");
+            GINS_PROFILE_COUNT("output.bytes", buffers_[i].size());
+            files_[i].write(buffers_[i].data(), static_cast<streamsize>(buffers_[i].size()));
+            buffers_[i].clear();
+        }
+    }
+    if (echo_ && (echobuf_.size() >= BUFFER_SIZE || (force && !echobuf_.empty()))) {
+        cout.write(echobuf_.data(), static_cast<streamsize>(echobuf_.size()));
+        cout.flush();
+        echobuf_.clear();
+    }
+}
@@ -0,0 +1,277 @@
+#include "simulator.hpp"
+#include "earth.hpp"
+#include "insmech.hpp"
+#include "rotation.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+// 运动模型参数：加速段时长，航向、俯仰、横滚的摆动幅度和周期（周期互不成整数倍，避免轨迹重复）
+const double ACCEL_TIME   = 20.0;
+const double YAW_AMP      = 90.0 * D2R;
+const double YAW_PERIOD   = 300.0;
+const double PITCH_AMP    = 3.0 * D2R;
+const double PITCH_PERIOD = 97.0;
+const double ROLL_AMP     = 5.0 * D2R;
+const double ROLL_PERIOD  = 61.0;
+
+/// NovAtel ASCII 报文的 CRC32，计算 '%' 与 '*' 之间的字符
+uint32_t novatelCrc(const char *first, const char *last) {
+    uint32_t crc = 0;
+    for (; first < last; first++) {
+        crc ^= static_cast<unsigned char>(*first);
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xEDB88320U : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief 输出一行 RAWIMUSA 记录，与 FileIO::parseIMUline 的轴系调整和转换因子互逆
+ *
+ * @param dvel, dtheta FileIO 轴系下的速度增量、角度增量，按转换因子取整后输出
+ */
+void writeASCline(ostream &os, const ImuFormat &format, int week, double time, const Vector3d &dvel,
+                  const Vector3d &dtheta) {
+    long acc[3], gyr[3];
+    for (int i = 0; i < 3; i++) {
+        acc[i] = lround(dvel[i] / format.acc_scale);
+        gyr[i] = lround(dtheta[i] / format.gry_scale);
+    }
+    char buf[256];
+    int n = snprintf(buf, sizeof(buf), "%%RAWIMUSA,%d,%.3f;%d,%.9f,00000077,%ld,%ld,%ld,%ld,%ld,%ld", week, time, week,
+                     time, -acc[2], -acc[0], acc[1], -gyr[2], -gyr[0], gyr[1]);
+    n += snprintf(buf + n, sizeof(buf) - n, "*%08x\n", novatelCrc(buf + 1, buf + n));
+    os.write(buf, n);
+}
+
+/// 输出一行pos记录，与 FileIO::parseGNSSline 互逆
+void writePosLine(ostream &os, const GNSS &gnss) {
+    char buf[256];
+    int n = snprintf(buf, sizeof(buf), "%d %.3f %.9f %.9f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f\n",
+                     gnss.week, gnss.time, gnss.blh[0] * R2D, gnss.blh[1] * R2D, gnss.blh[2], gnss.posstd[0],
+                     gnss.posstd[1], gnss.posstd[2], gnss.vel[0], gnss.vel[1], -gnss.vel[2], gnss.velstd[0],
+                     gnss.velstd[1], gnss.velstd[2]);
+    os.write(buf, n);
+}
+
+/// 按 step 量化 value，量化误差累积到 residual，使量化后的累加值始终跟随真实累加值
+Vector3d quantize(const Vector3d &value, double step, Vector3d &residual) {
+    Vector3d sum = value + residual;
+    Vector3d q   = (sum / step).array().round() * step;
+    residual     = sum - q;
+    return q;
+}
+} // namespace
+
+Simulator::Simulator(const SimOptions &options)
+    : options_(options)
+    , rng_(options.seed) {
+    dt_        = 1.0 / options_.imurate;
+    size_      = static_cast<size_t>(llround(options_.duration * options_.imurate));
+    gnss_step_ = options_.gnssinterval > 0 ? static_cast<size_t>(llround(options_.gnssinterval * options_.imurate)) : 0;
+
+    truth_.pos       = options_.initpos;
+    truth_.vel       = Vector3d::Zero();
+    truth_.att.euler = options_.initatt;
+    truth_.att.cbn   = Rotation::euler2matrix(options_.initatt);
+    truth_.att.qbn   = Rotation::euler2quaternion(options_.initatt);
+    pvapre_          = truth_;
+
+    clean_.week   = options_.week;
+    clean_.time   = options_.starttime;
+    clean_.dt     = 0;
+    clean_.dtheta = clean_.dvel = Vector3d::Zero();
+    dvel_residual_ = dtheta_residual_ = Vector3d::Zero();
+
+    // 零偏和比例因子误差的初值取自平稳分布
+    if (options_.noise) {
+        const ImuNoise &noise = options_.imunoise;
+        error_.gyrbias        = gauss(noise.gyrbias_std);
+        error_.accbias        = gauss(noise.accbias_std);
+        error_.gyrscale       = gauss(noise.gyrscale_std);
+        error_.accscale       = gauss(noise.accscale_std);
+    } else {
+        error_.gyrbias = error_.accbias = error_.gyrscale = error_.accscale = Vector3d::Zero();
+    }
+}
+
+void Simulator::profile(double t, Vector3d &euler, Vector3d &vel) const {
+    euler = options_.initatt;
+    vel.setZero();
+    double tm = t - options_.statictime;
+    if (tm <= 0) {
+        return;
+    }
+    // 速度按余弦曲线平滑上升，加速度在加速段两端为0；姿态摆动乘以相同的系数，开始运动时角速度、角加速度为0
+    double ramp = tm < ACCEL_TIME ? 0.5 - 0.5 * cos(M_PI * tm / ACCEL_TIME) : 1.0;
+    euler[0] += ROLL_AMP * ramp * sin(2 * M_PI * tm / ROLL_PERIOD);
+    euler[1] += PITCH_AMP * ramp * sin(2 * M_PI * tm / PITCH_PERIOD);
+    euler[2] += YAW_AMP * (1 - cos(2 * M_PI * tm / YAW_PERIOD));
+
+    // 沿载体纵轴运动，俯仰角决定爬升和下降，平均高度不变
+    double speed = options_.speed * ramp;
+    vel << speed * cos(euler[1]) * cos(euler[2]), speed * cos(euler[1]) * sin(euler[2]), -speed * sin(euler[1]);
+}
+
+double Simulator::gauss() {
+    if (has_spare_) {
+        has_spare_ = false;
+        return spare_;
+    }
+    // 取64位随机数的高53位，u1 位于 (0, 1]，避免 log(0)
+    double u1  = static_cast<double>((rng_() >> 11) + 1) * 0x1.0p-53;
+    double u2  = static_cast<double>(rng_() >> 11) * 0x1.0p-53;
+    double r   = sqrt(-2.0 * log(u1));
+    spare_     = r * sin(2 * M_PI * u2);
+    has_spare_ = true;
+    return r * cos(2 * M_PI * u2);
+}
+
+Vector3d Simulator::gauss(const Vector3d &std) {
+    double x = gauss();
+    double y = gauss();
+    double z = gauss();
+    return Vector3d(x, y, z).cwiseProduct(std);
+}
+
+void Simulator::markov(Vector3d &value, const Vector3d &std) {
+    if (options_.imunoise.corr_time <= 0) {
+        return;
+    }
+    double a = exp(-dt_ / options_.imunoise.corr_time);
+    value    = a * value + sqrt(1 - a * a) * gauss(std);
+}
+
+void Simulator::makeGnss() {
+    // 与 GIEngine::gnssUpdate 相同的杆臂模型
+    const PVA &pva   = truth_;
+    EarthTerms earth = Earth::getTerms(pva.pos, pva.vel);
+    Vector3d Dr(earth.rmrn[0] + pva.pos[2], (earth.rmrn[1] + pva.pos[2]) * earth.coslat, -1);
+    Vector3d lever_n = pva.att.cbn * options_.antlever;
+    Vector3d omega   = clean_.dtheta / clean_.dt;
+
+    gnss_.week   = options_.week;
+    gnss_.time   = clean_.time;
+    gnss_.blh    = pva.pos + lever_n.cwiseQuotient(Dr);
+    gnss_.vel    = pva.vel + pva.att.cbn * omega.cross(options_.antlever) - (earth.wie_n + earth.wen_n).cross(lever_n);
+    gnss_.posstd = options_.posstd;
+    gnss_.velstd = options_.velstd;
+    if (options_.noise) {
+        gnss_.blh += gauss(options_.posstd).cwiseQuotient(Dr);
+        gnss_.vel += gauss(options_.velstd);
+    }
+    gnss_.isvalid = true;
+}
+
+bool Simulator::next(IMU &imu) {
+    if (epoch_ >= size_) {
+        return false;
+    }
+    double pretime = clean_.time;
+    epoch_++;
+
+    // 由目标姿态、速度反求无误差增量，再递推得到真值
+    Vector3d euler, vel;
+    double t = static_cast<double>(epoch_) / options_.imurate;
+    profile(t, euler, vel);
+    IMU cleanpre = clean_;
+    clean_.time  = options_.starttime + t;
+    clean_.dt    = dt_;
+    INSMech::insMechInverse(pvapre_, truth_, cleanpre, Rotation::euler2matrix(euler), vel, clean_);
+    INSMech::insMechFused(pvapre_, truth_, cleanpre, clean_);
+    INSMech::updateAttitude(truth_.att);
+
+    // 量测值：(1+比例因子)·增量 + 零偏·dt + 白噪声，与 GIEngine::imuCompensate 互逆
+    imu    = clean_;
+    imu.dt = clean_.time - pretime;
+    if (options_.noise) {
+        const ImuNoise &noise = options_.imunoise;
+        markov(error_.gyrbias, noise.gyrbias_std);
+        markov(error_.accbias, noise.accbias_std);
+        markov(error_.gyrscale, noise.gyrscale_std);
+        markov(error_.accscale, noise.accscale_std);
+        imu.dtheta = (Vector3d::Ones() + error_.gyrscale).cwiseProduct(clean_.dtheta) + error_.gyrbias * dt_ +
+                     gauss(noise.gyr_arw) * sqrt(dt_);
+        imu.dvel = (Vector3d::Ones() + error_.accscale).cwiseProduct(clean_.dvel) + error_.accbias * dt_ +
+                   gauss(noise.acc_vrw) * sqrt(dt_);
+    }
+    if (options_.quantize) {
+        imu.dtheta = quantize(imu.dtheta, options_.format.gry_scale, dtheta_residual_);
+        imu.dvel   = quantize(imu.dvel, options_.format.acc_scale, dvel_residual_);
+    }
+
+    has_gnss_ = gnss_step_ > 0 && epoch_ % gnss_step_ == 0;
+    if (has_gnss_) {
+        makeGnss();
+    }
+    return true;
+}
+
+void Simulator::generate(const SimOptions &options, vector<IMU> &imudata, vector<GNSS> &gnssdata, vector<PVA> *truth) {
+    Simulator sim(options);
+    imudata.clear();
+    gnssdata.clear();
+    imudata.reserve(sim.size());
+    if (truth != nullptr) {
+        truth->clear();
+        truth->reserve(sim.size());
+    }
+    IMU imu;
+    GNSS gnss;
+    while (sim.next(imu)) {
+        imudata.push_back(imu);
+        if (sim.gnss(gnss)) {
+            gnssdata.push_back(gnss);
+        }
+        if (truth != nullptr) {
+            truth->push_back(sim.truth());
+        }
+    }
+}
+
+bool Simulator::writeFiles(const SimOptions &options, const string &imufile, const string &gnssfile,
+                           ResultSink *truth) {
+    SimOptions quantized = options;
+    quantized.quantize   = true;
+    Simulator sim(quantized);
+
+    vector<char> imubuf(1 << 20), gnssbuf(1 << 16);
+    ofstream imuofs, gnssofs;
+    imuofs.rdbuf()->pubsetbuf(imubuf.data(), imubuf.size());
+    gnssofs.rdbuf()->pubsetbuf(gnssbuf.data(), gnssbuf.size());
+    imuofs.open(imufile, ios::binary);
+    gnssofs.open(gnssfile, ios::binary);
+    if (!imuofs.is_open() || !gnssofs.is_open()) {
+        cerr << "仿真数据文件：" << imufile << "、" << gnssfile << " 创建失败！" << endl;
+        return false;
+    }
+
+    // 第一条记录只用于确定起始时刻，读取时不作为IMU数据
+    writeASCline(imuofs, options.format, options.week, options.starttime, Vector3d::Zero(), Vector3d::Zero());
+    // pos文件有两行文件头
+    gnssofs << "% simulated GNSS solution\n"
+               "% week, sow, lat(deg), lon(deg), h(m), std N/E/D(m), vel N/E/U(m/s), vel std N/E/D(m/s)\n";
+    IMU imu;
+    GNSS gnss;
+    while (sim.next(imu)) {
+        writeASCline(imuofs, options.format, imu.week, imu.time, imu.dvel, imu.dtheta);
+        bool has_gnss = sim.gnss(gnss);
+        if (has_gnss) {
+            writePosLine(gnssofs, gnss);
+        }
+        if (truth != nullptr) {
+            truth->push(ResultSink::navResult(imu.week, imu.time, sim.truth(), nullptr, has_gnss));
+        }
+    }
+    imuofs.close();
+    gnssofs.close();
+    if (!imuofs || !gnssofs) {
+        cerr << "仿真数据文件：" << imufile << "、" << gnssfile << " 写入失败！" << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,249 @@
+#include "smoother.hpp"
+#include "insmech.hpp"
+#include "profiler.hpp"
+#include "rotation.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+constexpr int RESULT_FIELDS = 1 + 9 + 12 + GIEngine::RANK; // 时刻、位置速度姿态、IMU误差、标准差
+
+template <typename T>
+inline void writeValue(fstream &fs, const T &value) {
+    fs.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+inline void readValue(fstream &fs, T &value) {
+    fs.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+inline void writeVector(fstream &fs, const Vector3d &v) {
+    fs.write(reinterpret_cast<const char *>(v.data()), 3 * sizeof(double));
+}
+
+inline void readVector(fstream &fs, Vector3d &v) {
+    fs.read(reinterpret_cast<char *>(v.data()), 3 * sizeof(double));
+}
+} // namespace
+
+RTSSmoother::RTSSmoother(const GINSOptions &options, size_t max_memory, const string &tmpdir)
+    : engine_(options) {
+    segment_size_ = max_memory == 0 ? SIZE_MAX : max(max_memory / sizeof(Epoch), size_t(4));
+    if (segment_size_ != SIZE_MAX) {
+        // 一次 newImuProcess 至多产生3个节点
+        epochs_.reserve(segment_size_ + 3);
+    }
+    engine_.recordEpochs(&epochs_);
+    checkpoints_.push_back({engine_, 0});
+
+    filesystem::path dir = tmpdir.empty() ? filesystem::temp_directory_path() : filesystem::path(tmpdir);
+    string prefix = "gins_rts_" + to_string(getpid()) + "_" + to_string(reinterpret_cast<uintptr_t>(this));
+    logfile_      = (dir / (prefix + ".log")).string();
+    resultfile_   = (dir / (prefix + ".res")).string();
+    log_.open(logfile_, ios::in | ios::out | ios::binary | ios::trunc);
+    if (!log_.is_open()) {
+        cerr << "RTS平滑输入日志：" << logfile_ << " 创建失败！" << endl;
+    }
+    updatePeakMemory(epochs_.capacity());
+}
+
+RTSSmoother::~RTSSmoother() {
+    log_.close();
+    error_code ec;
+    filesystem::remove(logfile_, ec);
+    filesystem::remove(resultfile_, ec);
+}
+
+void RTSSmoother::addImuData(const IMU &imu) {
+    writeValue(log_, OP_IMU);
+    writeValue(log_, static_cast<int32_t>(imu.week));
+    writeValue(log_, imu.time);
+    writeValue(log_, imu.dt);
+    writeVector(log_, imu.dtheta);
+    writeVector(log_, imu.dvel);
+    engine_.addImuData(imu);
+}
+
+void RTSSmoother::addGnssData(const GNSS &gnss) {
+    writeValue(log_, OP_GNSS);
+    writeValue(log_, static_cast<int32_t>(gnss.week));
+    writeValue(log_, gnss.time);
+    writeVector(log_, gnss.blh);
+    writeVector(log_, gnss.posstd);
+    writeVector(log_, gnss.vel);
+    writeVector(log_, gnss.velstd);
+    writeValue(log_, static_cast<uint8_t>(gnss.isvalid));
+    engine_.addGnssData(gnss);
+}
+
+void RTSSmoother::newImuProcess() {
+    writeValue(log_, OP_PROCESS);
+    size_t recorded = epochs_.size();
+    engine_.newImuProcess();
+    epoch_count_ += epochs_.size() - recorded;
+    checkSegment();
+}
+
+void RTSSmoother::checkSegment() {
+    if (epochs_.size() < segment_size_) {
+        return;
+    }
+    // 检查点时刻的状态同时作为新分段的第一个节点
+    checkpoints_.push_back({engine_, static_cast<uint64_t>(log_.tellp())});
+    epochs_.clear();
+    engine_.recordEpochs(&epochs_);
+    updatePeakMemory(epochs_.capacity());
+}
+
+bool RTSSmoother::replay(size_t segment, vector<Epoch> &epochs) {
+    GINS_PROFILE_SCOPE("rts.replay");
+    uint64_t first = checkpoints_[segment].offset;
+    uint64_t last  = checkpoints_[segment + 1].offset;
+
+    GIEngine engine = checkpoints_[segment].engine;
+    epochs.clear();
+    engine.recordEpochs(&epochs);
+
+    log_.clear();
+    log_.seekg(first);
+    IMU imu;
+    GNSS gnss;
+    while (static_cast<uint64_t>(log_.tellg()) < last) {
+        uint8_t op;
+        int32_t week;
+        readValue(log_, op);
+        if (op == OP_IMU) {
+            readValue(log_, week);
+            readValue(log_, imu.time);
+            readValue(log_, imu.dt);
+            readVector(log_, imu.dtheta);
+            readVector(log_, imu.dvel);
+            imu.week = week;
+            engine.addImuData(imu);
+        } else if (op == OP_GNSS) {
+            uint8_t isvalid;
+            readValue(log_, week);
+            readValue(log_, gnss.time);
+            readVector(log_, gnss.blh);
+            readVector(log_, gnss.posstd);
+            readVector(log_, gnss.vel);
+            readVector(log_, gnss.velstd);
+            readValue(log_, isvalid);
+            gnss.week    = week;
+            gnss.isvalid = isvalid != 0;
+            engine.addGnssData(gnss);
+        } else if (op == OP_PROCESS) {
+            engine.newImuProcess();
+        }
+        if (!log_) {
+            cerr << "RTS平滑输入日志：" << logfile_ << " 读取失败！" << endl;
+            return false;
+        }
+    }
+    engine.recordEpochs(nullptr);
+    return true;
+}
+
+bool RTSSmoother::smooth(const Output &output) {
+    GINS_PROFILE_SCOPE("rts.smooth");
+    log_.flush();
+    if (!log_) {
+        cerr << "RTS平滑输入日志：" << logfile_ << " 写入失败！" << endl;
+        return false;
+    }
+    engine_.recordEpochs(nullptr);
+
+    fstream res(resultfile_, ios::in | ios::out | ios::binary | ios::trunc);
+    if (!res.is_open()) {
+        cerr << "RTS平滑临时文件：" << resultfile_ << " 创建失败！" << endl;
+        return false;
+    }
+
+    // 平滑结果按时间倒序写入临时文件
+    size_t results = 0;
+    auto write     = [&res, &results](const Epoch &epoch, const StateVector &dx, const StateMatrix &P) {
+        PVA pva           = epoch.pva;
+        ImuError imuerror = epoch.imuerror;
+        GIEngine::correctState(pva, imuerror, dx);
+        INSMech::updateAttitude(pva.att);
+
+        double record[RESULT_FIELDS];
+        double *p = record;
+        *p++      = epoch.time;
+        for (const Vector3d *v : {&pva.pos, &pva.vel, &pva.att.euler, &imuerror.gyrbias, &imuerror.accbias,
+                                  &imuerror.gyrscale, &imuerror.accscale}) {
+            p = copy(v->data(), v->data() + 3, p);
+        }
+        StateVector std = P.diagonal().cwiseMax(0).cwiseSqrt();
+        copy(std.data(), std.data() + GIEngine::RANK, p);
+        res.write(reinterpret_cast<const char *>(record), sizeof(record));
+        results++;
+    };
+
+    // 最后一个节点的平滑结果即滤波结果
+    StateVector dxs = StateVector::Zero();
+    StateMatrix Ps  = epochs_.back().Pplus;
+    for (size_t s = checkpoints_.size(); s-- > 0;) {
+        // 最后一个分段的节点在正向滤波结束时仍在内存中，其余分段从检查点重放
+        if (s + 1 < checkpoints_.size() && !replay(s, epochs_)) {
+            return false;
+        }
+        updatePeakMemory(epochs_.capacity());
+
+        // 分段最后一个节点与后一个分段的第一个节点相同，平滑结果已经在后一个分段中求得
+        if (epochs_.back().output) {
+            write(epochs_.back(), dxs, Ps);
+        }
+        for (size_t k = epochs_.size() - 1; k-- > 0;) {
+            const Epoch &cur  = epochs_[k];
+            const Epoch &next = epochs_[k + 1];
+
+            // A = P+(k) * Phi^T * P-(k+1)^-1，误差状态反馈后 k 时刻的估计为0，
+            // k+1 时刻相对预测状态的平滑误差为相对更新后状态的平滑误差加上量测更新估计的误差
+            StateMatrix A = next.Pminus.llt().solve(next.Phi * cur.Pplus).transpose();
+            dxs           = A * (dxs + next.dx);
+            Ps            = cur.Pplus + A * (Ps - next.Pminus) * A.transpose();
+            if (cur.output) {
+                write(cur, dxs, Ps);
+            }
+        }
+    }
+    if (!res) {
+        cerr << "RTS平滑临时文件：" << resultfile_ << " 写入失败！" << endl;
+        return false;
+    }
+
+    // 倒序读出，按时间顺序输出
+    double record[RESULT_FIELDS];
+    NavState state;
+    StateVector std;
+    for (size_t i = results; i-- > 0;) {
+        res.seekg(i * sizeof(record));
+        res.read(reinterpret_cast<char *>(record), sizeof(record));
+        if (!res) {
+            cerr << "RTS平滑临时文件：" << resultfile_ << " 读取失败！" << endl;
+            return false;
+        }
+        const double *p = record + 1;
+        for (Vector3d *v : {&state.pav.pos, &state.pav.vel, &state.pav.att.euler, &state.imuerror.gyrbias,
+                            &state.imuerror.accbias, &state.imuerror.gyrscale, &state.imuerror.accscale}) {
+            copy(p, p + 3, v->data());
+            p += 3;
+        }
+        copy(p, p + GIEngine::RANK, std.data());
+        state.pav.att.cbn = Rotation::euler2matrix(state.pav.att.euler);
+        state.pav.att.qbn = Rotation::euler2quaternion(state.pav.att.euler);
+        output(record[0], state, std);
+    }
+    return true;
+}
+
+void RTSSmoother::updatePeakMemory(size_t epochs) {
+    // 每个检查点的 GIEngine 还各有一份静止检测窗口，大小与 engine_ 的相同
+    size_t memory = epochs * sizeof(Epoch) + checkpoints_.capacity() * sizeof(Checkpoint) +
+                    checkpoints_.size() * engine_.heapMemory();
+    peak_memory_  = max(peak_memory_, memory);
+}
@@ -0,0 +1,173 @@
+#include "staticdetector.hpp"
+#include "aligned.hpp"
+#include "init.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr size_t BLOCK = 8192; // 批量计算时每块判断的历元数，块内的模长和前缀和放在缓存中
+
+/// 窗口内的历元数，至少为2才能计算方差
+size_t windowSize(const StaticOptions &options, int rate) {
+    return max<size_t>(2, static_cast<size_t>(lround(options.window * rate)));
+}
+} // namespace
+
+StaticDetector::StaticDetector(const StaticOptions &options, int rate)
+    : options_(options)
+    , rate_(rate)
+    , window_(windowSize(options, rate))
+    , gyr_(window_, 0.0)
+    , acc_(window_, 0.0) {
+}
+
+void StaticDetector::reset() {
+    head_     = 0;
+    count_    = 0;
+    gyr_sum_  = 0;
+    gyr_sum2_ = 0;
+    acc_sum_  = 0;
+    acc_sum2_ = 0;
+    static_   = false;
+}
+
+bool StaticDetector::test(double gyr_sum, double gyr_sum2, double acc_sum, double acc_sum2) const {
+    double n        = static_cast<double>(window_);
+    double gyr_mean = gyr_sum / n;
+    double gyr_var  = (gyr_sum2 - gyr_sum * gyr_mean) / (n - 1);
+    double acc_mean = acc_sum / n;
+    double acc_var  = (acc_sum2 - acc_sum * acc_mean) / (n - 1);
+    return (gyr_mean < options_.gyrmean) & (gyr_var < options_.gyrstd * options_.gyrstd) &
+           (acc_var < options_.accstd * options_.accstd);
+}
+
+bool StaticDetector::update(const IMU &imu) {
+    double gyr = imu.dtheta.norm() * rate_;
+    double acc = imu.dvel.norm() * rate_ - ACC_OFFSET;
+    if (count_ == window_) {
+        // 移出窗口的历元
+        gyr_sum_ -= gyr_[head_];
+        gyr_sum2_ -= gyr_[head_] * gyr_[head_];
+        acc_sum_ -= acc_[head_];
+        acc_sum2_ -= acc_[head_] * acc_[head_];
+    } else {
+        count_++;
+    }
+    gyr_[head_] = gyr;
+    acc_[head_] = acc;
+    gyr_sum_ += gyr;
+    gyr_sum2_ += gyr * gyr;
+    acc_sum_ += acc;
+    acc_sum2_ += acc * acc;
+
+    // 每绕环形缓冲区一圈重新求和一次，避免增减累积舍入误差
+    if (++head_ == window_) {
+        head_     = 0;
+        gyr_sum_  = 0;
+        gyr_sum2_ = 0;
+        acc_sum_  = 0;
+        acc_sum2_ = 0;
+        for (size_t i = 0; i < window_; i++) {
+            gyr_sum_ += gyr_[i];
+            gyr_sum2_ += gyr_[i] * gyr_[i];
+            acc_sum_ += acc_[i];
+            acc_sum2_ += acc_[i] * acc_[i];
+        }
+    }
+    static_ = count_ == window_ && test(gyr_sum_, gyr_sum2_, acc_sum_, acc_sum2_);
+    return static_;
+}
+
+void StaticDetector::detect(const ImuView &imudata, const StaticOptions &options, int rate, vector<uint8_t> &flags) {
+    GINS_PROFILE_SCOPE("static.detect");
+    size_t n = imudata.size();
+    flags.assign(n, 0);
+    StaticDetector detector(options, rate);
+    size_t w = detector.window_;
+    if (n < w) {
+        return;
+    }
+
+    // 每块计算 [b, e) 的判断结果，需要 [b+1-w, e) 的数据；前缀和在块内从0开始，不随数据长度累积舍入误差
+    AlignedVector<double> gyr(BLOCK + w), acc(BLOCK + w);
+    AlignedVector<double> gyr_sum(BLOCK + w + 1), gyr_sum2(BLOCK + w + 1), acc_sum(BLOCK + w + 1),
+        acc_sum2(BLOCK + w + 1);
+    double scale = rate;
+    for (size_t b = w - 1; b < n; b += BLOCK) {
+        size_t e     = min(n, b + BLOCK);
+        size_t first = b + 1 - w;
+        size_t m     = e - first;
+
+        // 角速度、比力模长
+        const double *gx = imudata.dtheta(0) + first, *gy = imudata.dtheta(1) + first;
+        const double *gz = imudata.dtheta(2) + first, *ax = imudata.dvel(0) + first;
+        const double *ay = imudata.dvel(1) + first, *az = imudata.dvel(2) + first;
+        double *pg = gyr.data(), *pa = acc.data();
+#pragma omp simd
+        for (size_t i = 0; i < m; i++) {
+            pg[i] = sqrt(gx[i] * gx[i] + gy[i] * gy[i] + gz[i] * gz[i]) * scale;
+            pa[i] = sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]) * scale - ACC_OFFSET;
+        }
+
+        // 前缀和
+        gyr_sum[0] = gyr_sum2[0] = acc_sum[0] = acc_sum2[0] = 0;
+        for (size_t i = 0; i < m; i++) {
+            gyr_sum[i + 1]  = gyr_sum[i] + pg[i];
+            gyr_sum2[i + 1] = gyr_sum2[i] + pg[i] * pg[i];
+            acc_sum[i + 1]  = acc_sum[i] + pa[i];
+            acc_sum2[i + 1] = acc_sum2[i] + pa[i] * pa[i];
+        }
+
+        // 以第 k 个历元结尾的窗口为前缀和的 [k+1-w, k+1)
+        const double *sg = gyr_sum.data(), *sg2 = gyr_sum2.data(), *sa = acc_sum.data(), *sa2 = acc_sum2.data();
+        uint8_t *out = flags.data() + first;
+#pragma omp simd
+        for (size_t k = w - 1; k < m; k++) {
+            out[k] = detector.test(sg[k + 1] - sg[k + 1 - w], sg2[k + 1] - sg2[k + 1 - w], sa[k + 1] - sa[k + 1 - w],
+                                   sa2[k + 1] - sa2[k + 1 - w]);
+        }
+    }
+}
+
+vector<StaticInterval> StaticDetector::intervals(const ImuView &imudata, const StaticOptions &options, int rate) {
+    vector<uint8_t> flags;
+    detect(imudata, options, rate, flags);
+    size_t n       = flags.size();
+    size_t w       = windowSize(options, rate);
+    size_t minsize = static_cast<size_t>(ceil(options.mintime * rate));
+
+    vector<StaticInterval> res;
+    size_t prev_last = 0; // 上一个静止时段的结束索引，时段之间不重叠
+    for (size_t i = 0; i < n;) {
+        if (!flags[i]) {
+            i++;
+            continue;
+        }
+        size_t j = i;
+        while (j < n && flags[j]) {
+            j++;
+        }
+        // 第一个静止历元的整个窗口都是静止的
+        size_t first = max(i + 1 - w, prev_last);
+        if (j - first >= max<size_t>(minsize, 1)) {
+            StaticInterval interval;
+            interval.first = first;
+            interval.last  = j;
+            interval.start = imudata.time()[first];
+            interval.end   = imudata.time()[j - 1];
+            interval.att.setZero();
+            res.push_back(interval);
+        }
+        prev_last = j;
+        i         = j;
+    }
+    return res;
+}
+
+void StaticDetector::align(const ImuView &imudata, vector<StaticInterval> &intervals, ThreadPool &pool) {
+    pool.parallelFor(intervals.size(), [&](size_t k) {
+        StaticInterval &interval = intervals[k];
+        interval.att             = getInitAtt(imudata.sub(interval.first, interval.last - interval.first));
+    });
+}
@@ -0,0 +1,221 @@
+#include "sweep.hpp"
+#include "driver.hpp"
+#include "earth.hpp"
+#include "fileio.hpp"
+#include "gins.hpp"
+#include "timeindex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace {
+// 参考轨迹相邻历元的最大间隔（s），间隔更大时不内插
+const double MAX_REF_GAP = 1.0;
+
+/// 按倍数缩放噪声参数
+ImuNoise scaleNoise(const ImuNoise &base, double arw, double vrw, double gbstd, double abstd, double gsstd,
+                    double asstd, double corrtime) {
+    ImuNoise noise     = base;
+    noise.gyr_arw      = base.gyr_arw * arw;
+    noise.acc_vrw      = base.acc_vrw * vrw;
+    noise.gyrbias_std  = base.gyrbias_std * gbstd;
+    noise.accbias_std  = base.accbias_std * abstd;
+    noise.gyrscale_std = base.gyrscale_std * gsstd;
+    noise.accscale_std = base.accscale_std * asstd;
+    noise.corr_time    = base.corr_time * corrtime;
+    return noise;
+}
+
+/// [0, 1) 均匀分布随机数，只使用 mt19937_64 的输出，在任何平台上结果相同
+double uniform(mt19937_64 &rng) {
+    return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+/// 在 factors 的最小值和最大值之间按对数均匀分布抽取一个倍数
+double logUniform(mt19937_64 &rng, const vector<double> &factors) {
+    auto [lo, hi] = minmax_element(factors.begin(), factors.end());
+    double u      = uniform(rng);
+    return *lo * pow(*hi / *lo, u);
+}
+} // namespace
+
+NoiseSweep::NoiseSweep(const GINSOptions &options, const string &reffile, double skip)
+    : options_(options)
+    , skip_(skip) {
+    if (!FileIO::getIMUdataMmap(options.imufile, imudata_, true, options.imuformat) || imudata_.empty()) {
+        cerr << "IMU数据文件读取失败！" << endl;
+        return;
+    }
+    if (!FileIO::getGNSSdata(options.gnssfile, gnssdata_) || gnssdata_.empty()) {
+        cerr << "GNSS定位结果pos数据文件读取失败！" << endl;
+        return;
+    }
+    if (!reffile.empty() && !loadReference(reffile)) {
+        return;
+    }
+    open_ = true;
+}
+
+NoiseSweep::NoiseSweep(const GINSOptions &options, vector<IMU> imudata, vector<GNSS> gnssdata, double skip)
+    : options_(options)
+    , imudata_(std::move(imudata))
+    , gnssdata_(std::move(gnssdata))
+    , skip_(skip) {
+    open_ = !imudata_.empty() && !gnssdata_.empty();
+}
+
+void NoiseSweep::addReference(double time, const Vector3d &blh) {
+    reference_.push_back({time, Earth::blh2ecef(blh)});
+}
+
+bool NoiseSweep::loadReference(const string &reffile) {
+    ifstream ifs(reffile);
+    if (!ifs.is_open()) {
+        cerr << "参考轨迹文件：" << reffile << " 打开失败！" << endl;
+        return false;
+    }
+    string line;
+    double time, lat, lon, hgt;
+    while (getline(ifs, line)) {
+        if (sscanf(line.c_str(), "%lf %lf %lf %lf", &time, &lat, &lon, &hgt) != 4) {
+            continue;
+        }
+        if (!reference_.empty() && time <= reference_.back().time) {
+            cerr << "参考轨迹文件：" << reffile << " 的时间不是递增的！" << endl;
+            return false;
+        }
+        addReference(time, Vector3d(lat * D2R, lon * D2R, hgt));
+    }
+    if (reference_.empty()) {
+        cerr << "参考轨迹文件：" << reffile << " 中没有数据！" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool NoiseSweep::reference(double time, Vector3d &xyz) const {
+    auto it = lower_bound(reference_.begin(), reference_.end(), time,
+                          [](const RefPoint &ref, double t) { return ref.time < t; });
+    if (it == reference_.end()) {
+        return false;
+    }
+    if (it->time == time) {
+        xyz = it->xyz;
+        return true;
+    }
+    if (it == reference_.begin() || it->time - (it - 1)->time > MAX_REF_GAP) {
+        return false;
+    }
+    const RefPoint &pre = *(it - 1);
+    double k            = (time - pre.time) / (it->time - pre.time);
+    xyz                 = pre.xyz + k * (it->xyz - pre.xyz);
+    return true;
+}
+
+SweepResult NoiseSweep::evaluate(const ImuNoise &imunoise) const {
+    SweepResult result;
+    result.imunoise = imunoise;
+    result.epochs   = 0;
+    result.pos_rms  = numeric_limits<double>::quiet_NaN();
+    result.pos_max  = numeric_limits<double>::quiet_NaN();
+    result.updates  = 0;
+    result.nis      = numeric_limits<double>::quiet_NaN();
+    if (!open_) {
+        return result;
+    }
+
+    // 与 GINS 后处理相同：只处理 [starttime, endtime) 时段，时段内第一个GNSS历元用于初始化，
+    // IMU数据从该时刻之前的最后一个历元开始
+    double endtime = options_.endtime > 0 ? options_.endtime : 1E300;
+    auto gnss      = TimeIndex::window(gnssdata_, options_.starttime, endtime);
+    if (gnss.first == gnss.second) {
+        return result;
+    }
+    const GNSS &gnssinit = gnssdata_[gnss.first];
+    size_t i             = TimeIndex::lowerBound(imudata_, gnssinit.time);
+    size_t imuend        = TimeIndex::lowerBound(imudata_, endtime);
+    i                    = i > 0 ? i - 1 : 0;
+    if (i >= imuend) {
+        return result;
+    }
+
+    GINSOptions options       = options_;
+    options.imunoise          = imunoise;
+    options.initstate.pav.pos = gnssinit.blh;
+    options.initstate.pav.vel = gnssinit.vel;
+
+    GIEngine engine(options);
+    double starttime = imudata_[i].time + skip_;
+    double sum2 = 0, maxerr = 0;
+    Vector3d ref;
+    FilterDriver::run(engine, imudata_[i], FilterDriver::source(imudata_, i + 1, imuend),
+                      FilterDriver::source(gnssdata_, gnss.first + 1, gnss.second),
+                      [&](const IMU &imucur) {
+                          if (imucur.time < starttime || !reference(imucur.time, ref)) {
+                              return;
+                          }
+                          double err = (Earth::blh2ecef(engine.getNavState().pav.pos) - ref).norm();
+                          sum2 += err * err;
+                          maxerr = max(maxerr, err);
+                          result.epochs++;
+                      });
+
+    if (result.epochs > 0) {
+        result.pos_rms = sqrt(sum2 / result.epochs);
+        result.pos_max = maxerr;
+    }
+    const GIEngine::InnovationStats &stats = engine.innovationStats();
+    result.updates                         = stats.updates;
+    if (stats.dims > 0) {
+        result.nis = stats.nis / stats.dims;
+    }
+    return result;
+}
+
+vector<SweepResult> NoiseSweep::run(const vector<ImuNoise> &configs, ThreadPool &pool) const {
+    vector<SweepResult> results(configs.size());
+    pool.parallelFor(configs.size(), [&](size_t i) { results[i] = evaluate(configs[i]); });
+    return results;
+}
+
+vector<ImuNoise> NoiseSweep::grid(const ImuNoise &base, const SweepSpace &space) {
+    vector<ImuNoise> configs;
+    for (double arw : space.arw) {
+        for (double vrw : space.vrw) {
+            for (double gbstd : space.gbstd) {
+                for (double abstd : space.abstd) {
+                    for (double gsstd : space.gsstd) {
+                        for (double asstd : space.asstd) {
+                            for (double corrtime : space.corrtime) {
+                                configs.push_back(scaleNoise(base, arw, vrw, gbstd, abstd, gsstd, asstd, corrtime));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+vector<ImuNoise> NoiseSweep::sample(const ImuNoise &base, const SweepSpace &space, size_t count, uint64_t seed) {
+    vector<ImuNoise> configs;
+    configs.reserve(count);
+    mt19937_64 rng(seed);
+    for (size_t k = 0; k < count; k++) {
+        // 逐个参数按固定顺序抽取，保证相同种子得到相同的序列
+        double arw      = logUniform(rng, space.arw);
+        double vrw      = logUniform(rng, space.vrw);
+        double gbstd    = logUniform(rng, space.gbstd);
+        double abstd    = logUniform(rng, space.abstd);
+        double gsstd    = logUniform(rng, space.gsstd);
+        double asstd    = logUniform(rng, space.asstd);
+        double corrtime = logUniform(rng, space.corrtime);
+        configs.push_back(scaleNoise(base, arw, vrw, gbstd, abstd, gsstd, asstd, corrtime));
+    }
+    return configs;
+}
@@ -0,0 +1,145 @@
+#include "trajectory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+constexpr char TRAJ_MAGIC[8] = {'G', 'I', 'N', 'S', 'T', 'R', 'A', 'J'};
+} // namespace
+
+bool TrajectoryFile::open(const string &path) {
+    header_ = nullptr;
+    if (!file_.open(path) || file_.size() < sizeof(Header)) {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(file_.data());
+    uint32_t fields      = (header->flags & HAS_STD) != 0 ? STD_FIELDS : NAV_FIELDS;
+    if (memcmp(header->magic, TRAJ_MAGIC, sizeof(TRAJ_MAGIC)) != 0 || header->version != VERSION ||
+        header->fields != fields || header->index_stride != INDEX_STRIDE ||
+        header->index_count != (header->count + INDEX_STRIDE - 1) / INDEX_STRIDE ||
+        sizeof(Header) + header->count * fields * sizeof(double) > header->index_offset ||
+        header->index_offset + header->index_count * sizeof(double) > file_.size()) {
+        file_.close();
+        return false;
+    }
+    header_  = header;
+    records_ = reinterpret_cast<const double *>(file_.data() + sizeof(Header));
+    index_   = reinterpret_cast<const double *>(file_.data() + header_->index_offset);
+    return true;
+}
+
+NavResult TrajectoryFile::get(size_t i) const {
+    const double *r = record(i);
+    NavResult result;
+    result.week  = static_cast<int>(r[WEEK]);
+    result.time  = r[TIME];
+    result.blh   = Vector3d(r[LAT], r[LON], r[HGT]);
+    result.vel   = Vector3d(r[VN], r[VE], r[VD]);
+    result.euler = Vector3d(r[ROLL], r[PITCH], r[YAW]);
+    result.gnss  = false;
+    if (hasStd() && !std::isnan(r[SDN])) {
+        result.posstd = Vector3d(r[SDN], r[SDE], r[SDD]);
+        result.velstd = Vector3d(r[SVN], r[SVE], r[SVD]);
+        result.attstd = Vector3d(r[SROLL], r[SPITCH], r[SYAW]);
+        result.hasstd = true;
+    } else {
+        result.posstd = result.velstd = result.attstd = Vector3d::Zero();
+        result.hasstd = false;
+    }
+    return result;
+}
+
+size_t TrajectoryFile::lowerBound(double time) const {
+    // 先在稀疏索引中确定所在的块，再在块内二分查找，只访问索引和一个块内的记录。
+    // 索引第 block 条不早于 time，所求记录不晚于它；前一条早于 time，所求记录在它之后，
+    // 时间相同的记录跨过块边界时也是如此
+    size_t n     = size();
+    size_t block = lower_bound(index_, index_ + header_->index_count, time) - index_;
+    size_t first = block == 0 ? 0 : (block - 1) * INDEX_STRIDE;
+    size_t last  = min(n, block * INDEX_STRIDE);
+    while (first < last) {
+        size_t mid = first + (last - first) / 2;
+        if (this->time(mid) < time) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    close();
+}
+
+bool TrajectoryWriter::open(const string &path, bool withstd) {
+    path_   = path;
+    fields_ = withstd ? TrajectoryFile::STD_FIELDS : TrajectoryFile::NAV_FIELDS;
+    count_  = 0;
+    index_.clear();
+
+    buf_.resize(1 << 20);
+    ofs_.rdbuf()->pubsetbuf(buf_.data(), buf_.size());
+    ofs_.open(path, ios::in | ios::out | ios::binary | ios::trunc);
+    if (!ofs_.is_open()) {
+        cerr << "轨迹文件：" << path << " 创建失败！" << endl;
+        return false;
+    }
+    // 记录数为0的文件头占位，close 时回写
+    TrajectoryFile::Header header;
+    memset(&header, 0, sizeof(header));
+    ofs_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return true;
+}
+
+void TrajectoryWriter::write(const NavResult &result) {
+    double record[TrajectoryFile::STD_FIELDS];
+    record[TrajectoryFile::WEEK] = result.week;
+    record[TrajectoryFile::TIME] = result.time;
+    copy(result.blh.data(), result.blh.data() + 3, record + TrajectoryFile::LAT);
+    copy(result.vel.data(), result.vel.data() + 3, record + TrajectoryFile::VN);
+    copy(result.euler.data(), result.euler.data() + 3, record + TrajectoryFile::ROLL);
+    if (fields_ == TrajectoryFile::STD_FIELDS) {
+        if (result.hasstd) {
+            copy(result.posstd.data(), result.posstd.data() + 3, record + TrajectoryFile::SDN);
+            copy(result.velstd.data(), result.velstd.data() + 3, record + TrajectoryFile::SVN);
+            copy(result.attstd.data(), result.attstd.data() + 3, record + TrajectoryFile::SROLL);
+        } else {
+            fill(record + TrajectoryFile::SDN, record + TrajectoryFile::STD_FIELDS,
+                 numeric_limits<double>::quiet_NaN());
+        }
+    }
+    if (count_ % TrajectoryFile::INDEX_STRIDE == 0) {
+        index_.push_back(result.time);
+    }
+    ofs_.write(reinterpret_cast<const char *>(record), fields_ * sizeof(double));
+    count_++;
+}
+
+bool TrajectoryWriter::close() {
+    if (!ofs_.is_open()) {
+        return true;
+    }
+    TrajectoryFile::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRAJ_MAGIC, sizeof(TRAJ_MAGIC));
+    header.version      = TrajectoryFile::VERSION;
+    header.fields       = fields_;
+    header.count        = count_;
+    header.flags        = fields_ == TrajectoryFile::STD_FIELDS ? static_cast<uint32_t>(TrajectoryFile::HAS_STD) : 0u;
+    header.index_stride = TrajectoryFile::INDEX_STRIDE;
+    header.index_count  = index_.size();
+    header.index_offset = sizeof(header) + count_ * fields_ * sizeof(double);
+
+    ofs_.write(reinterpret_cast<const char *>(index_.data()), index_.size() * sizeof(double));
+    ofs_.seekp(0);
+    ofs_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofs_.close();
+    if (!ofs_) {
+        cerr << "轨迹文件：" << path_ << " 写入失败！" << endl;
+        return false;
+    }
+    return true;
+}
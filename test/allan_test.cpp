@@ -0,0 +1,28 @@
+#include "allan.hpp"
+#include "init.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief 累积和引擎与 allanAnalysis 在相同 bins 下的结果一致
+ *
+ * allanAnalysis 直接累加未去均值的数据，簇很长时其自身的舍入误差就在 1E-6 量级，
+ * 两者按 %.9lf 输出的结果相同
+ */
+TEST(AllanVariance, MatchesAllanAnalysis) {
+    vector<IMU> imudata = testData().imudata;
+    ASSERT_FALSE(imudata.empty());
+
+    double max_rel = 0;
+    int size       = imudata.size();
+    vector<double> res_allan_std;
+    AllanVariance allan(imudata, 0, size);
+    for (int bins = 2; bins < 10000 && size / bins > 0; bins += 10) {
+        allanAnalysis(imudata, 0, size, bins, res_allan_std);
+        auto res = allan.deviationByBins(bins);
+        for (int a = 0; a < AllanVariance::AXES; a++) {
+            max_rel = max(max_rel, abs(res[a] - res_allan_std[a]) / max(abs(res_allan_std[a]), 1E-300));
+        }
+    }
+    EXPECT_LT(max_rel, 1E-5) << "AllanVariance 与 allanAnalysis 的结果不一致";
+}
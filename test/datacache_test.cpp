@@ -0,0 +1,122 @@
+#include "datacache.hpp"
+#include "fileio.hpp"
+#include "init.hpp"
+#include "testdata.hpp"
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace {
+/// 读入整个文件
+string readFile(const filesystem::path &path) {
+    ifstream ifs(path, ios::binary);
+    stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+/// 在临时目录下复制一份不带缓存的模拟数据文件，析构时删除整个目录
+class CacheDir {
+public:
+    CacheDir() {
+        dir_ = filesystem::temp_directory_path() / "gins_test_cache";
+        filesystem::remove_all(dir_);
+        filesystem::create_directories(dir_);
+        imufile_ = (dir_ / "imu.ASC").string();
+        filesystem::copy_file(testData().imufile, imufile_);
+    }
+    ~CacheDir() {
+        filesystem::remove_all(dir_);
+    }
+
+    const filesystem::path &dir() const {
+        return dir_;
+    }
+    const string &imufile() const {
+        return imufile_;
+    }
+
+private:
+    filesystem::path dir_;
+    string imufile_;
+};
+
+/// 在 dir 下调用 getRawIMUdata，返回读入的数据和各轴的 Allan 数据文件内容
+vector<string> rawIMUdump(const filesystem::path &dir, const string &imufile, vector<IMU> &imudata) {
+    filesystem::path cwd = filesystem::current_path();
+    filesystem::current_path(dir);
+    bool ok = getRawIMUdata(imufile, imudata);
+    filesystem::current_path(cwd);
+
+    vector<string> dumps;
+    if (ok) {
+        for (const char *name : {"AllanAccX.txt", "AllanAccY.txt", "AllanAccZ.txt", "AllanGyrX.txt", "AllanGyrY.txt",
+                                 "AllanGyrZ.txt"}) {
+            dumps.push_back(readFile(dir / name));
+        }
+    }
+    return dumps;
+}
+} // namespace
+
+// 缓存保存原始计数，读取结果必须与解析源文件逐位一致
+TEST(DataCache, MatchesParsedFile) {
+    ASSERT_FALSE(testData().imudata.empty());
+    CacheDir dir;
+
+    vector<IMU> inc, rate, cached_inc, cached_rate;
+    ASSERT_TRUE(FileIO::getIMUdataMmap(dir.imufile(), inc));
+    ASSERT_TRUE(FileIO::getIMUdataMmap(dir.imufile(), rate, false));
+    ASSERT_TRUE(DataCache::convert(dir.imufile()));
+    DataCache cache;
+    ASSERT_TRUE(cache.openFresh(dir.imufile(), DataCache::IMU_DATA));
+    ASSERT_TRUE(FileIO::getIMUdata(dir.imufile(), cached_inc));
+    ASSERT_TRUE(FileIO::getIMUdata(dir.imufile(), cached_rate, false));
+    EXPECT_TRUE(sameIMUdata(inc, cached_inc)) << "缓存中的增量与解析源文件的结果不一致";
+    EXPECT_TRUE(sameIMUdata(rate, cached_rate)) << "缓存中的加速度、角速度与解析源文件的结果不一致";
+}
+
+// Allan 方差分析的数据读取：从缓存读取与解析源文件得到的数据和输出文件完全相同
+TEST(DataCache, AllanDumpsMatch) {
+    ASSERT_FALSE(testData().imudata.empty());
+    CacheDir dir;
+
+    vector<IMU> parsed, cached;
+    vector<string> parsed_dumps = rawIMUdump(dir.dir(), dir.imufile(), parsed);
+    ASSERT_EQ(parsed_dumps.size(), 6u);
+    ASSERT_TRUE(DataCache::convert(dir.imufile()));
+    vector<string> cached_dumps = rawIMUdump(dir.dir(), dir.imufile(), cached);
+    ASSERT_EQ(cached_dumps.size(), 6u);
+
+    EXPECT_FALSE(parsed.empty());
+    EXPECT_TRUE(sameIMUdata(parsed, cached)) << "从缓存读取的原始数据与解析源文件的结果不一致";
+    for (size_t i = 0; i < parsed_dumps.size(); i++) {
+        EXPECT_FALSE(parsed_dumps[i].empty());
+        EXPECT_EQ(parsed_dumps[i], cached_dumps[i]) << "第 " << i << " 个 Allan 数据文件不一致";
+    }
+}
+
+// 时间相同的记录跨过时间索引的块边界时，按时间查找返回其中的第一条
+TEST(DataCache, LowerBoundWithRepeatedTimes) {
+    filesystem::path path = filesystem::temp_directory_path() / "gins_test_repeated.gcache";
+    vector<GNSS> gnssdata(3 * DataCache::INDEX_STRIDE);
+    for (size_t i = 0; i < gnssdata.size(); i++) {
+        // 每3条记录的时间相同，第 INDEX_STRIDE-2 ~ INDEX_STRIDE 条位于两个块中
+        gnssdata[i]      = GNSS();
+        gnssdata[i].week = 2315;
+        gnssdata[i].time = static_cast<double>((i + 1) / 3);
+    }
+    ASSERT_TRUE(DataCache::writeGNSS(path.string(), gnssdata));
+
+    DataCache cache;
+    ASSERT_TRUE(cache.open(path.string(), DataCache::GNSS_DATA));
+    ASSERT_EQ(cache.size(), gnssdata.size());
+    size_t first = 0; // 与第 i 条记录时间相同的第一条记录
+    for (size_t i = 0; i < cache.size(); i++) {
+        if (cache.time(i) != cache.time(first)) {
+            first = i;
+        }
+        ASSERT_EQ(cache.lowerBound(cache.time(i)), first) << "第 " << i << " 条记录";
+    }
+    filesystem::remove(path);
+}
@@ -0,0 +1,103 @@
+#include "datastream.hpp"
+#include "testdata.hpp"
+#include "timeindex.hpp"
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+/**
+ * @brief 数据流定位、限定时段后读取的记录与顺序读取的结果逐位一致
+ *
+ * 在开始、中间、随机时刻和最后一条记录处定位，定位时刻取记录时刻或两条记录之间，并向前退若干条
+ */
+void checkSeek(const string &imufile, const string &gnssfile) {
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    IMUStream imu_stream;
+    GNSSStream gnss_stream;
+    IMU imu;
+    GNSS gnss;
+    ASSERT_TRUE(imu_stream.open(imufile));
+    ASSERT_TRUE(gnss_stream.open(gnssfile));
+    while (imu_stream.next(imu)) {
+        imudata.push_back(imu);
+    }
+    while (gnss_stream.next(gnss)) {
+        gnssdata.push_back(gnss);
+    }
+    ASSERT_GE(imudata.size(), 2u);
+    ASSERT_GE(gnssdata.size(), 2u);
+
+    mt19937 rng(20240611);
+    vector<double> times = {imudata.front().time - 1.0, imudata.front().time, imudata[imudata.size() / 2].time,
+                            imudata.back().time, imudata.back().time + 1.0};
+    for (int k = 0; k < 20; k++) {
+        size_t i = rng() % (imudata.size() - 1);
+        times.push_back(imudata[i].time);
+        times.push_back(0.5 * (imudata[i].time + imudata[i + 1].time));
+    }
+    for (size_t before : {0, 1, 3}) {
+        for (double time : times) {
+            SCOPED_TRACE("time " + to_string(time) + ", before " + to_string(before));
+
+            // 同一个数据流向前、向后多次定位，时段为 [time, time+2s)
+            auto [first, last] = TimeIndex::window(imudata, time, time + 2.0);
+            first              = first > before ? first - before : 0;
+            imu_stream.setEnd(time + 2.0);
+            ASSERT_EQ(imu_stream.seek(time, before), first < last);
+            size_t i = first;
+            for (; imu_stream.next(imu); i++) {
+                ASSERT_LT(i, imudata.size());
+                ASSERT_TRUE(sameIMUdata({imu}, {imudata[i]})) << "第 " << i << " 条IMU记录不一致";
+            }
+            ASSERT_EQ(i, max(first, last));
+
+            auto [gfirst, glast] = TimeIndex::window(gnssdata, time, time + 2.0);
+            gfirst               = gfirst > before ? gfirst - before : 0;
+            gnss_stream.setEnd(time + 2.0);
+            gnss_stream.seek(time, before);
+            for (i = gfirst; gnss_stream.next(gnss); i++) {
+                ASSERT_LT(i, gnssdata.size());
+                ASSERT_TRUE(gnss.time == gnssdata[i].time && gnss.blh == gnssdata[i].blh &&
+                            gnss.vel == gnssdata[i].vel && gnss.posstd == gnssdata[i].posstd)
+                    << "第 " << i << " 条GNSS记录不一致";
+            }
+            ASSERT_EQ(i, max(gfirst, glast));
+        }
+    }
+}
+
+/// 复制数据文件，跳过前 header 行后每 5 行重复一次，模拟一个历元多次采样
+void writeDuplicated(const string &src, const string &dst, int header) {
+    ifstream ifs(src);
+    ofstream ofs(dst);
+    string line;
+    for (int i = 0; getline(ifs, line); i++) {
+        ofs << line << "\n";
+        if (i >= header && (i - header) % 5 == 0) {
+            ofs << line << "\n";
+        }
+    }
+}
+} // namespace
+
+TEST(IMUStream, SeekMatchesSequentialRead) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    checkSeek(data.imufile, data.gnssfile);
+}
+
+// 重复历元只读出第一条，向前退的条数按历元计算
+TEST(IMUStream, SeekSkipsDuplicateEpochs) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    filesystem::path dir = filesystem::temp_directory_path();
+    string imufile       = (dir / "gins_test_dup_imu.ASC").string();
+    string gnssfile      = (dir / "gins_test_dup_gnss.pos").string();
+    writeDuplicated(data.imufile, imufile, 0);
+    writeDuplicated(data.gnssfile, gnssfile, 2);
+    checkSeek(imufile, gnssfile);
+    filesystem::remove(imufile);
+    filesystem::remove(gnssfile);
+}
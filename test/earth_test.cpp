@@ -0,0 +1,29 @@
+#include "earth.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+// getTerms 与各自计算的单项函数结果相同
+TEST(Earth, TermsMatchSeparateFunctions) {
+    vector<Vector3d> blhs = randomPositions(), vels = randomEulers();
+    double max_rel        = 0;
+    for (size_t i = 0; i < MICRO_INPUTS; i++) {
+        const Vector3d &blh = blhs[i];
+        Vector3d vel        = vels[i] * 10.0;
+        EarthTerms terms    = Earth::getTerms(blh, vel);
+        Vector3d wen        = Earth::getWen(vel[1], vel[0], blh[0], blh[2]);
+        max_rel = max({max_rel, ((terms.rmrn - Earth::getRmRn(blh[0])).array() / terms.rmrn.array()).abs().maxCoeff(),
+                       (terms.wie_n - Earth::getWie(blh[0])).norm() / Earth::WIE,
+                       (terms.wen_n - wen).norm() / max(wen.norm(), 1E-300),
+                       abs(terms.gravity - Earth::gravity(blh)) / terms.gravity});
+    }
+    EXPECT_LE(max_rel, 1E-14);
+}
+
+// 各椭球的正常重力相差在 1E-5 m/s^2 以内
+TEST(Earth, EllipsoidGravityClose) {
+    for (const Vector3d &blh : randomPositions()) {
+        double g = Earth::gravity(blh);
+        EXPECT_NEAR(EarthModel<CGCS2000>::gravity(blh), g, 1E-5);
+        EXPECT_NEAR(EarthModel<GRS80>::gravity(blh), g, 1E-5);
+    }
+}
@@ -0,0 +1,17 @@
+#include "fileio.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+// 内存映射和多线程分块解析的结果必须与 getline 解析逐位一致
+TEST(FileIO, ParsersAgree) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.imudata.empty());
+
+    vector<IMU> mapped, parallel, single;
+    ASSERT_TRUE(FileIO::getIMUdataMmap(data.imufile, mapped));
+    ASSERT_TRUE(FileIO::getIMUdataParallel(data.imufile, parallel));
+    ASSERT_TRUE(FileIO::getIMUdataParallel(data.imufile, single, true, 1));
+    EXPECT_TRUE(sameIMUdata(data.imudata, mapped)) << "getIMUdataMmap 与 getIMUdata 的解析结果不一致";
+    EXPECT_TRUE(sameIMUdata(data.imudata, parallel)) << "getIMUdataParallel 与 getIMUdata 的解析结果不一致";
+    EXPECT_TRUE(sameIMUdata(data.imudata, single)) << "单线程 getIMUdataParallel 与 getIMUdata 的解析结果不一致";
+}
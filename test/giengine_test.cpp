@@ -0,0 +1,105 @@
+#include "driver.hpp"
+#include "gins.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+// 静止的模拟GNSS数据下，组合解算的位置应始终靠近GNSS位置
+TEST(GIEngine, StaticPositionConverges) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    NavState nav = runEKF(data.imudata, data.gnssdata);
+    EXPECT_LT(positionError(nav.pav.pos, initialPVA().pos), 1.0) << "GIEngine 组合解算结果发散";
+}
+
+// 只计算非零块和上三角的协方差传播与稠密矩阵乘法的结果相同
+TEST(GIEngine, StructuredCovPropagation) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    GIEngine::StateMatrix phi, cov, qd;
+    sampleCovariance(data.imudata, data.gnssdata, phi, cov, qd);
+    GIEngine::StateMatrix ref = phi * cov * phi.transpose() + qd, res = cov;
+    GIEngine::propagateCovariance(phi, qd, res);
+    EXPECT_LT((res - ref).cwiseAbs().maxCoeff() / ref.cwiseAbs().maxCoeff(), 1E-12);
+}
+
+/**
+ * @brief 延迟传播与逐历元传播协方差的组合解算结果相近
+ *
+ * 延迟传播时系统噪声在1s的累积区间内按状态转移矩阵线性变化近似积分，与逐历元的梯形积分不同，
+ * 最后一个历元各状态标准差的相对误差在 1E-4 量级
+ */
+TEST(GIEngine, LazyCovariance) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    GIEngine::StateMatrix ref, res;
+    runEKF(data.imudata, data.gnssdata, false, &ref);
+    runEKF(data.imudata, data.gnssdata, true, &res);
+    double rel = (res.diagonal().cwiseSqrt() - ref.diagonal().cwiseSqrt())
+                     .cwiseQuotient(ref.diagonal().cwiseSqrt())
+                     .cwiseAbs()
+                     .maxCoeff();
+    EXPECT_LT(rel, 1E-3) << "延迟传播协方差的结果与逐历元传播不一致";
+}
+
+/**
+ * @brief 配置 gnssinterval 后只在间隔不小于该值的GNSS历元量测更新
+ *
+ * 模拟GNSS数据为1Hz，间隔取2s时更新次数减半（第一个历元总是使用），更新历元之间相隔2s
+ */
+TEST(GIEngine, GnssIntervalSelectsUpdateEpochs) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    size_t updates[2];
+    for (int k = 0; k < 2; k++) {
+        GINSOptions options  = ekfOptions();
+        options.gnssinterval = k == 0 ? 0 : 2.0;
+        GIEngine engine(options);
+        double last = -1;
+        bool spaced = true;
+        FilterDriver::run(engine, data.imudata[0], FilterDriver::source(data.imudata, 1),
+                          FilterDriver::source(data.gnssdata, 0), [&](const IMU &imu) {
+                              if (engine.gnssUpdated()) {
+                                  spaced = spaced && (last < 0 || imu.time - last > options.gnssinterval - 0.01);
+                                  last   = imu.time;
+                              }
+                          });
+        EXPECT_TRUE(spaced) << "gnssinterval " << options.gnssinterval << " 时两次更新的间隔过短";
+        updates[k] = engine.innovationStats().updates;
+    }
+    EXPECT_EQ(updates[1], (updates[0] + 1) / 2);
+}
+
+/**
+ * @brief 静止数据只用初始状态，不做GNSS量测更新，纯惯导递推
+ *
+ * @param [in] imudata IMU数据
+ * @param [in] zupt 是否零速修正
+ * @param [out] updates 零速修正的次数
+ * @return double 最后一个历元的速度大小（m/s）
+ */
+static double staticVelocity(const vector<IMU> &imudata, bool zupt, size_t &updates) {
+    GINSOptions options = ekfOptions();
+    options.zupt        = zupt;
+    GIEngine engine(options);
+    engine.addImuData(imudata[0]);
+    updates = 0;
+    for (size_t i = 1; i < imudata.size(); i++) {
+        engine.addImuData(imudata[i]);
+        engine.newImuProcess();
+        updates += engine.zuptUpdated();
+    }
+    return engine.getNavState().pav.vel.norm();
+}
+
+// 零速修正抑制静止数据纯惯导递推的速度发散
+TEST(GIEngine, ZuptBoundsStaticVelocity) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.imudata.empty());
+    size_t zupts, free_updates;
+    double zupt_vel = staticVelocity(data.imudata, true, zupts);
+    double free_vel = staticVelocity(data.imudata, false, free_updates);
+    EXPECT_LT(zupt_vel, 0.01);
+    EXPECT_LT(zupt_vel, free_vel);
+    EXPECT_GT(zupts, 0u);
+    EXPECT_EQ(free_updates, 0u);
+}
@@ -0,0 +1,36 @@
+#include "imubuffer.hpp"
+#include "init.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief 按列存储的批量计算与按历元存储的结果一致
+ *
+ * 批量求和使用多个部分和，累加顺序不同；分块均值之差相对均值本身很小，
+ * 与 AllanVariance 的测试一样，两者的相对误差在 1E-6 量级
+ */
+TEST(ImuBuffer, MatchesVectorOfIMU) {
+    vector<IMU> imudata = testData().imudata;
+    ASSERT_FALSE(imudata.empty());
+    ImuBuffer buffer(imudata);
+    ImuView view = buffer.view();
+    ASSERT_EQ(view.size(), imudata.size());
+    for (size_t i = 0; i < imudata.size(); i++) {
+        IMU imu = view[i];
+        ASSERT_TRUE(imu.time == imudata[i].time && imu.dtheta == imudata[i].dtheta && imu.dvel == imudata[i].dvel)
+            << "第 " << i << " 个历元不一致";
+    }
+
+    double max_rel = 0;
+    int size       = imudata.size();
+    vector<double> res_aos, res_soa;
+    for (int bins : {2, 10, 100, 1000}) {
+        allanAnalysis(imudata, 0, size, bins, res_aos);
+        allanAnalysis(view, bins, res_soa);
+        ASSERT_EQ(res_soa.size(), res_aos.size());
+        for (size_t a = 0; a < res_aos.size(); a++) {
+            max_rel = max(max_rel, abs(res_soa[a] - res_aos[a]) / max(abs(res_aos[a]), 1E-300));
+        }
+    }
+    EXPECT_LT(max_rel, 1E-5) << "ImuBuffer 与 vector<IMU> 的结果不一致";
+}
@@ -0,0 +1,53 @@
+#include "earth.hpp"
+#include "insmech.hpp"
+#include "insmechbatch.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+/// 两个状态的位置（m）、速度（m/s）、姿态（rad）差值中的最大值
+static double maxDifference(const PVA &res, const PVA &ref) {
+    Vector2d RmRn = Earth::getRmRn(ref.pos[0]);
+    Vector3d dpos((res.pos[0] - ref.pos[0]) * (RmRn(0) + ref.pos[2]),
+                  (res.pos[1] - ref.pos[1]) * (RmRn(1) + ref.pos[2]) * cos(ref.pos[0]), res.pos[2] - ref.pos[2]);
+    double datt = (res.att.cbn * ref.att.cbn.transpose() - Matrix3d::Identity()).cwiseAbs().maxCoeff();
+    return max({dpos.cwiseAbs().maxCoeff(), (res.vel - ref.vel).cwiseAbs().maxCoeff(), datt});
+}
+
+// 单遍融合的机械编排与原有的三步机械编排递推到最后一个历元的结果相同
+TEST(INSMech, FusedMatchesThreeStep) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.imudata.empty());
+    PVA ref = runMechanization(data.imudata, false), res = runMechanization(data.imudata, true);
+    EXPECT_LT(maxDifference(res, ref), 1E-6) << "insMechFused 与 insMech 的结果不一致";
+}
+
+/**
+ * @brief INSMechBatch 与逐条轨迹 insMechFused 的递推结果相同
+ *
+ * 两者的舍入误差不同，纯惯导的高程通道发散，舍入误差随时间放大，递推 36000 个历元后高程差在 1E-6 m 量级
+ */
+TEST(INSMechBatch, MatchesFused) {
+    const vector<IMU> &imudata = testData().imudata;
+    ASSERT_FALSE(imudata.empty());
+    size_t lanes  = 5;
+    size_t epochs = min(MECH_BATCH_EPOCHS, imudata.size());
+    INSMechBatch batch(lanes);
+    for (size_t lane = 0; lane < lanes; lane++) {
+        PVA pva = perturbedPVA(lane);
+        batch.initialize(lane, pva, pva, imudata[0]);
+    }
+    for (size_t i = 1; i < epochs; i++) {
+        for (size_t lane = 0; lane < lanes; lane++) {
+            batch.setIMU(lane, imudata[i]);
+        }
+        batch.update();
+    }
+
+    for (size_t lane = 0; lane < lanes; lane++) {
+        PVA pvapre = perturbedPVA(lane), ref = pvapre;
+        for (size_t i = 1; i < epochs; i++) {
+            INSMech::insMechFused(pvapre, ref, imudata[i - 1], imudata[i]);
+        }
+        EXPECT_LT(maxDifference(batch.state(lane), ref), 1E-5) << "第 " << lane << " 条轨迹不一致";
+    }
+}
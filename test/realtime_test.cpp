@@ -0,0 +1,85 @@
+#include "realtime.hpp"
+#include "testdata.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <gtest/gtest.h>
+
+// 当前线程的堆内存分配次数，用于检查实时处理过程中没有堆内存分配。
+// 直接替换 malloc 系列函数（glibc 的 __libc_* 实现），operator new 的各个重载、Eigen 的对齐分配
+// 和共享库中的分配最终都经过这里，不会漏计
+static thread_local size_t t_allocations = 0;
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size) noexcept {
+    t_allocations++;
+    return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) noexcept {
+    t_allocations++;
+    return __libc_calloc(count, size);
+}
+void *realloc(void *ptr, size_t size) noexcept {
+    t_allocations++;
+    return __libc_realloc(ptr, size);
+}
+void *memalign(size_t alignment, size_t size) noexcept {
+    t_allocations++;
+    return __libc_memalign(alignment, size);
+}
+void *aligned_alloc(size_t alignment, size_t size) noexcept {
+    t_allocations++;
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept {
+    t_allocations++;
+    void *p = __libc_memalign(alignment, size);
+    if (p == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+}
+static constexpr bool COUNT_ALLOCATIONS = true;
+#else
+static constexpr bool COUNT_ALLOCATIONS = false; // 非 glibc 平台不统计分配次数
+#endif
+
+static size_t allocated() {
+    return t_allocations;
+}
+
+// 计数器本身有效：堆内存分配（包括对齐分配）都会被统计
+TEST(RealtimeNavigator, AllocationCounterSeesAllocations) {
+    if (!COUNT_ALLOCATIONS) {
+        GTEST_SKIP() << "非 glibc 平台不统计分配次数";
+    }
+    size_t before   = allocated();
+    void *volatile p = malloc(64); // volatile 避免编译器消去成对的分配和释放
+    void *volatile q = aligned_alloc(64, 256);
+    free(p);
+    free(q);
+    EXPECT_EQ(allocated() - before, 2u);
+}
+
+// 通过管道以实时模式处理全部数据：结果不发散，初始化之后处理数据帧时不分配堆内存
+TEST(RealtimeNavigator, PipeWithoutAllocation) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    filesystem::path dir = filesystem::temp_directory_path() / "gins_test_realtime";
+    LatencyHistogram latency;
+    size_t allocations;
+    double diff = runRealtimePipe(data.imudata, data.gnssdata, outputOptions(dir, false), latency,
+                                  COUNT_ALLOCATIONS ? allocated : nullptr, allocations);
+    filesystem::remove_all(dir);
+    EXPECT_GE(diff, 0);
+    EXPECT_LT(diff, 1.0) << "实时模式组合解算结果发散";
+    EXPECT_GT(latency.count(), 0u);
+    EXPECT_EQ(allocations, 0u) << "实时模式初始化之后分配了堆内存";
+}
@@ -0,0 +1,19 @@
+#include "resultsink.hpp"
+#include "testdata.hpp"
+#include <fstream>
+#include <gtest/gtest.h>
+
+// ResultSink 输出的 result.txt 与原先逐历元 << 输出的结果逐字节相同
+TEST(ResultSink, SameTextAsStream) {
+    const vector<IMU> &imudata = testData().imudata;
+    ASSERT_FALSE(imudata.empty());
+    size_t epochs        = min<size_t>(imudata.size(), 20000);
+    filesystem::path dir = filesystem::temp_directory_path() / "gins_test_resultsink";
+    GINSOptions options  = outputOptions(dir, false);
+    writeResultStream(dir / "result_stream.txt", imudata, epochs);
+    ASSERT_TRUE(writeResultSink(options, imudata, epochs));
+
+    ifstream a(dir / "result_stream.txt", ios::binary), b(dir / "result.txt", ios::binary);
+    EXPECT_TRUE(string(istreambuf_iterator<char>(a), {}) == string(istreambuf_iterator<char>(b), {}));
+    filesystem::remove_all(dir);
+}
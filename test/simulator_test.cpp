@@ -0,0 +1,71 @@
+#include "fileio.hpp"
+#include "simulator.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief 反向机械编排：匀速段的真值速度应沿载体纵轴，大小等于巡航速度
+ *
+ * 目标姿态和速度只由运动模型给出，真值由反求的增量正向递推得到，两者一致说明 insMechInverse 与 insMechFused 互逆
+ */
+TEST(Simulator, TruthFollowsMotionModel) {
+    SimOptions sim = simOptions(false);
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    vector<PVA> truth;
+    Simulator::generate(sim, imudata, gnssdata, &truth);
+    ASSERT_EQ(truth.size(), imudata.size());
+    double max_diff = 0;
+    for (size_t i = 0; i < truth.size(); i++) {
+        // 加速段为20s，之后速度大小不变
+        if (imudata[i].time - sim.starttime > sim.statictime + 20.0) {
+            Vector3d expect = sim.speed * truth[i].att.cbn.col(0);
+            max_diff        = max(max_diff, (truth[i].vel - expect).cwiseAbs().maxCoeff());
+        }
+    }
+    EXPECT_LT(max_diff, 1E-6) << "insMechInverse 反求的增量递推后未能复现目标运动";
+}
+
+// 仿真输出的ASC、pos文件读回的数据与 Simulator::generate 的结果一致
+TEST(Simulator, FilesReadBack) {
+    SimOptions sim       = simOptions(true);
+    filesystem::path dir = filesystem::temp_directory_path();
+    string imufile       = (dir / "gins_test_sim.ASC").string();
+    string gnssfile      = (dir / "gins_test_sim.pos").string();
+    vector<IMU> imudata, imuread;
+    vector<GNSS> gnssdata, gnssread;
+    Simulator::generate(sim, imudata, gnssdata);
+    ASSERT_TRUE(Simulator::writeFiles(sim, imufile, gnssfile));
+    ASSERT_TRUE(FileIO::getIMUdata(imufile, imuread));
+    ASSERT_TRUE(FileIO::getGNSSdata(gnssfile, gnssread));
+    filesystem::remove(imufile);
+    filesystem::remove(gnssfile);
+
+    // 增量按转换因子量化后写出，读回的值逐位相同；时刻和GNSS数据受文本精度限制
+    ASSERT_EQ(imuread.size(), imudata.size());
+    for (size_t i = 0; i < imudata.size(); i++) {
+        ASSERT_TRUE(imuread[i].dvel == imudata[i].dvel && imuread[i].dtheta == imudata[i].dtheta &&
+                    abs(imuread[i].time - imudata[i].time) < 1E-6)
+            << "第 " << i << " 条IMU记录不一致";
+    }
+    // 与其他pos文件相同，第一个GNSS历元只用于确定起始时刻，读取时不作为GNSS数据
+    ASSERT_EQ(gnssread.size() + 1, gnssdata.size());
+    for (size_t i = 0; i < gnssread.size(); i++) {
+        const GNSS &gnss = gnssdata[i + 1];
+        ASSERT_TRUE(abs(gnssread[i].time - gnss.time) < 1E-6 &&
+                    (gnssread[i].blh - gnss.blh).head<2>().cwiseAbs().maxCoeff() < 1E-9 * D2R &&
+                    abs(gnssread[i].blh[2] - gnss.blh[2]) < 1E-4 &&
+                    (gnssread[i].vel - gnss.vel).cwiseAbs().maxCoeff() < 1E-4)
+            << "第 " << i << " 条GNSS记录不一致";
+    }
+}
+
+// 在含噪声的仿真数据上做组合解算，最后一个历元与真值的位置差在分米量级以内
+TEST(Simulator, FilterTracksTruth) {
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    vector<PVA> truth;
+    Simulator::generate(simOptions(true), imudata, gnssdata, &truth);
+    NavState nav = runEKF(imudata, gnssdata);
+    EXPECT_LT(positionError(nav.pav.pos, truth.back().pos), 0.5) << "仿真数据的组合解算结果与真值不符";
+}
@@ -0,0 +1,18 @@
+#include "smoother.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+// 内存上限很小时分段重算的平滑结果与所有节点保存在内存中的结果逐位一致
+TEST(RTSSmoother, CheckpointedMatchesInMemory) {
+    const TestData &data = testData();
+    ASSERT_FALSE(data.gnssdata.empty());
+    vector<NavState> ref, res;
+    runRTS(data.imudata, data.gnssdata, 0, ref);
+    runRTS(data.imudata, data.gnssdata, 1 << 20, res);
+    ASSERT_EQ(ref.size(), res.size());
+    for (size_t i = 0; i < ref.size(); i++) {
+        ASSERT_TRUE(ref[i].pav.pos == res[i].pav.pos && ref[i].pav.vel == res[i].pav.vel &&
+                    ref[i].pav.att.euler == res[i].pav.att.euler)
+            << "第 " << i << " 个历元的平滑结果不一致";
+    }
+}
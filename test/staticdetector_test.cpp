@@ -0,0 +1,44 @@
+#include "imubuffer.hpp"
+#include "init.hpp"
+#include "simulator.hpp"
+#include "staticdetector.hpp"
+#include "testdata.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief 静止检测和多时段粗对准
+ *
+ * 仿真数据开始时静止 statictime 秒：批量与逐历元的判断结果必须相同，第一个静止时段从数据开始。
+ * 仿真轨迹开始运动时加速度、角速度从0平滑增加，又没有振动，静止时段会延续到开始运动后几秒，允许延后半个加速段，
+ * 这几秒的加速度使粗对准的俯仰角偏差约0.1°（只用静止的60秒时约0.01°）；多线程与单线程的粗对准结果相同
+ */
+TEST(StaticDetector, DetectsSimulatedStaticPeriod) {
+    SimOptions sim = simOptions(true);
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    Simulator::generate(sim, imudata, gnssdata);
+    ImuBuffer buffer(imudata);
+    ImuView view = buffer.view();
+    StaticOptions options;
+    int rate = sim.imurate;
+
+    vector<uint8_t> flags;
+    StaticDetector::detect(view, options, rate, flags);
+    StaticDetector detector(options, rate);
+    for (size_t i = 0; i < imudata.size(); i++) {
+        ASSERT_EQ(detector.update(imudata[i]), static_cast<bool>(flags[i])) << "第 " << i << " 个历元的判断不一致";
+    }
+
+    vector<StaticInterval> intervals = StaticDetector::intervals(view, options, rate);
+    double moving                    = sim.starttime + sim.statictime;
+    ASSERT_FALSE(intervals.empty());
+    EXPECT_EQ(intervals[0].first, 0u);
+    EXPECT_GE(intervals[0].end, moving - options.window);
+    EXPECT_LE(intervals[0].end, moving + 10.0);
+
+    ThreadPool pool(4);
+    StaticDetector::align(view, intervals, pool);
+    Vector3d serial = getInitAtt(view.sub(intervals[0].first, intervals[0].last - intervals[0].first));
+    EXPECT_EQ(serial, intervals[0].att);
+    EXPECT_LT((intervals[0].att - sim.initatt).head<2>().cwiseAbs().maxCoeff(), 5E-3);
+}
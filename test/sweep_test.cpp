@@ -0,0 +1,59 @@
+#include "simulator.hpp"
+#include "sweep.hpp"
+#include "testdata.hpp"
+#include "timeindex.hpp"
+#include <gtest/gtest.h>
+
+// 多线程与逐组调用 evaluate 的结果逐位相同，且与仿真噪声相符的参数 NIS 最接近1
+TEST(NoiseSweep, ParallelMatchesSerialAndNisFindsTruth) {
+    NoiseSweep sweep         = simulationSweep();
+    vector<ImuNoise> configs = sweepConfigs();
+    ThreadPool pool(4);
+    vector<SweepResult> results = sweep.run(configs, pool);
+    ASSERT_EQ(results.size(), configs.size());
+    for (size_t i = 0; i < configs.size(); i++) {
+        SweepResult serial = sweep.evaluate(configs[i]);
+        EXPECT_EQ(serial.pos_rms, results[i].pos_rms);
+        EXPECT_EQ(serial.nis, results[i].nis);
+        EXPECT_GT(serial.updates, 0u);
+    }
+    double truth = abs(log(results[1].nis));
+    EXPECT_LT(truth, abs(log(results[0].nis)));
+    EXPECT_LT(truth, abs(log(results[2].nis)));
+    EXPECT_LT(results[1].pos_rms, 0.1);
+}
+
+// 配置了 starttime、endtime 时只解算该时段，与直接截取时段内的数据解算的结果逐位相同
+TEST(NoiseSweep, TimeWindowMatchesTruncatedData) {
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    vector<PVA> truth;
+    Simulator::generate(simOptions(true), imudata, gnssdata, &truth);
+    ASSERT_GT(gnssdata.size(), 100u);
+
+    GINSOptions options = ekfOptions();
+    options.starttime   = gnssdata[5].time - 0.5;
+    options.endtime     = gnssdata[60].time + 0.5;
+    size_t gfirst = 5, glast = 61;
+    size_t ifirst = TimeIndex::lowerBound(imudata, gnssdata[gfirst].time) - 1;
+    size_t ilast  = TimeIndex::lowerBound(imudata, options.endtime);
+
+    NoiseSweep window(options, imudata, gnssdata);
+    NoiseSweep truncated(ekfOptions(), vector<IMU>(imudata.begin() + ifirst, imudata.begin() + ilast),
+                         vector<GNSS>(gnssdata.begin() + gfirst, gnssdata.begin() + glast));
+    NoiseSweep full(ekfOptions(), imudata, gnssdata);
+    for (size_t i = 0; i < truth.size(); i++) {
+        window.addReference(imudata[i].time, truth[i].pos);
+        truncated.addReference(imudata[i].time, truth[i].pos);
+        full.addReference(imudata[i].time, truth[i].pos);
+    }
+
+    SweepResult expected = truncated.evaluate(options.imunoise);
+    SweepResult result   = window.evaluate(options.imunoise);
+    EXPECT_EQ(result.epochs, ilast - ifirst - 1);
+    EXPECT_EQ(result.epochs, expected.epochs);
+    EXPECT_EQ(result.updates, expected.updates);
+    EXPECT_EQ(result.pos_rms, expected.pos_rms);
+    EXPECT_EQ(result.nis, expected.nis);
+    EXPECT_LT(result.updates, full.evaluate(options.imunoise).updates);
+}
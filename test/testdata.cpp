@@ -0,0 +1,385 @@
+#include "testdata.hpp"
+#include "driver.hpp"
+#include "earth.hpp"
+#include "fileio.hpp"
+#include "insmech.hpp"
+#include "rotation.hpp"
+#include "smoother.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+void writeSyntheticASC(const string &path, int records) {
+    // 静止状态，z轴加速度计的速度增量为 g/freq
+    ImuFormat format;
+    int gravity_count = static_cast<int>(lround(9.7936 / format.freq / format.acc_scale));
+    fstream ofs(path, ios::out);
+    mt19937 rng(20240522);
+    normal_distribution<double> noise(0.0, 50.0);
+    int week    = 2315;
+    double time = 287400.0;
+    char buf[256];
+    for (int i = 0; i < records; i++, time += 1.0 / format.freq) {
+        snprintf(buf, sizeof(buf), "%%RAWIMUSA,%d,%.3f;%d,%.9f,00000077,%d,%d,%d,%d,%d,%d*%08x\n", week, time, week,
+                 time, static_cast<int>(gravity_count + noise(rng)), static_cast<int>(noise(rng)),
+                 static_cast<int>(noise(rng)), static_cast<int>(noise(rng)), static_cast<int>(noise(rng)),
+                 static_cast<int>(noise(rng)), static_cast<unsigned>(rng()));
+        ofs << buf;
+    }
+}
+
+bool loadTestData(const string &imufile, const string &gnssfile, TestData &data) {
+    data.imufile  = imufile;
+    data.gnssfile = gnssfile;
+    if (!FileIO::getIMUdata(imufile, data.imudata) || data.imudata.empty()) {
+        cerr << "读取IMU数据文件 " << imufile << " 失败！" << endl;
+        return false;
+    }
+    data.gnssdata = syntheticGNSS(data.imudata);
+    writeSyntheticPos(gnssfile, data.gnssdata);
+    return true;
+}
+
+bool syntheticData(const string &name, int records, TestData &data) {
+    filesystem::path dir = filesystem::temp_directory_path();
+    string imufile       = (dir / (name + "_imu.ASC")).string();
+    writeSyntheticASC(imufile, records);
+    return loadTestData(imufile, (dir / (name + "_gnss.pos")).string(), data);
+}
+
+const TestData &testData() {
+    static TestData data;
+    static bool loaded = [] {
+        bool ok = syntheticData("gins_test", 60000, data);
+        // 程序退出时删除数据文件
+        atexit([] {
+            filesystem::remove(data.imufile);
+            filesystem::remove(data.gnssfile);
+        });
+        return ok;
+    }();
+    (void) loaded;
+    return data;
+}
+
+bool sameIMUdata(const vector<IMU> &a, const vector<IMU> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].week != b[i].week || a[i].time != b[i].time || a[i].dt != b[i].dt || a[i].dvel != b[i].dvel ||
+            a[i].dtheta != b[i].dtheta) {
+            return false;
+        }
+    }
+    return true;
+}
+
+PVA initialPVA() {
+    PVA pva;
+    pva.pos << 30.528 * D2R, 114.357 * D2R, 20.0;
+    pva.vel.setZero();
+    pva.att.euler << -0.387651 * D2R, 0.3049 * D2R, -87.5535 * D2R;
+    pva.att.qbn = Rotation::euler2quaternion(pva.att.euler);
+    pva.att.cbn = Rotation::euler2matrix(pva.att.euler);
+    return pva;
+}
+
+double positionError(const Vector3d &blh, const Vector3d &ref) {
+    Vector2d RmRn = Earth::getRmRn(ref[0]);
+    return Vector3d((blh[0] - ref[0]) * (RmRn(0) + ref[2]), (blh[1] - ref[1]) * (RmRn(1) + ref[2]) * cos(ref[0]),
+                    blh[2] - ref[2])
+        .norm();
+}
+
+GINSOptions ekfOptions() {
+    GINSOptions options;
+    options.initstate.pav = initialPVA();
+    options.initstate.imuerror.gyrbias.setZero();
+    options.initstate.imuerror.accbias.setZero();
+    options.initstate.imuerror.gyrscale.setZero();
+    options.initstate.imuerror.accscale.setZero();
+
+    ImuNoise &noise    = options.imunoise;
+    noise.gyr_arw      = Vector3d::Constant(0.2 * D2R / 60.0);
+    noise.acc_vrw      = Vector3d::Constant(0.4 / 60.0);
+    noise.gyrbias_std  = Vector3d::Constant(50.0 * D2R / 3600.0);
+    noise.accbias_std  = Vector3d::Constant(250.0 * 1E-5);
+    noise.gyrscale_std = Vector3d::Constant(1000.0 * 1E-6);
+    noise.accscale_std = Vector3d::Constant(1000.0 * 1E-6);
+    noise.corr_time    = 3600.0;
+
+    NavState &initstd         = options.initstate_std;
+    initstd.pav.pos           = Vector3d(0.1, 0.1, 0.2);
+    initstd.pav.vel           = Vector3d::Constant(0.1);
+    initstd.pav.att.euler     = Vector3d(0.5, 0.5, 1.0) * D2R;
+    initstd.imuerror.gyrbias  = noise.gyrbias_std;
+    initstd.imuerror.accbias  = noise.accbias_std;
+    initstd.imuerror.gyrscale = noise.gyrscale_std;
+    initstd.imuerror.accscale = noise.accscale_std;
+    options.antlever.setZero();
+    options.gnssinterval = 0;
+    options.lazycov      = false;
+    options.stdinterval  = 0;
+    options.decimation   = 1;
+    options.gnssonly     = false;
+    options.binaryoutput = false;
+    options.starttime    = 0;
+    options.endtime      = 0;
+    options.zupt         = false;
+    options.zuptstd      = 0.01;
+    return options;
+}
+
+vector<GNSS> syntheticGNSS(const vector<IMU> &imudata) {
+    vector<GNSS> gnssdata;
+    if (imudata.empty()) {
+        return gnssdata;
+    }
+    PVA pva = initialPVA();
+    for (double time = floor(imudata.front().time) + 1.5; time < imudata.back().time; time += 1.0) {
+        GNSS gnss;
+        gnss.week    = imudata.front().week;
+        gnss.time    = time;
+        gnss.blh     = pva.pos;
+        gnss.vel     = pva.vel;
+        gnss.posstd  = Vector3d(0.01, 0.01, 0.02);
+        gnss.velstd  = Vector3d::Constant(0.01);
+        gnss.isvalid = true;
+        gnssdata.push_back(gnss);
+    }
+    return gnssdata;
+}
+
+void writeSyntheticPos(const string &path, const vector<GNSS> &gnssdata) {
+    fstream ofs(path, ios::out);
+    char buf[256];
+    ofs << "% synthetic GNSS solution for GINS tests\n";
+    for (const GNSS &gnss : gnssdata) {
+        snprintf(buf, sizeof(buf), "%d %.3f %.9f %.9f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f %.4f\n", gnss.week,
+                 gnss.time, gnss.blh[0] * R2D, gnss.blh[1] * R2D, gnss.blh[2], gnss.posstd[0], gnss.posstd[1],
+                 gnss.posstd[2], gnss.vel[0], gnss.vel[1], -gnss.vel[2], gnss.velstd[0], gnss.velstd[1],
+                 gnss.velstd[2]);
+        ofs << buf;
+    }
+}
+
+vector<Vector3d> randomEulers() {
+    mt19937 rng(20240522);
+    uniform_real_distribution<double> angle(-M_PI, M_PI), pitch(-1.5, 1.5);
+    vector<Vector3d> eulers(MICRO_INPUTS);
+    for (auto &euler : eulers) {
+        euler = Vector3d(angle(rng), pitch(rng), angle(rng));
+    }
+    return eulers;
+}
+
+vector<Vector3d> randomPositions() {
+    mt19937 rng(20240523);
+    uniform_real_distribution<double> lat(-1.5, 1.5), lon(-M_PI, M_PI), hgt(-100.0, 5000.0);
+    vector<Vector3d> blhs(MICRO_INPUTS);
+    for (auto &blh : blhs) {
+        blh = Vector3d(lat(rng), lon(rng), hgt(rng));
+    }
+    return blhs;
+}
+
+PVA runMechanization(const vector<IMU> &imudata, bool fused) {
+    PVA pvapre = initialPVA(), pvacur = pvapre;
+    for (size_t i = 1; i < imudata.size(); i++) {
+        if (fused) {
+            INSMech::insMechFused(pvapre, pvacur, imudata[i - 1], imudata[i]);
+        } else {
+            INSMech::insMech(pvapre, pvacur, imudata[i - 1], imudata[i]);
+        }
+    }
+    if (fused) {
+        INSMech::updateAttitude(pvacur.att);
+    }
+    return pvacur;
+}
+
+PVA perturbedPVA(size_t lane) {
+    PVA pva = initialPVA();
+    pva.att.euler[2] += lane * 0.1 * D2R;
+    pva.att.qbn = Rotation::euler2quaternion(pva.att.euler);
+    pva.att.cbn = Rotation::euler2matrix(pva.att.euler);
+    return pva;
+}
+
+NavState runEKF(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, bool lazycov, GIEngine::StateMatrix *cov) {
+    GINSOptions options = ekfOptions();
+    options.lazycov     = lazycov;
+    GIEngine engine(options);
+    FilterDriver::run(engine, imudata[0], FilterDriver::source(imudata, 1), FilterDriver::source(gnssdata, 0));
+    if (cov != nullptr) {
+        *cov = engine.getCovariance();
+    }
+    return engine.getNavState();
+}
+
+void sampleCovariance(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, GIEngine::StateMatrix &phi,
+                      GIEngine::StateMatrix &cov, GIEngine::StateMatrix &qd) {
+    vector<GIEngine::Epoch> epochs;
+    GIEngine engine(ekfOptions());
+    engine.addImuData(imudata[0]);
+    engine.addGnssData(gnssdata[0]);
+    engine.recordEpochs(&epochs);
+    for (size_t i = 1; i < min<size_t>(imudata.size(), 2000); i++) {
+        engine.addImuData(imudata[i]);
+        engine.newImuProcess();
+    }
+    engine.recordEpochs(nullptr);
+    const GIEngine::Epoch &cur = epochs.back(), &pre = epochs[epochs.size() - 2];
+    phi                        = cur.Phi;
+    cov                        = pre.Pplus;
+    qd                         = (cur.Pminus - cur.Phi * pre.Pplus * cur.Phi.transpose()).diagonal().asDiagonal();
+}
+
+size_t runRTS(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, size_t max_memory,
+              vector<NavState> &smoothed) {
+    size_t epochs = min(RTS_EPOCHS, imudata.size());
+    RTSSmoother smoother(ekfOptions(), max_memory);
+    FilterDriver::run(smoother, imudata[0], FilterDriver::source(imudata, 1, epochs),
+                      FilterDriver::source(gnssdata, 0));
+    smoothed.clear();
+    smoother.smooth([&smoothed](double, const NavState &state, const GIEngine::StateVector &) {
+        smoothed.push_back(state);
+    });
+    return smoother.peakMemory();
+}
+
+NavResult syntheticResult(size_t i, double time) {
+    PVA pva = initialPVA();
+    NavResult result;
+    result.week   = 2315;
+    result.time   = time;
+    result.blh    = pva.pos + Vector3d(1E-9, 1E-9, 1E-3) * double(i);
+    result.vel    = Vector3d(1E-4, -2E-4, 3E-5) * double(i % 1000);
+    result.euler  = pva.att.euler + Vector3d(1E-7, -1E-7, 1E-6) * double(i);
+    result.posstd = result.velstd = result.attstd = Vector3d(0.1, 0.1, 0.2);
+    result.hasstd = i % 200 == 0;
+    result.gnss   = i % 200 == 0;
+    return result;
+}
+
+void writeResultStream(const filesystem::path &file, const vector<IMU> &imudata, size_t epochs) {
+    fstream fout(file, ios::out);
+    fout.flags(ios::fixed);
+    fout.precision(8);
+    for (size_t i = 0; i < epochs; i++) {
+        NavResult r = syntheticResult(i, imudata[i].time);
+        fout << r.time << " " << r.blh[0] * R2D << " " << r.blh[1] * R2D << " " << r.blh[2] << " " << r.vel[0] << " "
+             << r.vel[1] << " " << r.vel[2] << " " << r.euler[0] * R2D << " " << r.euler[1] * R2D << " "
+             << r.euler[2] * R2D << endl;
+    }
+}
+
+GINSOptions outputOptions(const filesystem::path &dir, bool binary, int decimation) {
+    filesystem::create_directories(dir);
+    GINSOptions options  = ekfOptions();
+    options.outputpath   = dir.string();
+    options.stdinterval  = 1.0;
+    options.decimation   = decimation;
+    options.binaryoutput = binary;
+    return options;
+}
+
+bool writeResultSink(const GINSOptions &options, const vector<IMU> &imudata, size_t epochs) {
+    ResultSink sink(options);
+    for (size_t i = 0; i < epochs; i++) {
+        sink.push(syntheticResult(i, imudata[i].time));
+    }
+    return sink.close();
+}
+
+vector<DataFrame> realtimeFrames(const vector<IMU> &imudata, const vector<GNSS> &gnssdata) {
+    vector<DataFrame> frames;
+    size_t g = 0;
+    for (const IMU &imu : imudata) {
+        while (g < gnssdata.size() && gnssdata[g].time <= imu.time) {
+            frames.push_back(FrameIO::toFrame(gnssdata[g++]));
+        }
+        frames.push_back(FrameIO::toFrame(imu));
+    }
+    return frames;
+}
+
+double runRealtimePipe(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, const GINSOptions &options,
+                       LatencyHistogram &latency, size_t (*allocated)(), size_t &allocations) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    vector<DataFrame> frames = realtimeFrames(imudata, gnssdata);
+    thread sender([&frames, fd = fds[1]]() {
+        for (DataFrame frame : frames) {
+            frame.stamp = FrameIO::now();
+            if (write(fd, &frame, sizeof(frame)) != sizeof(frame)) {
+                break;
+            }
+        }
+        close(fd);
+    });
+
+    ResultSink sink(options);
+    RealtimeNavigator navigator(options, sink);
+    DataFrame frame;
+    allocations = 0;
+    while (FrameIO::readFrame(fds[0], frame)) {
+        bool initialized = navigator.initialized();
+        size_t before    = allocated != nullptr ? allocated() : 0;
+        uint64_t start   = FrameIO::now();
+        if (navigator.process(frame)) {
+            latency.record(FrameIO::now() - start);
+        }
+        if (initialized && allocated != nullptr) {
+            allocations += allocated() - before;
+        }
+    }
+    sender.join();
+    close(fds[0]);
+    sink.close();
+    if (!navigator.initialized()) {
+        return -1;
+    }
+    return positionError(navigator.engine().getNavState().pav.pos, initialPVA().pos);
+}
+
+SimOptions simOptions(bool noise) {
+    PVA pva = initialPVA();
+    SimOptions sim;
+    sim.duration = 300.0;
+    sim.initpos  = pva.pos;
+    sim.initatt  = pva.att.euler;
+    sim.imunoise = ekfOptions().imunoise;
+    sim.noise    = noise;
+    sim.quantize = noise;
+    return sim;
+}
+
+NoiseSweep simulationSweep() {
+    vector<IMU> imudata;
+    vector<GNSS> gnssdata;
+    vector<PVA> truth;
+    Simulator::generate(simOptions(true), imudata, gnssdata, &truth);
+    vector<double> times(imudata.size());
+    for (size_t i = 0; i < imudata.size(); i++) {
+        times[i] = imudata[i].time;
+    }
+    NoiseSweep sweep(ekfOptions(), std::move(imudata), std::move(gnssdata));
+    for (size_t i = 0; i < truth.size(); i++) {
+        sweep.addReference(times[i], truth[i].pos);
+    }
+    return sweep;
+}
+
+vector<ImuNoise> sweepConfigs() {
+    SweepSpace space;
+    space.vrw = {0.25, 1.0, 4.0};
+    return NoiseSweep::grid(ekfOptions().imunoise, space);
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include "gins.hpp"
+#include "realtime.hpp"
+#include "simulator.hpp"
+#include "sweep.hpp"
+#include "types.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+using namespace std;
+
+// 单元测试（gins_test）和基准测试（gins_bench）共用的模拟数据和解算流程
+
+/// 模拟数据：静止的IMU数据和同时段1Hz的静止GNSS定位结果，数据文件与读入内存的数据相同
+typedef struct TestData {
+    string imufile;        // IMU ASC格式数据文件
+    string gnssfile;       // GNSS pos格式数据文件
+    vector<IMU> imudata;   // imufile 读入的IMU数据
+    vector<GNSS> gnssdata; // 写入 gnssfile 的GNSS数据
+} TestData;
+
+/**
+ * @brief 生成确定性的模拟 RAWIMUSA 格式 ASC 文件，用于没有实测数据时的测试
+ *
+ * @param path 输出文件路径
+ * @param records 记录数
+ */
+void writeSyntheticASC(const string &path, int records);
+
+/**
+ * @brief 读入IMU数据文件，在同一时段生成模拟GNSS数据并写成pos文件
+ *
+ * @param [in] imufile IMU ASC格式数据文件
+ * @param [in] gnssfile 输出的GNSS pos文件路径
+ * @param [out] data 模拟数据
+ * @return true 读取成功且数据不为空
+ */
+bool loadTestData(const string &imufile, const string &gnssfile, TestData &data);
+
+/**
+ * @brief 在临时目录下生成模拟数据文件并读入
+ *
+ * @param [in] name 文件名前缀，数据文件为 name_imu.ASC 和 name_gnss.pos
+ * @param [in] records IMU记录数
+ * @param [out] data 模拟数据
+ * @return true 成功
+ */
+bool syntheticData(const string &name, int records, TestData &data);
+
+/// 单元测试使用的模拟数据（60000条记录，即5分钟），第一次调用时生成，读取失败时数据为空
+const TestData &testData();
+
+/// 两组IMU数据是否逐位相同
+bool sameIMUdata(const vector<IMU> &a, const vector<IMU> &b);
+
+/// 测试的初始状态，与 main.cpp 的初始姿态相同
+PVA initialPVA();
+
+/// 两个BLH位置之间的距离（m）
+double positionError(const Vector3d &blh, const Vector3d &ref);
+
+/// 松组合测试的配置参数，噪声参数与 dataset/gins.yaml 相同
+GINSOptions ekfOptions();
+
+/// 在 IMU 数据时段内生成 1Hz 的静止GNSS定位结果，GNSS时刻位于两个IMU历元之间，每次更新都需要内插
+vector<GNSS> syntheticGNSS(const vector<IMU> &imudata);
+
+/**
+ * @brief 把GNSS数据写成pos格式文件，字段与 FileIO::parseGNSSline 对应
+ *
+ * @param path 输出文件路径
+ * @param gnssdata GNSS数据
+ */
+void writeSyntheticPos(const string &path, const vector<GNSS> &gnssdata);
+
+// 微基准测试和地理参数测试的输入个数
+constexpr size_t MICRO_INPUTS = 1024;
+
+/// 均匀分布的随机欧拉角（rad），俯仰角避开 ±90°
+vector<Vector3d> randomEulers();
+
+/// 全球范围内的随机BLH位置（rad、rad、m）
+vector<Vector3d> randomPositions();
+
+/**
+ * @brief 对全部IMU数据做纯惯导递推
+ *
+ * @param fused 是否使用单遍融合的机械编排 insMechFused，否则使用原有的三步 insMech
+ * @return PVA 最后一个历元的状态
+ */
+PVA runMechanization(const vector<IMU> &imudata, bool fused);
+
+// 多轨迹批量机械编排每条轨迹递推的历元数
+constexpr size_t MECH_BATCH_EPOCHS = 36000;
+
+/// 第 lane 条轨迹的初始状态，航向角逐条扰动 0.1 度，模拟初始姿态的蒙特卡洛扰动
+PVA perturbedPVA(size_t lane);
+
+/**
+ * @brief 用 GIEngine 处理全部IMU数据，与 main.cpp 的处理流程相同
+ *
+ * @param gnssdata GNSS数据，为空时只做状态预测
+ * @param lazycov 是否延迟传播协方差
+ * @param [out] cov 最后一个历元的协方差，可以为 nullptr
+ * @return NavState 最后一个历元的状态
+ */
+NavState runEKF(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, bool lazycov = false,
+                GIEngine::StateMatrix *cov = nullptr);
+
+/**
+ * @brief 用 GIEngine 的节点记录取一组实际的状态转移矩阵和协方差，系统噪声取对角阵
+ *
+ * @param [out] phi 状态转移矩阵
+ * @param [out] cov 上一历元的协方差
+ * @param [out] qd 系统噪声
+ */
+void sampleCovariance(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, GIEngine::StateMatrix &phi,
+                      GIEngine::StateMatrix &cov, GIEngine::StateMatrix &qd);
+
+// RTS平滑测试处理的历元数，不限制内存时每个历元约占10KB
+constexpr size_t RTS_EPOCHS = 60000;
+
+/**
+ * @brief 对前 RTS_EPOCHS 个历元做RTS平滑
+ *
+ * @param max_memory 节点内存上限（字节），为0时不限制
+ * @param [out] smoothed 平滑后的导航状态
+ * @return size_t 节点内存峰值（字节）
+ */
+size_t runRTS(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, size_t max_memory, vector<NavState> &smoothed);
+
+/// 第 i 个历元（时刻为 time）的模拟导航结果，位置、速度、姿态逐历元变化，避免格式化结果完全相同
+NavResult syntheticResult(size_t i, double time);
+
+/// 原先的输出方式：每个历元用 << 格式化，并以 endl 结束（每行刷新一次），输出前 epochs 个历元的模拟结果
+void writeResultStream(const filesystem::path &file, const vector<IMU> &imudata, size_t epochs);
+
+/// 结果输出测试的配置，输出到 dir，标准差每200个历元输出一次
+GINSOptions outputOptions(const filesystem::path &dir, bool binary, int decimation = 1);
+
+/// 用 ResultSink 输出前 epochs 个历元的模拟结果
+bool writeResultSink(const GINSOptions &options, const vector<IMU> &imudata, size_t epochs);
+
+/// 把IMU和GNSS数据编码为实时数据帧，GNSS数据在其时刻所在的IMU历元之前发送
+vector<DataFrame> realtimeFrames(const vector<IMU> &imudata, const vector<GNSS> &gnssdata);
+
+/**
+ * @brief 通过管道以实时模式处理全部数据，统计处理延迟和初始化之后的堆内存分配次数
+ *
+ * @param [in] options 配置，使用其中的输出设置
+ * @param [out] latency 处理延迟
+ * @param [in] allocated 返回当前线程累计的堆内存分配次数，为 nullptr 时不统计
+ * @param [out] allocations 初始化之后读取、处理数据帧的线程中的堆内存分配次数
+ * @return double 最后一个历元与初始位置的距离（m），失败时为-1
+ */
+double runRealtimePipe(const vector<IMU> &imudata, const vector<GNSS> &gnssdata, const GINSOptions &options,
+                       LatencyHistogram &latency, size_t (*allocated)(), size_t &allocations);
+
+/// 仿真测试的参数：初始状态与 initialPVA 相同，噪声参数与 ekfOptions 相同
+SimOptions simOptions(bool noise);
+
+/// 在含噪声的仿真数据上构造参数扫描，参考轨迹为仿真真值
+NoiseSweep simulationSweep();
+
+/// 速度随机游走分别取 1/4、1、4 倍的扫描参数，仿真数据的噪声参数为1倍
+vector<ImuNoise> sweepConfigs();
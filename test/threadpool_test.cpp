@@ -0,0 +1,30 @@
+#include "threadpool.hpp"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+// 某个任务抛出异常时，parallelFor 等其余任务全部结束后才抛出第一个异常
+TEST(ThreadPool, ParallelForWaitsBeforeRethrow) {
+    ThreadPool pool(4);
+    constexpr size_t n = 64;
+    atomic<size_t> finished{0};
+    try {
+        pool.parallelFor(n, [&finished](size_t i) {
+            if (i % 16 == 0) {
+                throw runtime_error("task " + to_string(i));
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+            finished++;
+        });
+        FAIL() << "parallelFor 没有抛出任务的异常";
+    } catch (const runtime_error &e) {
+        EXPECT_STREQ(e.what(), "task 0");
+    }
+    EXPECT_EQ(finished.load(), n - n / 16) << "抛出异常时还有任务在运行";
+
+    // 线程池仍然可用
+    finished = 0;
+    pool.parallelFor(n, [&finished](size_t) { finished++; });
+    EXPECT_EQ(finished.load(), n);
+}
@@ -0,0 +1,56 @@
+#include "testdata.hpp"
+#include "trajectory.hpp"
+#include <gtest/gtest.h>
+
+// 二进制轨迹文件的记录与写入的结果一致，按时间查找与逐条查找相同
+TEST(TrajectoryFile, ReadBackAndLowerBound) {
+    const vector<IMU> &imudata = testData().imudata;
+    ASSERT_FALSE(imudata.empty());
+    size_t epochs        = min<size_t>(imudata.size(), 20000);
+    filesystem::path dir = filesystem::temp_directory_path() / "gins_test_trajectory";
+    ASSERT_TRUE(writeResultSink(outputOptions(dir, true), imudata, epochs));
+
+    TrajectoryFile traj;
+    ASSERT_TRUE(traj.open((dir / "result.traj").string()));
+    ASSERT_EQ(traj.size(), epochs);
+    ASSERT_TRUE(traj.hasStd());
+    for (size_t i = 0; i < epochs; i++) {
+        NavResult ref = syntheticResult(i, imudata[i].time), res = traj.get(i);
+        ASSERT_TRUE(res.time == ref.time && res.blh == ref.blh && res.vel == ref.vel && res.euler == ref.euler &&
+                    res.hasstd == ref.hasstd && (!ref.hasstd || res.posstd == ref.posstd))
+            << "第 " << i << " 条记录不一致";
+    }
+    for (size_t i = 0; i < epochs; i += 97) {
+        EXPECT_EQ(traj.lowerBound(traj.time(i) - 1E-4), i);
+        EXPECT_EQ(traj.lowerBound(traj.time(i)), i);
+    }
+    EXPECT_EQ(traj.lowerBound(traj.time(epochs - 1) + 1.0), epochs);
+    filesystem::remove_all(dir);
+}
+
+// 时间相同的记录跨过时间索引的块边界时，按时间查找返回其中的第一条
+TEST(TrajectoryFile, LowerBoundWithRepeatedTimes) {
+    filesystem::path path = filesystem::temp_directory_path() / "gins_test_repeated.traj";
+    size_t records        = 3 * TrajectoryFile::INDEX_STRIDE;
+    {
+        TrajectoryWriter writer;
+        ASSERT_TRUE(writer.open(path.string(), false));
+        for (size_t i = 0; i < records; i++) {
+            // 每3条记录的时间相同，第 INDEX_STRIDE-2 ~ INDEX_STRIDE 条位于两个块中
+            writer.write(syntheticResult(i, static_cast<double>((i + 1) / 3)));
+        }
+        ASSERT_TRUE(writer.close());
+    }
+
+    TrajectoryFile traj;
+    ASSERT_TRUE(traj.open(path.string()));
+    ASSERT_EQ(traj.size(), records);
+    size_t first = 0; // 与第 i 条记录时间相同的第一条记录
+    for (size_t i = 0; i < records; i++) {
+        if (traj.time(i) != traj.time(first)) {
+            first = i;
+        }
+        ASSERT_EQ(traj.lowerBound(traj.time(i)), first) << "第 " << i << " 条记录";
+    }
+    filesystem::remove(path);
+}